@@ -6,12 +6,12 @@ if [ -z "$1" ]; then
 fi
 
 export BUILD_DIR="$1"
-OPENOMF_BIN=$(find "$BUILD_DIR" -name openomf -type f -executable -print -quit)
-if [ -z "$OPENOMF_BIN" ]; then
-    echo "Could not find openomf executable from $BUILD_DIR" >&2
+RECTEST_BIN=$(find "$BUILD_DIR" -name openomf_rectest -type f -executable -print -quit)
+if [ -z "$RECTEST_BIN" ]; then
+    echo "Could not find openomf_rectest executable from $BUILD_DIR" >&2
     exit 1
 fi
-export OPENOMF_BIN="./${OPENOMF_BIN#$BUILD_DIR}"
+export RECTEST_BIN="./${RECTEST_BIN#$BUILD_DIR}"
 
 # Define your tests here (description:filename)
 tests=(
@@ -79,59 +79,29 @@ tests=(
     "Chronos can attack opponent when in stasis in the air and rehit mode is disabled:CHRONOS_AIR_STASIS.REC"
 )
 
-# Setup temp directory for outputs
-temp_dir=$(mktemp -d)
-trap 'rm -rf "$temp_dir"' EXIT
-
 interrupt() {
     echo "Test run interrupted" >&2
     exit 1
 }
 trap interrupt INT
 
-fail_count=0
-fail_summary=""
+RUNDIR=$(pwd)
 
-echo "Running tests..."
+files=()
+for test in "${tests[@]}"; do
+    IFS=':' read -r _ filename <<< "$test"
+    # Trim whitespace from the filename
+    filename=$(echo "$filename" | sed -re 's/^[[:blank:]]+|[[:blank:]]+$//g')
+    files+=("$RUNDIR/rectests/${filename}")
+done
 
-RUNDIR=$(pwd)
+echo "Running tests..."
 
 cd $BUILD_DIR
 
 export OPENOMF_RESOURCE_PATH="."
 export LSAN_OPTIONS="suppressions=../lsan.supp"
 
-output_file="$temp_dir/output_shouldfail.log"
-if $OPENOMF_BIN --force-audio-backend=NULL --force-renderer=NULL --speed=10 -P "$RUNDIR/rectests/SHOULDFAIL.REC" >"$output_file" 2>&1; then
-    cat "$output_file"
-    echo "CRITICAL ERROR: SHOULDFAIL.REC succeeded."
-    exit 1
-fi
-
-i=0
-for test in "${tests[@]}"; do
-    IFS=':' read -r desc filename <<< "$test"
-    # Trim whitespace from description and filename
-    desc=$(echo "$desc" | sed -re 's/^[[:blank:]]+|[[:blank:]]+$//g')
-    filename=$(echo "$filename" | sed -re 's/^[[:blank:]]+|[[:blank:]]+$//g')
-    output_file="$temp_dir/output_$i.log"
-
-    echo -n "${desc} :"
-    if $OPENOMF_BIN --force-audio-backend=NULL --force-renderer=NULL --speed=10 -P "$RUNDIR/rectests/${filename}" >"$output_file"  2>&1; then
-        echo " PASS"
-    else
-        echo " FAILED (${filename})"
-        fail_summary="${fail_summary} ${filename}"
-        cat $output_file
-        ((fail_count++))
-    fi
-    ((i++))
-done
-
-if [ $fail_count -ne 0 ]; then
-    fail_summary="Failed ${fail_count} tests:${fail_summary}"
-    echo "${fail_summary}"
-
-    # Exit with non-zero status if any test failed
-    exit $fail_count
-fi
+# The runner plays the files in parallel, and exits with the number of failed tests. It uses built-in default
+# settings, so the results do not depend on the settings file of whoever runs it.
+$RECTEST_BIN --should-fail="$RUNDIR/rectests/SHOULDFAIL.REC" "${files[@]}"
@@ -13,6 +13,9 @@
 #ifdef ENABLE_NULL_AUDIO_BACKEND
 #include "audio/backends/null/null_backend.h"
 #endif
+#ifdef ENABLE_OFFLINE_AUDIO_BACKEND
+#include "audio/backends/offline/offline_backend.h"
+#endif
 
 #define MAX_AVAILABLE_BACKENDS 8
 
@@ -31,13 +34,20 @@ static_assert(SOUND_CHANNEL_COUNT <= 4, "channel index must fit in sound_handle.
 
 typedef void (*audio_backend_init)(audio_backend *backend);
 
-// All built-in backends, most preferred first.
-static audio_backend_init all_backends[] = {
+// All built-in backends, most preferred first. Headless backends play nothing out loud, and are only used when asked
+// for by name (tests, exports).
+static const struct builtin_backend {
+    audio_backend_init set_callbacks;
+    bool headless;
+} all_backends[] = {
 #ifdef ENABLE_SDL_AUDIO_BACKEND
-    sdl_audio_backend_set_callbacks,
+    {sdl_audio_backend_set_callbacks,     false},
 #endif
 #ifdef ENABLE_NULL_AUDIO_BACKEND
-    null_audio_backend_set_callbacks,
+    {null_audio_backend_set_callbacks,    true },
+#endif
+#ifdef ENABLE_OFFLINE_AUDIO_BACKEND
+    {offline_audio_backend_set_callbacks, true },
 #endif
 };
 static int all_backends_count = N_ELEMENTS(all_backends);
@@ -47,6 +57,7 @@ static struct available_backend {
     audio_backend_init set_callbacks;
     const char *name;
     const char *description;
+    bool headless;
 } available_backends[MAX_AVAILABLE_BACKENDS];
 static int audio_backend_count = 0;
 
@@ -78,14 +89,15 @@ void audio_scan_backends(void) {
     audio_backend tmp;
     audio_backend_count = 0;
     for(int i = 0; i < all_backends_count; i++) {
-        all_backends[i](&tmp);
+        all_backends[i].set_callbacks(&tmp);
         if(audio_backend_count >= MAX_AVAILABLE_BACKENDS) {
             break;
         }
         if(tmp.is_available()) {
-            available_backends[audio_backend_count].set_callbacks = all_backends[i];
+            available_backends[audio_backend_count].set_callbacks = all_backends[i].set_callbacks;
             available_backends[audio_backend_count].name = tmp.get_name();
             available_backends[audio_backend_count].description = tmp.get_description();
+            available_backends[audio_backend_count].headless = all_backends[i].headless;
             log_debug("Audio backend '%s' is available", available_backends[audio_backend_count].name);
             audio_backend_count++;
         }
@@ -121,9 +133,11 @@ static bool hunt_backend_by_name(const char *try_name) {
 }
 
 static bool find_best_backend(void) {
-    if(audio_backend_count > 0) {
-        available_backends[0].set_callbacks(&current_backend);
-        return true;
+    for(int i = 0; i < audio_backend_count; i++) {
+        if(!available_backends[i].headless) {
+            available_backends[i].set_callbacks(&current_backend);
+            return true;
+        }
     }
     return false;
 }
@@ -301,6 +315,18 @@ void audio_get_music_info(unsigned *sample_rate, unsigned *channels, unsigned *r
     current_backend.get_info(current_backend.ctx, sample_rate, channels, resampler);
 }
 
+bool audio_can_render(void) {
+    return current_backend.render != NULL;
+}
+
+bool audio_render(int16_t *data, const int frames) {
+    if(current_backend.render == NULL) {
+        return false;
+    }
+    current_backend.render(current_backend.ctx, data, frames);
+    return true;
+}
+
 void audio_set_music_volume(const float volume) {
     current_backend.set_music_volume(current_backend.ctx, volume);
 }
@@ -43,7 +43,7 @@ int audio_get_backend_count(void);
 
 /**
  * @brief Initialize the audio subsystem.
- * @param try_name Backend name to use, or NULL/empty to auto-pick the first available.
+ * @param try_name Backend name to use, or NULL/empty to auto-pick the first available one that is not headless.
  * @param sample_rate Output sample rate in Hz (see audio_get_sample_rates).
  * @param mono True for single-channel output, false for stereo.
  * @param resampler Music module resampler (backend-specific id; see psm_source / opus_source).
@@ -111,6 +111,19 @@ void audio_stop_music(void);
  */
 void audio_get_music_info(unsigned *sample_rate, unsigned *channels, unsigned *resampler);
 
+/**
+ * @brief Check if the backend mixes on demand with audio_render(), instead of playing to a device.
+ */
+bool audio_can_render(void);
+
+/**
+ * @brief Mix the next block of audio. Sounds and music only advance when this is called.
+ * @param data Output buffer for interleaved 16 bit samples, in the format given by audio_get_music_info.
+ * @param frames Number of sample frames (samples per channel) to render.
+ * @return false if the backend does not support offline rendering.
+ */
+bool audio_render(int16_t *data, int frames);
+
 /**
  * @brief Set music master volume.
  * @param volume Volume level, 0.0 ... 1.0.
@@ -14,6 +14,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #define SOUND_CHANNEL_COUNT 3
 
@@ -59,6 +60,10 @@ typedef void (*set_channel_panning_fn)(void *ctx, int channel, int panning);
 typedef void (*play_music_fn)(void *ctx, const music_source *src);
 typedef void (*stop_music_fn)(void *ctx);
 
+// Mix the next `frames` sample frames into `data` (interleaved signed 16 bit, in the format given by get_info).
+// Only set by offline backends; device backends render on their own and leave this NULL.
+typedef void (*render_backend_fn)(void *ctx, int16_t *data, int frames);
+
 struct audio_backend {
     is_backend_available_fn is_available;
     get_backend_description_fn get_description;
@@ -85,6 +90,8 @@ struct audio_backend {
     play_music_fn play_music;
     stop_music_fn stop_music;
 
+    render_backend_fn render;
+
     void *ctx;
 };
 
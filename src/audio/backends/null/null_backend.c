@@ -174,4 +174,5 @@ void null_audio_backend_set_callbacks(audio_backend *null_backend) {
     null_backend->set_channel_panning = set_channel_panning;
     null_backend->play_music = play_music;
     null_backend->stop_music = stop_music;
+    null_backend->render = NULL;
 }
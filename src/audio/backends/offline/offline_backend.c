@@ -0,0 +1,333 @@
+#include "audio/backends/offline/offline_backend.h"
+#include "audio/backends/audio_backend.h"
+#include "audio/music_sources/music_source.h"
+#include "utils/allocator.h"
+#include "utils/c_array_util.h"
+#include "utils/log.h"
+#include "utils/miscmath.h"
+
+#include <assert.h>
+#include <string.h>
+
+#define MAX_VOLUME 128  // Same range as MIX_MAX_VOLUME, so that sound volumes mean the same as with SDL_mixer.
+#define FRAC_BITS 16    // Fractional bits of the sample position
+#define RENDER_BLOCK 64 // Frames mixed per inner loop
+
+static const audio_sample_rate supported_sample_rates[] = {
+    {11025, 0, "11025Hz"},
+    {22050, 0, "22050Hz"},
+    {44100, 0, "44100Hz"},
+    {48000, 1, "48000Hz"},
+};
+static const int supported_sample_rate_count = N_ELEMENTS(supported_sample_rates);
+
+typedef enum fade_mode
+{
+    FADE_NONE,
+    FADE_IN,
+    FADE_OUT,
+} fade_mode;
+
+typedef struct offline_channel {
+    bool playing;
+    int16_t *samples; // Source converted to signed 16 bit, with one extra sample for interpolation.
+    size_t len;       // Sample count, without the extra sample.
+    uint64_t pos;     // Read position, in source samples with FRAC_BITS of fraction.
+    uint64_t step;    // Position increment per output frame.
+    int volume;       // 0 ... 127
+    int pan_left;     // 0 ... 255
+    int pan_right;    // 0 ... 255
+    fade_mode fade;
+    int fade_done;   // Output frames elapsed in the current fade
+    int fade_frames; // Total length of the current fade in output frames
+} offline_channel;
+
+typedef struct offline_audio_context {
+    int sample_rate;
+    int channels;
+    int resampler;
+    int sound_volume; // 0 ... MAX_VOLUME
+    float music_volume;
+    music_source music;
+    offline_channel mix_channels[SOUND_CHANNEL_COUNT];
+} offline_audio_context;
+
+static bool is_available(void) {
+    return true; // Needs no device, so this is always available if compiled in.
+}
+
+static const char *get_description(void) {
+    return "Offline mixing for audio capture";
+}
+
+static const char *get_name(void) {
+    return "Offline";
+}
+
+static unsigned int get_sample_rates(const audio_sample_rate **sample_rates) {
+    *sample_rates = supported_sample_rates;
+    return supported_sample_rate_count;
+}
+
+static void create_backend(audio_backend *player) {
+    player->ctx = omf_calloc(1, sizeof(offline_audio_context));
+}
+
+static void destroy_backend(audio_backend *player) {
+    omf_free(player->ctx);
+}
+
+static void free_channel(offline_audio_context *ctx, const int i) {
+    offline_channel *ch = &ctx->mix_channels[i];
+    omf_free(ch->samples);
+    memset(ch, 0, sizeof(offline_channel));
+}
+
+// map -100 ... 100 to left and right gains, the same way as the SDL_mixer backend does.
+static void set_panning(offline_channel *ch, const int panning) {
+    ch->pan_left = (panning > 0) ? (100 - panning) * 255 / 100 : 255;
+    ch->pan_right = (panning < 0) ? (100 + panning) * 255 / 100 : 255;
+}
+
+static int ms_to_frames(const offline_audio_context *ctx, const int ms) {
+    return (int)((int64_t)ms * ctx->sample_rate / 1000);
+}
+
+static void set_backend_sound_volume(void *userdata, float volume) {
+    assert(userdata);
+    offline_audio_context *const ctx = userdata;
+    volume = clampf(volume, 0.0f, 1.0f);
+    ctx->sound_volume = volume * MAX_VOLUME;
+}
+
+static void set_backend_music_volume(void *userdata, const float volume) {
+    assert(userdata);
+    offline_audio_context *const ctx = userdata;
+    ctx->music_volume = clampf(volume, 0.0f, 1.0f);
+    music_source_set_volume(&ctx->music, ctx->music_volume);
+}
+
+static void get_info(void *userdata, unsigned *sample_rate, unsigned *channels, unsigned *resampler) {
+    assert(userdata);
+    const offline_audio_context *const ctx = userdata;
+    if(sample_rate != NULL) {
+        *sample_rate = ctx->sample_rate;
+    }
+    if(channels != NULL) {
+        *channels = ctx->channels;
+    }
+    if(resampler != NULL) {
+        *resampler = ctx->resampler;
+    }
+}
+
+static bool play_pcm_sound(void *userdata, const int channel, const sound_source *src, const int volume,
+                           const int panning, const int fade_in_ms) {
+    assert(userdata);
+    assert(src);
+    offline_audio_context *const ctx = userdata;
+    if(channel < 0 || channel >= SOUND_CHANNEL_COUNT || src->len == 0 || src->freq <= 0) {
+        return false;
+    }
+
+    // The source may be freed right after this call, so take a copy. Samples are unsigned 8 bit mono.
+    free_channel(ctx, channel);
+    offline_channel *ch = &ctx->mix_channels[channel];
+    ch->samples = omf_malloc((src->len + 1) * sizeof(int16_t));
+    for(size_t i = 0; i < src->len; i++) {
+        ch->samples[i] = ((int)(unsigned char)src->buf[i] - 128) * 256;
+    }
+    ch->samples[src->len] = ch->samples[src->len - 1];
+    ch->len = src->len;
+    ch->step = ((uint64_t)src->freq << FRAC_BITS) / ctx->sample_rate;
+    ch->volume = volume;
+    set_panning(ch, panning);
+    if(fade_in_ms > 0) {
+        ch->fade = FADE_IN;
+        ch->fade_frames = max2(1, ms_to_frames(ctx, fade_in_ms));
+    }
+    ch->playing = true;
+    return true;
+}
+
+static bool is_channel_playing(void *userdata, const int channel) {
+    assert(userdata);
+    const offline_audio_context *const ctx = userdata;
+    if(channel < 0 || channel >= SOUND_CHANNEL_COUNT) {
+        return false;
+    }
+    return ctx->mix_channels[channel].playing;
+}
+
+static void stop_channel(void *userdata, const int channel) {
+    assert(userdata);
+    offline_audio_context *const ctx = userdata;
+    if(channel < 0 || channel >= SOUND_CHANNEL_COUNT) {
+        return;
+    }
+    free_channel(ctx, channel);
+}
+
+static void fade_out_channel(void *userdata, const int channel, const int ms) {
+    assert(userdata);
+    offline_audio_context *const ctx = userdata;
+    if(channel < 0 || channel >= SOUND_CHANNEL_COUNT || !ctx->mix_channels[channel].playing) {
+        return;
+    }
+    if(ms <= 0) {
+        free_channel(ctx, channel);
+        return;
+    }
+    offline_channel *ch = &ctx->mix_channels[channel];
+    ch->fade = FADE_OUT;
+    ch->fade_done = 0;
+    ch->fade_frames = max2(1, ms_to_frames(ctx, ms));
+}
+
+static void set_channel_panning(void *userdata, const int channel, const int panning) {
+    assert(userdata);
+    offline_audio_context *const ctx = userdata;
+    if(channel < 0 || channel >= SOUND_CHANNEL_COUNT) {
+        return;
+    }
+    set_panning(&ctx->mix_channels[channel], panning);
+}
+
+static void stop_music(void *userdata) {
+    assert(userdata);
+    offline_audio_context *const ctx = userdata;
+    music_source_close(&ctx->music);
+}
+
+static void play_music(void *userdata, const music_source *src) {
+    assert(userdata);
+    offline_audio_context *const ctx = userdata;
+    stop_music(ctx);
+    memcpy(&ctx->music, src, sizeof(music_source));
+    music_source_set_volume(&ctx->music, ctx->music_volume);
+}
+
+/**
+ * Current gain of a channel, 0 ... MAX_VOLUME * MAX_VOLUME. Advances fades, and stops the channel when a fade-out
+ * has finished.
+ */
+static int channel_gain(offline_channel *ch, const int sound_volume) {
+    int gain = ch->volume * sound_volume;
+    if(ch->fade == FADE_IN) {
+        gain = (int64_t)gain * ch->fade_done / ch->fade_frames;
+        if(++ch->fade_done >= ch->fade_frames) {
+            ch->fade = FADE_NONE;
+        }
+    } else if(ch->fade == FADE_OUT) {
+        gain = (int64_t)gain * (ch->fade_frames - ch->fade_done) / ch->fade_frames;
+        if(++ch->fade_done >= ch->fade_frames) {
+            ch->playing = false;
+        }
+    }
+    return gain;
+}
+
+/**
+ * Mix one channel into a 32 bit accumulator. Samples are linearly interpolated, all math is integer so that the
+ * result does not depend on the platform.
+ */
+static void mix_channel(const offline_audio_context *ctx, offline_channel *ch, int32_t *acc, const int frames) {
+    for(int i = 0; i < frames && ch->playing; i++) {
+        const size_t index = ch->pos >> FRAC_BITS;
+        const int32_t frac = ch->pos & ((1 << FRAC_BITS) - 1);
+        const int32_t a = ch->samples[index];
+        const int32_t b = ch->samples[index + 1];
+        const int32_t sample = a + (((b - a) * frac) >> FRAC_BITS);
+        const int32_t value = ((int64_t)sample * channel_gain(ch, ctx->sound_volume)) / (MAX_VOLUME * MAX_VOLUME);
+        if(ctx->channels == 1) {
+            acc[i] += value;
+        } else {
+            acc[i * 2 + 0] += value * ch->pan_left / 255;
+            acc[i * 2 + 1] += value * ch->pan_right / 255;
+        }
+        ch->pos += ch->step;
+        if((ch->pos >> FRAC_BITS) >= ch->len) {
+            ch->playing = false;
+        }
+    }
+}
+
+static void render(void *userdata, int16_t *data, int frames) {
+    assert(userdata);
+    offline_audio_context *const ctx = userdata;
+    int32_t acc[RENDER_BLOCK * 2];
+    while(frames > 0) {
+        const int block = min2(frames, RENDER_BLOCK);
+        const int count = block * ctx->channels;
+
+        // Music goes in first, sounds are mixed on top of it.
+        memset(data, 0, count * sizeof(int16_t));
+        music_source_render(&ctx->music, (char *)data, count * sizeof(int16_t));
+        for(int i = 0; i < count; i++) {
+            acc[i] = data[i];
+        }
+        for(int c = 0; c < SOUND_CHANNEL_COUNT; c++) {
+            if(ctx->mix_channels[c].playing) {
+                mix_channel(ctx, &ctx->mix_channels[c], acc, block);
+                if(!ctx->mix_channels[c].playing) {
+                    free_channel(ctx, c);
+                }
+            }
+        }
+        for(int i = 0; i < count; i++) {
+            data[i] = clamp(acc[i], INT16_MIN, INT16_MAX);
+        }
+
+        data += count;
+        frames -= block;
+    }
+}
+
+static bool setup_backend_context(void *userdata, const unsigned sample_rate, const bool mono, const int resampler,
+                                  const float music_volume, const float sound_volume) {
+    assert(userdata);
+    offline_audio_context *const ctx = userdata;
+    memset(ctx, 0, sizeof(offline_audio_context));
+    if(sample_rate == 0) {
+        log_error("Unable to set up offline audio: invalid sample rate");
+        return false;
+    }
+    ctx->sample_rate = sample_rate;
+    ctx->channels = mono ? 1 : 2;
+    ctx->resampler = resampler;
+    set_backend_sound_volume(ctx, sound_volume);
+    set_backend_music_volume(ctx, music_volume);
+    log_info("Offline audio mixer initialized: %dHz, %d channels", ctx->sample_rate, ctx->channels);
+    return true;
+}
+
+static void close_backend_context(void *userdata) {
+    assert(userdata);
+    offline_audio_context *const ctx = userdata;
+    stop_music(ctx);
+    for(int i = 0; i < SOUND_CHANNEL_COUNT; i++) {
+        free_channel(ctx, i);
+    }
+}
+
+void offline_audio_backend_set_callbacks(audio_backend *offline_backend) {
+    offline_backend->is_available = is_available;
+    offline_backend->get_description = get_description;
+    offline_backend->get_name = get_name;
+    offline_backend->get_sample_rates = get_sample_rates;
+    offline_backend->get_info = get_info;
+    offline_backend->create = create_backend;
+    offline_backend->destroy = destroy_backend;
+    offline_backend->set_music_volume = set_backend_music_volume;
+    offline_backend->set_sound_volume = set_backend_sound_volume;
+    offline_backend->setup_context = setup_backend_context;
+    offline_backend->close_context = close_backend_context;
+    offline_backend->play_pcm_sound = play_pcm_sound;
+    offline_backend->is_channel_playing = is_channel_playing;
+    offline_backend->stop_channel = stop_channel;
+    offline_backend->fade_out_channel = fade_out_channel;
+    offline_backend->set_channel_panning = set_channel_panning;
+    offline_backend->play_music = play_music;
+    offline_backend->stop_music = stop_music;
+    offline_backend->render = render;
+}
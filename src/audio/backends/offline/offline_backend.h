@@ -0,0 +1,19 @@
+/**
+ * @file offline_backend.h
+ * @brief Offline audio backend
+ * @details Does not open an output device. Sounds and music are mixed into a caller-provided buffer when
+ *          audio_render() is called, so audio advances with the simulation instead of the wall clock. Output is
+ *          sample-exact and reproducible, which makes this backend usable for replay exports and audio tests.
+ * @copyright MIT License
+ * @date 2026
+ * @author OpenOMF Project
+ */
+
+#ifndef OFFLINE_BACKEND_H
+#define OFFLINE_BACKEND_H
+
+#include "audio/backends/audio_backend.h"
+
+void offline_audio_backend_set_callbacks(audio_backend *offline_backend);
+
+#endif // OFFLINE_BACKEND_H
@@ -322,4 +322,5 @@ void sdl_audio_backend_set_callbacks(audio_backend *sdl_backend) {
     sdl_backend->set_channel_panning = set_channel_panning;
     sdl_backend->play_music = play_music;
     sdl_backend->stop_music = stop_music;
+    sdl_backend->render = NULL;
 }
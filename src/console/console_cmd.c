@@ -12,6 +12,7 @@
 #include "utils/allocator.h"
 #include "utils/log.h"
 #include "utils/miscmath.h"
+#include "utils/profiler.h"
 #include "utils/str.h"
 #include <stdio.h>
 
@@ -452,6 +453,33 @@ int console_cmd_osd(game_state *gs, int argc, char **argv) {
     return 0;
 }
 
+#ifdef DEBUGMODE
+int console_cmd_profile(game_state *gs, int argc, char **argv) {
+    if(argc >= 2 && strcmp(argv[1], "overlay") == 0) {
+        osd_set_profiler_overlay(!osd_get_profiler_overlay());
+        return 0;
+    }
+    if(argc >= 2 && strcmp(argv[1], "reset") == 0) {
+        profiler_reset();
+        console_output_addline("Profiler samples cleared");
+        return 0;
+    }
+    if(argc >= 2 && strcmp(argv[1], "dump") == 0) {
+        const char *filename = argc >= 3 ? argv[2] : "trace.json";
+        if(!profiler_dump_trace(filename)) {
+            console_output_addline("Unable to write trace file");
+            return 1;
+        }
+        char buf[256];
+        snprintf(buf, sizeof(buf), "Trace written to %s", filename);
+        console_output_addline(buf);
+        return 0;
+    }
+    console_output_addline("Usage: profile overlay|reset|dump [file]");
+    return 1;
+}
+#endif
+
 int console_cmd_assert(game_state *gs, int argc, char **argv) {
     if(argc != 4) {
         console_output_addline("Usage: assert harX.attr OP value");
@@ -571,4 +599,8 @@ void console_init_cmd(void) {
     console_add_cmd("assert", &console_cmd_assert, "Insert an assertion into the current REC file");
     console_add_cmd("score", &console_cmd_score, "Set current score");
     console_add_cmd("osd", &console_cmd_osd, "Push a text blob to the on-screen display");
+#ifdef DEBUGMODE
+    console_add_cmd("profile", &console_cmd_profile,
+                    "Frame profiler. usage: profile overlay, profile reset, profile dump [file]");
+#endif
 }
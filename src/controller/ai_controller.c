@@ -1,4 +1,5 @@
 #include "controller/ai_controller.h"
+#include "controller/ai_lookahead.h"
 #include "controller/controller.h"
 #include "formats/pilot.h"
 #include "game/game_state.h"
@@ -37,6 +38,14 @@
 #define TACTIC_JUMP_ATTACK_TIMER_MAX 12
 /* likelihood of attempting a random attack/tactic (lower is more likely) */
 #define RANDOM_ATTACK_CHANCE 10
+/* lowest difficulty that simulates its options before picking one */
+#define LOOKAHEAD_MIN_DIFFICULTY 6
+/* number of ticks between lookahead runs */
+#define LOOKAHEAD_INTERVAL 4
+/* number of ticks simulated for each option */
+#define LOOKAHEAD_TICKS 40
+/* time budget for a lookahead run, in microseconds */
+#define LOOKAHEAD_BUDGET_US 3000
 
 #define BACK (o->direction == OBJECT_FACE_RIGHT ? ACT_LEFT : ACT_RIGHT)
 #define DOWNBACK (o->direction == OBJECT_FACE_RIGHT ? ACT_LEFT : ACT_RIGHT) | ACT_DOWN
@@ -91,6 +100,10 @@ typedef struct {
 
     // all projectiles currently on screen (vector of projectile object*)
     vector active_projectiles;
+
+    // lookahead state
+    bool lookahead;      // simulate the options before picking one, see ai_lookahead.h
+    int lookahead_timer; // ticks until the next lookahead run
 } ai;
 
 enum
@@ -2622,6 +2635,128 @@ bool handle_queued_tactic(controller *ctrl, ctrl_event **ev) {
     return acted;
 }
 
+/**
+ * \brief Build a lookahead candidate that does a move the same way process_selected_move() would.
+ *
+ * \param a The AI instance.
+ * \param move The move instance.
+ * \param direction Direction the HAR is facing.
+ * \param candidate The candidate to fill in.
+ *
+ * \return Void.
+ */
+void lookahead_build_move(const ai *a, af_move *move, int direction, ai_lookahead_candidate *candidate) {
+    ai_lookahead_candidate_init(candidate);
+    int move_str_pos = str_size(&move->move_string) - 1;
+    int input_lag_timer = a->input_lag_timer;
+
+    // the move is selected on this tick, and its inputs start on the next one
+    for(int tick = 1; tick < LOOKAHEAD_TICKS; tick++) {
+        if(input_lag_timer > 0) {
+            input_lag_timer--;
+        } else {
+            move_str_pos--;
+            if(move_str_pos <= 0) {
+                move_str_pos = 0;
+            }
+            input_lag_timer = a->input_lag;
+        }
+        int action = char_to_act(&move->move_string, direction, &move_str_pos);
+        // controller_cmd() turns an empty action into ACT_STOP
+        if(!ai_lookahead_add_event(candidate, tick, action != ACT_NONE ? action : ACT_STOP) || move_str_pos == 0) {
+            break;
+        }
+    }
+}
+
+/**
+ * \brief Simulate the available moves and movements a few ticks ahead, and go with the one that works out best.
+ *
+ * \param ctrl Controller instance.
+ * \param ev The current controller event.
+ *
+ * \return A boolean indicating whether an option was picked. If not, the heuristics should decide.
+ */
+bool lookahead_decide(controller *ctrl, ctrl_event **ev) {
+    ai *a = ctrl->data;
+    object *o = game_state_find_object(ctrl->gs, ctrl->har_obj_id);
+    har *h = object_get_userdata(o);
+
+    if(--a->lookahead_timer > 0 || is_netplay(ctrl->gs)) {
+        return false;
+    }
+    a->lookahead_timer = LOOKAHEAD_INTERVAL;
+
+    ai_lookahead_candidate candidates[AI_LOOKAHEAD_MAX_CANDIDATES];
+    af_move *moves[AI_LOOKAHEAD_MAX_CANDIDATES];
+    int acts[AI_LOOKAHEAD_MAX_CANDIDATES];
+    int count = 0;
+
+    // doing nothing is the baseline the other options have to beat
+    ai_lookahead_candidate_init(&candidates[count]);
+    moves[count] = NULL;
+    acts[count] = ACT_NONE;
+    count++;
+
+    // moves the pilot would consider
+    for(int i = 0; i < 70 && count < AI_LOOKAHEAD_MAX_CANDIDATES; i++) {
+        af_move *move = af_get_move(h->af_data, i);
+        if(move == NULL || !is_valid_move(move, h, false) || dislikes_move(a, move)) {
+            continue;
+        }
+        lookahead_build_move(a, move, o->direction, &candidates[count]);
+        moves[count] = move;
+        acts[count] = ACT_NONE;
+        count++;
+    }
+
+    // movement, sent the same way as in handle_movement()
+    int movements[] = {FORWARD, BACK, DOWNBACK, UPFORWARD, UPBACK};
+    for(size_t i = 0; i < N_ELEMENTS(movements) && count < AI_LOOKAHEAD_MAX_CANDIDATES; i++) {
+        ai_lookahead_candidate_init(&candidates[count]);
+        ai_lookahead_add_event(&candidates[count], 0, movements[i]);
+        if(movements[i] & ACT_UP) {
+            // release the jump button
+            ai_lookahead_add_event(&candidates[count], 0, ACT_STOP);
+        }
+        moves[count] = NULL;
+        acts[count] = movements[i];
+        count++;
+    }
+
+    int evaluated = ai_lookahead_run(ctrl->gs, h->player_id, candidates, count, LOOKAHEAD_TICKS, LOOKAHEAD_BUDGET_US);
+    if(evaluated < 2 || !candidates[0].evaluated) {
+        // out of time, nothing to compare
+        return false;
+    }
+
+    int best = 0;
+    for(int i = 1; i < count; i++) {
+        if(candidates[i].evaluated && candidates[i].score > candidates[best].score) {
+            best = i;
+        }
+    }
+    if(best == 0) {
+        // nothing works out better than standing still
+        return false;
+    }
+
+    if(moves[best] != NULL) {
+        for(int i = 0; i < 70; i++) {
+            a->move_stats[i].consecutive /= 2;
+        }
+        set_selected_move(ctrl, moves[best]);
+    } else {
+        a->cur_act = acts[best];
+        controller_cmd(ctrl, acts[best], ev);
+        if(acts[best] & ACT_UP) {
+            controller_cmd(ctrl, ACT_STOP, ev);
+        }
+    }
+    reset_act_timer(a);
+    return true;
+}
+
 int ai_controller_poll(controller *ctrl, ctrl_event **ev) {
     ai *a = ctrl->data;
     object *o = game_state_find_object(ctrl->gs, ctrl->har_obj_id);
@@ -2724,6 +2859,11 @@ int ai_controller_poll(controller *ctrl, ctrl_event **ev) {
         }
     }
 
+    // look ahead for the best option, the heuristics below decide if that runs out of time
+    if(a->lookahead && can_move && lookahead_decide(ctrl, ev)) {
+        return 0;
+    }
+
     int enemy_range = get_enemy_range(ctrl);
 
     // attempt a random attack
@@ -2848,6 +2988,8 @@ void ai_controller_create(controller *ctrl, int difficulty, sd_pilot *pilot, int
     a->thrown = 0;
     a->shot = 0;
     vector_create(&a->active_projectiles, sizeof(object *));
+    a->lookahead = a->difficulty >= LOOKAHEAD_MIN_DIFFICULTY && ai_lookahead_enabled();
+    a->lookahead_timer = LOOKAHEAD_INTERVAL;
     pilot->pilot_id = pilot_id;
     a->pilot = pilot;
 
@@ -0,0 +1,231 @@
+#include "controller/ai_lookahead.h"
+#include "controller/controller.h"
+#include "game/game_player.h"
+#include "game/game_state.h"
+#include "game/objects/har.h"
+#include "game/protos/scene.h"
+#include "game/scenes/arena.h"
+#include "utils/allocator.h"
+#include "utils/log.h"
+#include "utils/miscmath.h"
+#include "utils/random.h"
+
+#include <SDL.h>
+#include <string.h>
+
+#define MAX_THREADS 7 // The main thread helps out, so this is enough for 8 cores
+
+typedef struct lookahead_job {
+    game_state gs;       // Clone of the game state. Objects point here, so jobs must not move.
+    controller ctrls[2]; // Stand-ins for the player controllers, see sandbox_controllers()
+    ai_lookahead_candidate *candidate;
+    int player_id;
+    int ticks;
+} lookahead_job;
+
+typedef struct lookahead_pool {
+    SDL_Thread *threads[MAX_THREADS];
+    int thread_count;
+    SDL_mutex *lock;
+    SDL_cond *wake;     // Signaled when a job is added, or when closing
+    SDL_cond *finished; // Signaled when a job has been simulated
+    lookahead_job jobs[AI_LOOKAHEAD_MAX_CANDIDATES];
+    int job_count;     // Jobs that have been set up in the current run
+    int next_job;      // Next job to simulate
+    int running;       // Jobs being simulated right now
+    uint64_t deadline; // Performance counter value at which the current run must stop
+    bool closing;
+} lookahead_pool;
+
+static lookahead_pool *pool = NULL;
+
+// The clone shares its players' controllers with the real game state. HAR events fired during the simulation must
+// not reach the AI (which would learn from things that never happened) or rumble a gamepad, so the clone gets inert
+// copies instead.
+static void sandbox_controllers(lookahead_job *job) {
+    for(int i = 0; i < 2; i++) {
+        game_player *gp = job->gs.players[i];
+        controller *ctrl = &job->ctrls[i];
+        memset(ctrl, 0, sizeof(controller));
+        controller_init(ctrl, &job->gs);
+        if(gp->ctrl != NULL) {
+            ctrl->har_obj_id = gp->ctrl->har_obj_id;
+            ctrl->type = gp->ctrl->type;
+        }
+        gp->ctrl = ctrl;
+    }
+}
+
+static void simulate(lookahead_job *job, uint64_t deadline) {
+    game_state *gs = &job->gs;
+    ai_lookahead_candidate *candidate = job->candidate;
+    object *o_self = game_state_find_object(gs, game_player_get_har_obj_id(gs->players[job->player_id]));
+    object *o_enemy = game_state_find_object(gs, game_player_get_har_obj_id(gs->players[!job->player_id]));
+    if(o_self == NULL || o_enemy == NULL) {
+        goto exit_0;
+    }
+    har *self = object_get_userdata(o_self);
+    har *enemy = object_get_userdata(o_enemy);
+    const int self_health = self->health;
+    const int enemy_health = enemy->health;
+
+    int next_event = 0;
+    for(int tick = 0; tick < job->ticks; tick++) {
+        if(SDL_GetPerformanceCounter() >= deadline) {
+            goto exit_0;
+        }
+        for(; next_event < candidate->event_count && candidate->events[next_event].tick <= tick; next_event++) {
+            object_act(o_self, candidate->events[next_event].action);
+        }
+        game_state_dynamic_tick(gs, true);
+        // Ending the round resets the arena palette, which is not ours to touch. Stop before that.
+        if(self->health <= 0 || enemy->health <= 0 || arena_get_state(gs->sc) != ARENA_STATE_FIGHTING) {
+            break;
+        }
+    }
+    candidate->score = (enemy_health - enemy->health) - (self_health - self->health);
+    candidate->evaluated = true;
+
+exit_0:
+    game_state_clone_free(gs);
+}
+
+// Called with the pool locked, and returns with it locked.
+static void run_next_job(lookahead_pool *p) {
+    lookahead_job *job = &p->jobs[p->next_job++];
+    const uint64_t deadline = p->deadline;
+    p->running++;
+    SDL_UnlockMutex(p->lock);
+    simulate(job, deadline);
+    SDL_LockMutex(p->lock);
+    p->running--;
+    SDL_CondBroadcast(p->finished);
+}
+
+static int lookahead_thread(void *userdata) {
+    lookahead_pool *p = userdata;
+    SDL_LockMutex(p->lock);
+    while(true) {
+        while(p->next_job >= p->job_count && !p->closing) {
+            SDL_CondWait(p->wake, p->lock);
+        }
+        if(p->closing) {
+            break;
+        }
+        run_next_job(p);
+    }
+    SDL_UnlockMutex(p->lock);
+    return 0;
+}
+
+void ai_lookahead_init(void) {
+    lookahead_pool *p = omf_calloc(1, sizeof(lookahead_pool));
+    p->lock = SDL_CreateMutex();
+    p->wake = SDL_CreateCond();
+    p->finished = SDL_CreateCond();
+    const int wanted = clamp(SDL_GetCPUCount() - 1, 0, MAX_THREADS);
+    for(int i = 0; i < wanted; i++) {
+        SDL_Thread *thread = SDL_CreateThread(lookahead_thread, "ai lookahead", p);
+        if(thread == NULL) {
+            log_warn("Unable to start AI lookahead thread: %s", SDL_GetError());
+            break;
+        }
+        p->threads[p->thread_count++] = thread;
+    }
+    log_debug("AI lookahead started with %d worker threads", p->thread_count);
+    pool = p;
+}
+
+void ai_lookahead_close(void) {
+    lookahead_pool *p = pool;
+    if(p == NULL) {
+        return;
+    }
+    SDL_LockMutex(p->lock);
+    p->closing = true;
+    SDL_CondBroadcast(p->wake);
+    SDL_UnlockMutex(p->lock);
+    for(int i = 0; i < p->thread_count; i++) {
+        SDL_WaitThread(p->threads[i], NULL);
+    }
+    SDL_DestroyCond(p->finished);
+    SDL_DestroyCond(p->wake);
+    SDL_DestroyMutex(p->lock);
+    omf_free(p);
+    pool = NULL;
+}
+
+bool ai_lookahead_enabled(void) {
+    return pool != NULL;
+}
+
+void ai_lookahead_candidate_init(ai_lookahead_candidate *candidate) {
+    candidate->event_count = 0;
+    candidate->evaluated = false;
+    candidate->score = 0;
+}
+
+bool ai_lookahead_add_event(ai_lookahead_candidate *candidate, int tick, int action) {
+    if(candidate->event_count >= AI_LOOKAHEAD_MAX_EVENTS) {
+        return false;
+    }
+    ai_lookahead_event *event = &candidate->events[candidate->event_count++];
+    event->tick = (uint8_t)tick;
+    event->action = (uint8_t)action;
+    return true;
+}
+
+int ai_lookahead_run(game_state *gs, int player_id, ai_lookahead_candidate *candidates, int count, int ticks,
+                     int budget_us) {
+    for(int i = 0; i < count; i++) {
+        candidates[i].evaluated = false;
+    }
+    lookahead_pool *p = pool;
+    if(p == NULL || !scene_is_arena(gs->sc)) {
+        return 0;
+    }
+    count = min2(count, AI_LOOKAHEAD_MAX_CANDIDATES);
+    ticks = min2(ticks, UINT8_MAX);
+
+    const uint64_t deadline =
+        SDL_GetPerformanceCounter() + SDL_GetPerformanceFrequency() * (uint64_t)budget_us / 1000000;
+    SDL_LockMutex(p->lock);
+    p->deadline = deadline;
+    SDL_UnlockMutex(p->lock);
+
+    // Clone on this thread, and hand each clone to the workers as soon as it is ready.
+    for(int i = 0; i < count && SDL_GetPerformanceCounter() < deadline; i++) {
+        lookahead_job *job = &p->jobs[i];
+        game_state_clone_lookahead(gs, &job->gs);
+        sandbox_controllers(job);
+        job->candidate = &candidates[i];
+        job->player_id = player_id;
+        job->ticks = ticks;
+
+        SDL_LockMutex(p->lock);
+        p->job_count = i + 1;
+        SDL_CondSignal(p->wake);
+        SDL_UnlockMutex(p->lock);
+    }
+
+    // Help out with the jobs nobody has taken yet. Simulations use the global random number generator, keep them
+    // from changing what the game does next.
+    const uint32_t seed = rand_get_seed();
+    SDL_LockMutex(p->lock);
+    while(p->next_job < p->job_count) {
+        run_next_job(p);
+    }
+    while(p->running > 0) {
+        SDL_CondWait(p->finished, p->lock);
+    }
+    p->job_count = 0;
+    p->next_job = 0;
+    SDL_UnlockMutex(p->lock);
+    rand_seed(seed);
+
+    int evaluated = 0;
+    for(int i = 0; i < count; i++) {
+        evaluated += candidates[i].evaluated;
+    }
+    return evaluated;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file ai_lookahead.h
+ * @brief Simulation of AI input candidates on worker threads
+ * @details The AI controller can hand a set of candidate input sequences to the lookahead. Each candidate is run
+ *          against its own clone of the game state for a number of ticks, and scored by the damage dealt minus the
+ *          damage taken during that time. The clones are made on the calling thread, and simulated on a pool of
+ *          worker threads (and on the calling thread, once it has nothing else to do).
+ *
+ *          A run is limited by a time budget. Candidates that could not be cloned or simulated in time are left
+ *          unevaluated, and the caller is expected to fall back to something cheaper. Worker threads check the
+ *          budget between simulated ticks, so a run may go over it by at most one tick.
+ *
+ *          The enemy is assumed to not give any new inputs during the simulation.
+ * @copyright MIT License
+ * @date 2026
+ * @author OpenOMF Project
+ */
+
+#ifndef AI_LOOKAHEAD_H
+#define AI_LOOKAHEAD_H
+
+#include "game/game_state_type.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define AI_LOOKAHEAD_MAX_CANDIDATES 24 ///< Candidates per run; extra candidates are not evaluated
+#define AI_LOOKAHEAD_MAX_EVENTS 48     ///< Inputs per candidate
+
+/**
+ * @brief Input given to the HAR on a tick of the simulation
+ */
+typedef struct ai_lookahead_event {
+    uint8_t tick;   ///< Simulation tick, counting from 0
+    uint8_t action; ///< ACT_* flags, as passed to object_act()
+} ai_lookahead_event;
+
+/**
+ * @brief Candidate input sequence
+ */
+typedef struct ai_lookahead_candidate {
+    ai_lookahead_event events[AI_LOOKAHEAD_MAX_EVENTS]; ///< Inputs, in tick order
+    int event_count;                                     ///< Number of inputs
+    bool evaluated;                                      ///< Set if the simulation finished within the budget
+    int score;                                           ///< Damage dealt minus damage taken, if evaluated
+} ai_lookahead_candidate;
+
+/**
+ * @brief Start the lookahead worker threads. If no threads can be started, runs are done on the calling thread.
+ */
+void ai_lookahead_init(void);
+
+/**
+ * @brief Stop the lookahead worker threads.
+ */
+void ai_lookahead_close(void);
+
+/**
+ * @brief Check if the lookahead is available. When it is not, ai_lookahead_run() evaluates nothing.
+ */
+bool ai_lookahead_enabled(void);
+
+/**
+ * @brief Clear a candidate.
+ * @param candidate Candidate to clear
+ */
+void ai_lookahead_candidate_init(ai_lookahead_candidate *candidate);
+
+/**
+ * @brief Append an input to a candidate.
+ * @param candidate Candidate to append to
+ * @param tick Simulation tick of the input. Must not be before the previous input.
+ * @param action ACT_* flags
+ * @return False if the candidate is full
+ */
+bool ai_lookahead_add_event(ai_lookahead_candidate *candidate, int tick, int action);
+
+/**
+ * @brief Simulate and score a set of candidates. Must be called from the main thread.
+ * @details The candidates are evaluated in order, so the ones that matter most should come first.
+ * @param gs Current game state, not modified
+ * @param player_id Player whose HAR gets the candidate inputs
+ * @param candidates Candidates to evaluate. The evaluated and score fields are filled in.
+ * @param count Number of candidates
+ * @param ticks Number of ticks to simulate
+ * @param budget_us Time budget for the whole run, in microseconds
+ * @return Number of candidates that were evaluated
+ */
+int ai_lookahead_run(game_state *gs, int player_id, ai_lookahead_candidate *candidates, int count, int ticks,
+                     int budget_us);
+
+#endif // AI_LOOKAHEAD_H
@@ -42,7 +42,8 @@ enum
     EVENT_TYPE_PROPOSE_START,
     EVENT_TYPE_CONFIRM_START,
     EVENT_TYPE_GAME_INFO,
-    EVENT_TYPE_CLOSE
+    EVENT_TYPE_CLOSE,
+    EVENT_TYPE_STATE_DUMP
 };
 
 typedef struct ctrl_event_t ctrl_event;
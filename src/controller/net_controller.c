@@ -5,15 +5,19 @@
 #include <time.h>
 
 #include "controller/net_controller.h"
+#include "controller/net_transcript.h"
 #include "game/game_state_type.h"
 #include "game/protos/scene.h"
 #include "game/scenes/arena.h"
 #include "game/utils/serial.h"
 #include "game/utils/settings.h"
+#include "game/utils/snapshot_ring.h"
+#include "game/utils/state_digest.h"
+#include "resources/resource_files.h"
 #include "utils/allocator.h"
-#include "utils/list.h"
 #include "utils/log.h"
 #include "utils/miscmath.h"
+#include "utils/profiler.h"
 
 typedef struct {
     ENetHost *host;
@@ -45,7 +49,7 @@ typedef struct {
     uint32_t last_int_tick;
     // the last tick we've sent to the peer
     uint32_t last_sent_tick;
-    list transcript;
+    net_transcript transcript;
     // the last tick we've received from the peer
     uint32_t last_received_tick;
     // the tick of the last event the peer has ACKed
@@ -68,16 +72,92 @@ typedef struct {
     // the last action the peer took
     uint8_t last_peer_action;
     SDL_RWops *trace_file;
+    // snapshots of the game state at ticks both sides have agreed on
+    snapshot_ring snapshots;
+    // the newest snapshot, owned by the ring
     game_state *gs_bak;
+    // buffers for hashing the game state
+    state_digest digest;
+    // our and the peer's state at the first hash mismatch
+    str local_dump;
+    str peer_dump;
+    uint32_t local_dump_tick;
+    uint32_t peer_dump_tick;
+    bool desync_reported;
     int winner;
 } wtf;
 
-#define MAX_EVENTS_PER_TICK 11
+// how many agreed-on game states to keep around. Rewinds only ever go back to the newest one.
+#define NET_SNAPSHOT_COUNT 1
 
-typedef struct {
-    uint32_t tick;
-    uint8_t events[2][MAX_EVENTS_PER_TICK];
-} tick_events;
+// remote inputs for ticks further than this from our own tick can't be genuine, and are dropped
+#define NET_REMOTE_TICK_WINDOW 1000
+static_assert(NET_REMOTE_TICK_WINDOW * 2 < NET_TRANSCRIPT_MAX_WINDOW, "the transcript must fit the remote tick window");
+
+static bool remote_tick_in_window(uint32_t local_tick, uint32_t remote_tick) {
+    uint32_t distance = remote_tick > local_tick ? remote_tick - local_tick : local_tick - remote_tick;
+    return distance <= NET_REMOTE_TICK_WINDOW;
+}
+
+static uint32_t state_hash(wtf *data, game_state *gs) {
+    // The hash field in the packets is 32 bits wide, and the lobby reads it too, so the digest is folded to fit.
+    return state_digest_fold(state_digest_hash(&data->digest, gs));
+}
+
+static void write_desync_file(uint32_t tick, const char *side, const str *text) {
+    char name[64];
+    snprintf(name, sizeof(name), "desync_%" PRIu32 "_%s.txt", tick, side);
+    path filename = get_desync_dump_filename(name);
+    FILE *fp = path_fopen(&filename, "w");
+    if(fp == NULL) {
+        log_error("Unable to write desync dump %s", path_c(&filename));
+        return;
+    }
+    fwrite(str_c(text), 1, str_size(text), fp);
+    fclose(fp);
+    log_info("Wrote desync dump %s", path_c(&filename));
+}
+
+// once both our and the peer's state are known, report the fields that differ
+static void report_desync(wtf *data) {
+    if(data->desync_reported || str_size(&data->local_dump) == 0 || str_size(&data->peer_dump) == 0) {
+        return;
+    }
+    data->desync_reported = true;
+    if(data->local_dump_tick != data->peer_dump_tick) {
+        log_warn("desync dumps are from different ticks (local %" PRIu32 ", peer %" PRIu32 "), not comparing them",
+                 data->local_dump_tick, data->peer_dump_tick);
+        return;
+    }
+    str diff;
+    str_create(&diff);
+    int count = state_digest_diff(&data->local_dump, &data->peer_dump, &diff);
+    log_error("desync at tick %" PRIu32 ", %d fields differ (local != peer):\n%s", data->local_dump_tick, count,
+              str_c(&diff));
+    write_desync_file(data->local_dump_tick, "diff", &diff);
+    str_free(&diff);
+}
+
+// dump our state at the mismatched tick, and send it to the peer so that both sides can diff
+static void dump_desync(wtf *data, game_state *gs, uint32_t tick) {
+    if(str_size(&data->local_dump) > 0) {
+        return;
+    }
+    state_digest_dump(&data->digest, gs, &data->local_dump);
+    data->local_dump_tick = tick;
+    write_desync_file(tick, "local", &data->local_dump);
+
+    serial ser;
+    serial_create(&ser);
+    serial_write_int8(&ser, EVENT_TYPE_STATE_DUMP);
+    serial_write_uint32(&ser, tick);
+    serial_write(&ser, str_c(&data->local_dump), str_size(&data->local_dump));
+    ENetPacket *packet = enet_packet_create(ser.data, serial_len(&ser), ENET_PACKET_FLAG_RELIABLE);
+    enet_peer_send(data->peer, 2, packet);
+    serial_free(&ser);
+
+    report_desync(data);
+}
 
 // simple standard deviation calculation
 float stddev(float average, int data[], int n) {
@@ -119,19 +199,6 @@ int avg_rtt(wtf *data) {
 
 // insert an event into the event trace
 void insert_event(wtf *data, uint32_t tick, uint16_t action, int id) {
-
-    iterator it;
-    list *transcript = &data->transcript;
-    list_iter_begin(transcript, &it);
-    tick_events *ev = NULL;
-    tick_events *nev = NULL;
-    tick_events event;
-    event.tick = tick;
-    memset(event.events[id], 0, MAX_EVENTS_PER_TICK);
-    memset(event.events[abs(id - 1)], 0, MAX_EVENTS_PER_TICK);
-    event.events[id][0] = action;
-    int i = 0;
-
     if(data->id == id && data->last_action == action) {
         // dedup inputs
         return;
@@ -147,33 +214,26 @@ void insert_event(wtf *data, uint32_t tick, uint16_t action, int id) {
         data->last_peer_input_tick = tick;
     }
 
-    foreach(it, ev) {
-        if(i == 0 && ev->tick > tick) {
-            list_prepend(transcript, &event, sizeof(tick_events));
-            goto done;
-        } else if(ev->tick == tick) {
-            for(int j = 0; j < MAX_EVENTS_PER_TICK; j++) {
-                if(ev->events[id][j] == 0) {
-                    if(j > 0 && ev->events[id][j - 1] == action) {
-                        // dedup
-                        return;
-                    }
-                    ev->events[id][j] = action;
-                    break;
+    tick_events *ev = net_transcript_get(&data->transcript, tick);
+    if(ev == NULL) {
+        ev = net_transcript_insert(&data->transcript, tick);
+        if(ev == NULL) {
+            log_warn("dropping input for tick %" PRIu32 ", too far from the transcript window", tick);
+            return;
+        }
+        ev->events[id][0] = action;
+    } else {
+        for(int j = 0; j < MAX_EVENTS_PER_TICK; j++) {
+            if(ev->events[id][j] == 0) {
+                if(j > 0 && ev->events[id][j - 1] == action) {
+                    // dedup
+                    return;
                 }
+                ev->events[id][j] = action;
+                break;
             }
-            goto done;
-        }
-        nev = iter_peek(&it);
-        if(ev->tick < tick && nev && nev->tick > tick) {
-            list_iter_append(&it, &event, sizeof(tick_events));
-            goto done;
         }
-        i++;
     }
-    // either the list is empty, or this tick is later than anything else
-    list_append(transcript, &event, sizeof(tick_events));
-done:
     if(id == data->id) {
         data->last_action = action;
     }
@@ -181,12 +241,10 @@ done:
 
 // check if we have any events to send
 bool has_event(wtf *data, int delay) {
-
-    iterator it;
-    list_iter_begin(&data->transcript, &it);
-    tick_events *ev = NULL;
-    foreach(it, ev) {
-        if(ev->tick < data->last_tick + delay && ev->tick > data->last_sent_tick && ev->events[data->id][0]) {
+    const net_transcript *transcript = &data->transcript;
+    for(tick_events *ev = net_transcript_next(transcript, data->last_sent_tick + 1);
+        ev && ev->tick < data->last_tick + delay; ev = net_transcript_next(transcript, ev->tick + 1)) {
+        if(ev->events[data->id][0]) {
             return true;
         }
     }
@@ -244,11 +302,8 @@ void event_names(char *buf, uint8_t *actions) {
     *buf++ = '\0';
 }
 
-void print_transcript(list *transcript) {
-    iterator it;
-    list_iter_begin(transcript, &it);
-    tick_events *ev = NULL;
-    foreach(it, ev) {
+void print_transcript(const net_transcript *transcript) {
+    for(tick_events *ev = net_transcript_next(transcript, 0); ev; ev = net_transcript_next(transcript, ev->tick + 1)) {
         log_debug("tick %d has events %d -- %d", ev->tick, ev->events[0][0], ev->events[1][0]);
     }
 }
@@ -259,10 +314,7 @@ void send_events(wtf *data, int delay) {
     ENetPacket *packet;
     ENetPeer *peer = data->peer;
     ENetHost *host = data->host;
-    list *transcript = &data->transcript;
-    iterator it;
-    list_iter_begin(transcript, &it);
-    tick_events *ev = NULL;
+    const net_transcript *transcript = &data->transcript;
     serial_create(&ser);
     // ACTION header
     serial_write_int8(&ser, EVENT_TYPE_ACTION);
@@ -277,9 +329,11 @@ void send_events(wtf *data, int delay) {
 
     int last_sent_tick = 0;
 
-    foreach(it, ev) {
-        if(ev->events[data->id][0] != 0 && ev->tick > data->last_acked_tick &&
-           ev->tick < data->last_tick - data->local_proposal + delay) {
+    // Only the ticks the peer has not acknowledged yet need to be sent.
+    for(tick_events *ev = net_transcript_next(transcript, data->last_acked_tick + 1);
+        ev && ev->tick < data->last_tick - data->local_proposal + delay;
+        ev = net_transcript_next(transcript, ev->tick + 1)) {
+        if(ev->events[data->id][0] != 0) {
             // each tick is written as the 32 bit tick value and a 0 terminated list of u8 actions on that tick
             serial_write_uint32(&ser, ev->tick);
             int i = 0;
@@ -344,17 +398,15 @@ void send_game_information(wtf *data) {
 int rewind_and_replay(wtf *data, controller *ctrl) {
     // first, find the last frame we have input from the other side
     // this will be our next checkpoint (as no events can come in before
-    iterator it;
     game_state *gs_current = ctrl->gs;
-    list *transcript = &data->transcript;
-    list_iter_begin(transcript, &it);
+    net_transcript *transcript = &data->transcript;
     tick_events *ev = NULL;
-    game_state *gs = data->gs_bak;
-    game_state *gs_new = NULL;
+    uint32_t saved_tick = data->gs_bak->tick;
+    bool saved = false;
     char buf[512];
 
-    game_state *gs_old = omf_calloc(1, sizeof(game_state));
-    game_state_clone(gs, gs_old);
+    // replay on a copy, the snapshot stays in the ring in case we need to rewind to it again
+    game_state *gs = snapshot_ring_restore(data->gs_bak);
 
     log_debug("current game ticks is %" PRIu32 ", stored game ticks are %" PRIu32 ", last tick is %" PRIu32,
               gs_current->tick - data->local_proposal, gs->tick - data->local_proposal,
@@ -376,18 +428,14 @@ int rewind_and_replay(wtf *data, controller *ctrl) {
 
     uint32_t confirm_frame = data->last_acked_tick;
 
-    ev = iter_next(&it);
-
     uint32_t start_tick = gs->tick - data->local_proposal;
 
-    while(ev && ev->tick <= start_tick) {
-        // tick too old to matter
-        list_delete(transcript, &it);
-        ev = iter_next(&it);
-    }
+    // ticks up to the snapshot are too old to matter
+    net_transcript_trim(transcript, start_tick + 1);
 
     while(gs->tick < gs_current->tick) {
-        if(ev && ev->tick == gs->tick - data->local_proposal) {
+        ev = net_transcript_get(transcript, gs->tick - data->local_proposal);
+        if(ev) {
             // feed in the inputs
             for(int j = 0; j < 2; j++) {
                 int player_id = j;
@@ -401,7 +449,7 @@ int rewind_and_replay(wtf *data, controller *ctrl) {
             }
 
             // update arena hash now inputs have been done
-            arena_hash = arena_state_hash(gs);
+            arena_hash = state_hash(data, gs);
 
             if((ev->events[0][0] || ev->events[1][0]) && ev->tick <= confirm_frame &&
                ev->tick > data->last_traced_tick) {
@@ -483,7 +531,6 @@ int rewind_and_replay(wtf *data, controller *ctrl) {
                     SDL_RWwrite(data->trace_file, buf, strlen(buf), 1);
                 }
             }
-            ev = iter_next(&it);
         } else {
             // only do this if we're not on the first tick of the replay
             if(gs->tick - data->local_proposal > start_tick) {
@@ -498,7 +545,7 @@ int rewind_and_replay(wtf *data, controller *ctrl) {
             }
 
             // update arena hash now inputs have been done
-            arena_hash = arena_state_hash(gs);
+            arena_hash = state_hash(data, gs);
 
             if(data->trace_file && gs->tick - data->local_proposal <= confirm_frame &&
                gs->tick - data->local_proposal > data->last_traced_tick) {
@@ -514,16 +561,13 @@ int rewind_and_replay(wtf *data, controller *ctrl) {
 
         // The next tick is past when we have agreement, so we need to save the last known good game state
         // for future replays
-        if(gs_new == NULL && gs->tick - data->local_proposal == confirm_frame && gs->tick > gs_old->tick) {
+        if(!saved && gs->tick - data->local_proposal == confirm_frame && gs->tick > saved_tick) {
             log_debug("saving game state at last agreed on tick %d with hash %" PRIu32, gs->tick - data->local_proposal,
-                      arena_state_hash(gs));
+                      state_hash(data, gs));
             // save off the game state at the point we last agreed
             // on the state of the game
-            gs_new = omf_calloc(1, sizeof(game_state));
-            game_state_clone(gs, gs_new);
-            data->gs_bak = gs_new;
-            game_state_clone_free(gs_old);
-            omf_free(gs_old);
+            data->gs_bak = snapshot_ring_save(&data->snapshots, gs);
+            saved = true;
         }
 
         if(data->peer_last_hash_tick && gs->tick - data->local_proposal == data->peer_last_hash_tick &&
@@ -549,6 +593,7 @@ int rewind_and_replay(wtf *data, controller *ctrl) {
 
             log_debug("arena hash mismatch at %d (%d) -- got %" PRIu32 " expected %" PRIu32 "!",
                       gs->tick - data->local_proposal, data->peer_last_hash_tick, data->peer_last_hash, arena_hash);
+            dump_desync(data, gs, gs->tick - data->local_proposal);
 
             // Update our last hash to this mismatched one, and send the events to the peer.
             // This accomplishes two things:
@@ -566,8 +611,7 @@ int rewind_and_replay(wtf *data, controller *ctrl) {
                     c->gs = gs_current;
                 }
             }
-            game_state_clone_free(gs_old);
-            omf_free(gs_old);
+            game_state_clone_recycle(gs);
             return 1;
         } else if(gs->tick - data->local_proposal == data->peer_last_hash_tick) {
             log_debug("arena hashes agree!");
@@ -584,11 +628,6 @@ int rewind_and_replay(wtf *data, controller *ctrl) {
 
     uint64_t replay_end = SDL_GetTicks64();
 
-    if(gs_new == NULL) {
-        // we weren't able to make a new state backup, so restore the old one
-        data->gs_bak = gs_old;
-    }
-
     log_debug("advanced game state to %" PRIu32 ", expected %" PRIu32, gs->tick - data->local_proposal,
               data->last_tick - data->local_proposal);
 
@@ -597,11 +636,9 @@ int rewind_and_replay(wtf *data, controller *ctrl) {
     // replace the game state with the replayed one
     gs->new_state = NULL;
     if(gs_current->new_state) {
-        game_state_clone_free(gs_current->new_state);
-        omf_free(gs_current->new_state);
+        game_state_clone_recycle(gs_current->new_state);
     }
     gs_current->new_state = gs;
-    data->gs_bak->new_state = NULL;
 
     return 0;
 }
@@ -651,10 +688,9 @@ void net_controller_free(controller *ctrl) {
 
         SDL_RWwrite(data->trace_file, buf, sz, 1);
 
-        iterator it;
-        list_iter_begin(&data->transcript, &it);
-        tick_events *ev = NULL;
-        foreach(it, ev) {
+        const net_transcript *transcript = &data->transcript;
+        for(tick_events *ev = net_transcript_next(transcript, 0); ev;
+            ev = net_transcript_next(transcript, ev->tick + 1)) {
             log_debug("tick %" PRIu32 " has events %d -- %d", ev->tick, ev->events[0][0], ev->events[1][0]);
             char buf0[12];
             char buf1[12];
@@ -698,11 +734,12 @@ done:
         enet_host_destroy(data->host);
         data->host = NULL;
     }
-    list_free(&data->transcript);
-    if(data->gs_bak) {
-        game_state_clone_free(data->gs_bak);
-        omf_free(data->gs_bak);
-    }
+    net_transcript_free(&data->transcript);
+    snapshot_ring_free(&data->snapshots);
+    state_digest_free(&data->digest);
+    str_free(&data->local_dump);
+    str_free(&data->peer_dump);
+    data->gs_bak = NULL;
     if(ctrl->data) {
         omf_free(ctrl->data);
     }
@@ -750,18 +787,19 @@ int net_controller_tick(controller *ctrl, uint32_t ticks0, ctrl_event **ev) {
        game_state_find_object(ctrl->gs, game_player_get_har_obj_id(game_state_get_player(ctrl->gs, 1)))) {
         arena_reset(ctrl->gs->sc);
 
-        data->gs_bak = omf_calloc(1, sizeof(game_state));
-        game_state_clone(ctrl->gs, data->gs_bak);
+        data->gs_bak = snapshot_ring_save(&data->snapshots, ctrl->gs);
         send_game_information(data);
         log_debug("cloned game state at arena tick %d hash %" PRIu32, data->gs_bak->tick - data->local_proposal,
-                  arena_state_hash(data->gs_bak));
+                  state_hash(data, data->gs_bak));
         data->local_proposal = ticks; // reset the tick offset to the start of the match
         data->last_hash_tick = data->gs_bak->tick - data->local_proposal;
-        data->last_hash = arena_state_hash(data->gs_bak);
+        data->last_hash = state_hash(data, data->gs_bak);
     } else if(data->gs_bak != NULL && !scene_is_arena(game_state_get_scene(ctrl->gs))) {
         // changed scene and no longer need a game state backup, release it
-        game_state_clone_free(data->gs_bak);
-        omf_free(data->gs_bak);
+        snapshot_ring_clear(&data->snapshots);
+        str_set_c(&data->local_dump, "");
+        str_set_c(&data->peer_dump, "");
+        data->desync_reported = false;
         data->last_action = ACT_NONE;
         data->synchronized = false;
         data->local_proposal = 0;
@@ -779,8 +817,7 @@ int net_controller_tick(controller *ctrl, uint32_t ticks0, ctrl_event **ev) {
         data->last_hash = 0;
         data->last_hash_tick = 0;
 
-        list_free(&data->transcript);
-        list_create(&data->transcript);
+        net_transcript_clear(&data->transcript);
     }
 
     bool has_received = false;
@@ -825,7 +862,8 @@ int net_controller_tick(controller *ctrl, uint32_t ticks0, ctrl_event **ev) {
                                 k++;
 
                                 if(data->synchronized && data->gs_bak) {
-                                    if(remote_tick > data->last_received_tick) {
+                                    if(remote_tick > data->last_received_tick &&
+                                       remote_tick_in_window(ticks - data->local_proposal, remote_tick)) {
                                         has_received = true;
                                         if(action) {
                                             insert_event(data, remote_tick, action, abs(data->id - 1));
@@ -857,7 +895,7 @@ int net_controller_tick(controller *ctrl, uint32_t ticks0, ctrl_event **ev) {
                                 data->peer_last_hash = peer_last_hash;
                                 log_debug("peer last hash is %" PRIu32 " %d, local is %d %" PRIu32,
                                           data->peer_last_hash_tick, data->peer_last_hash,
-                                          data->gs_bak->tick - data->local_proposal, arena_state_hash(data->gs_bak));
+                                          data->gs_bak->tick - data->local_proposal, state_hash(data, data->gs_bak));
                             }
                         }
                     } break;
@@ -1070,6 +1108,16 @@ int net_controller_tick(controller *ctrl, uint32_t ticks0, ctrl_event **ev) {
                         }
                         str_free(&their_name);
                     } break;
+                    case EVENT_TYPE_STATE_DUMP: {
+                        // the rest of the packet is the peer's state dump
+                        uint32_t tick = serial_read_uint32(&ser);
+                        if(str_size(&data->peer_dump) == 0) {
+                            str_append_buf(&data->peer_dump, ser.data + ser.rpos, ser.wpos - ser.rpos);
+                            data->peer_dump_tick = tick;
+                            write_desync_file(tick, "peer", &data->peer_dump);
+                            report_desync(data);
+                        }
+                    } break;
                     default:
                         // Event type is unknown or we don't care about it
                         break;
@@ -1090,13 +1138,10 @@ int net_controller_tick(controller *ctrl, uint32_t ticks0, ctrl_event **ev) {
                     rewind_and_replay(data, ctrl);
                 }
                 if(ctrl->gs->new_state) {
-                    game_state_clone_free(ctrl->gs->new_state);
-                    omf_free(ctrl->gs->new_state);
-                }
-                if(data->gs_bak) {
-                    game_state_clone_free(data->gs_bak);
-                    omf_free(data->gs_bak);
+                    game_state_clone_recycle(ctrl->gs->new_state);
                 }
+                snapshot_ring_clear(&data->snapshots);
+                data->gs_bak = NULL;
                 if(ctrl->gs->rec) {
                     sd_rec_finish(ctrl->gs->rec, ticks - data->local_proposal);
                 }
@@ -1120,7 +1165,10 @@ int net_controller_tick(controller *ctrl, uint32_t ticks0, ctrl_event **ev) {
         // || (data->gs_bak && data->last_received_tick +
         // tick_drift > data->last_rewind_tick)) {
         log_debug("last received is now %d", data->last_received_tick);
-        if(rewind_and_replay(data, ctrl)) {
+        profiler_begin(PROFILER_REPLAY);
+        int replay_failed = rewind_and_replay(data, ctrl);
+        profiler_end(PROFILER_REPLAY);
+        if(replay_failed) {
             if(ctrl->gs->rec) {
                 sd_rec_finish(ctrl->gs->rec, ticks - data->local_proposal);
             }
@@ -1258,30 +1306,31 @@ int net_controller_poll(controller *ctrl, ctrl_event **ev) {
     if(ctrl->gs->clone) {
         return 0;
     }
-    iterator it;
-    list *transcript = &data->transcript;
-    list_iter_begin(transcript, &it);
-    tick_events *e = NULL;
+    const net_transcript *transcript = &data->transcript;
     int id = abs(data->id - 1);
     uint32_t current_tick = ctrl->gs->tick - data->local_proposal;
     // last peer input may be from before, so start with that
     uint8_t last = data->last_peer_action;
 
-    foreach(it, e) {
-        if(e->events[id][0] != 0 && e->tick == current_tick) {
-            // events for the current tick, send em all
-            int i = 0;
-            while(e->events[id][i]) {
-                controller_cmd(ctrl, e->events[id][i], ev);
-                i++;
-            }
-            return 0;
-        } else if(e->events[id][0] != 0 && e->tick < current_tick) {
+    tick_events *e = net_transcript_get(transcript, current_tick);
+    if(e && e->events[id][0] != 0) {
+        // events for the current tick, send em all
+        int i = 0;
+        while(e->events[id][i]) {
+            controller_cmd(ctrl, e->events[id][i], ev);
+            i++;
+        }
+        return 0;
+    }
+    // otherwise, the peer is still doing whatever it did last
+    for(e = net_transcript_prev(transcript, current_tick); e; e = net_transcript_prev(transcript, e->tick)) {
+        if(e->events[id][0] != 0) {
             int i = 0;
             while(e->events[id][i] && i < MAX_EVENTS_PER_TICK) {
                 last = e->events[id][i];
                 i++;
             }
+            break;
         }
     }
     // return the last input we've gotten from the peer
@@ -1317,6 +1366,7 @@ void net_controller_create(controller *ctrl, ENetHost *host, ENetPeer *peer, ENe
     data->last_action = ACT_NONE;
     data->last_peer_action = ACT_NONE;
     data->last_peer_input_tick = 0;
+    snapshot_ring_create(&data->snapshots, NET_SNAPSHOT_COUNT);
     char *trace_file = settings_get()->net.trace_file;
     if(trace_file) {
         data->trace_file = SDL_RWFromFile(trace_file, "w");
@@ -1324,7 +1374,10 @@ void net_controller_create(controller *ctrl, ENetHost *host, ENetPeer *peer, ENe
             log_debug("failed to open trace file");
         }
     }
-    list_create(&data->transcript);
+    net_transcript_create(&data->transcript);
+    state_digest_create(&data->digest);
+    str_create(&data->local_dump);
+    str_create(&data->peer_dump);
     ctrl->data = data;
     ctrl->type = CTRL_TYPE_NETWORK;
     ctrl->tick_fun = &net_controller_tick;
@@ -0,0 +1,127 @@
+#include "controller/net_transcript.h"
+#include "utils/allocator.h"
+
+#include <assert.h>
+#include <string.h>
+
+#define INITIAL_CAPACITY 256
+
+static inline transcript_slot *slot_of(const net_transcript *t, uint32_t tick) {
+    return &t->slots[tick & (t->capacity - 1)];
+}
+
+static inline bool in_window(const net_transcript *t, uint32_t tick) {
+    return tick >= t->first_tick && tick < t->end_tick;
+}
+
+void net_transcript_create(net_transcript *t) {
+    t->capacity = INITIAL_CAPACITY;
+    t->slots = omf_calloc(t->capacity, sizeof(transcript_slot));
+    t->first_tick = 0;
+    t->end_tick = 0;
+}
+
+void net_transcript_free(net_transcript *t) {
+    omf_free(t->slots);
+    t->capacity = 0;
+    t->first_tick = 0;
+    t->end_tick = 0;
+}
+
+void net_transcript_clear(net_transcript *t) {
+    memset(t->slots, 0, t->capacity * sizeof(transcript_slot));
+    t->first_tick = 0;
+    t->end_tick = 0;
+}
+
+/**
+ * Grow the slot array until the window [first, end) fits, and move the used slots to their new positions.
+ * Returns false, and leaves the transcript as it was, if the window would span more than NET_TRANSCRIPT_MAX_WINDOW
+ * ticks.
+ */
+static bool grow(net_transcript *t, uint32_t first, uint32_t end) {
+    const uint32_t size = end - first;
+    if(size > NET_TRANSCRIPT_MAX_WINDOW) {
+        return false;
+    }
+    uint32_t capacity = t->capacity;
+    while(size > capacity) {
+        capacity *= 2;
+    }
+    if(capacity == t->capacity) {
+        return true;
+    }
+    transcript_slot *slots = omf_calloc(capacity, sizeof(transcript_slot));
+    for(uint32_t tick = t->first_tick; tick < t->end_tick; tick++) {
+        const transcript_slot *old = slot_of(t, tick);
+        if(old->used) {
+            slots[tick & (capacity - 1)] = *old;
+        }
+    }
+    omf_free(t->slots);
+    t->slots = slots;
+    t->capacity = capacity;
+    return true;
+}
+
+tick_events *net_transcript_get(const net_transcript *t, uint32_t tick) {
+    if(!in_window(t, tick)) {
+        return NULL;
+    }
+    transcript_slot *slot = slot_of(t, tick);
+    return slot->used ? &slot->events : NULL;
+}
+
+tick_events *net_transcript_insert(net_transcript *t, uint32_t tick) {
+    if(t->first_tick == t->end_tick) {
+        t->first_tick = tick;
+        t->end_tick = tick + 1;
+    } else if(tick < t->first_tick) {
+        if(!grow(t, tick, t->end_tick)) {
+            return NULL;
+        }
+        t->first_tick = tick;
+    } else if(tick >= t->end_tick) {
+        if(tick == UINT32_MAX || !grow(t, t->first_tick, tick + 1)) {
+            return NULL;
+        }
+        t->end_tick = tick + 1;
+    }
+
+    transcript_slot *slot = slot_of(t, tick);
+    if(!slot->used) {
+        memset(&slot->events, 0, sizeof(tick_events));
+        slot->events.tick = tick;
+        slot->used = true;
+    }
+    assert(slot->events.tick == tick);
+    return &slot->events;
+}
+
+tick_events *net_transcript_next(const net_transcript *t, uint32_t tick) {
+    for(tick = tick > t->first_tick ? tick : t->first_tick; tick < t->end_tick; tick++) {
+        transcript_slot *slot = slot_of(t, tick);
+        if(slot->used) {
+            return &slot->events;
+        }
+    }
+    return NULL;
+}
+
+tick_events *net_transcript_prev(const net_transcript *t, uint32_t tick) {
+    for(tick = tick < t->end_tick ? tick : t->end_tick; tick > t->first_tick; tick--) {
+        transcript_slot *slot = slot_of(t, tick - 1);
+        if(slot->used) {
+            return &slot->events;
+        }
+    }
+    return NULL;
+}
+
+void net_transcript_trim(net_transcript *t, uint32_t tick) {
+    // Unused slots are skipped as well, so that the window always starts at a recorded tick.
+    while(t->first_tick < t->end_tick && (t->first_tick < tick || !slot_of(t, t->first_tick)->used)) {
+        slot_of(t, t->first_tick)->used = false;
+        t->first_tick++;
+    }
+}
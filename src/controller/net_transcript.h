@@ -0,0 +1,109 @@
+/**
+ * @file net_transcript.h
+ * @brief Tick-indexed input transcript for network play
+ * @details Inputs of both players are stored in a circular buffer of slots, where the slot of a tick is found
+ *          directly from the tick number. This makes lookups and inserts O(1) regardless of the order in which
+ *          inputs arrive, and ranges of ticks can be walked without scanning from the start of the match.
+ *          The buffer covers a window of ticks, which grows when needed and is trimmed from the front once
+ *          the old inputs are no longer needed for replays.
+ * @copyright MIT License
+ * @date 2026
+ * @author OpenOMF Project
+ */
+
+#ifndef NET_TRANSCRIPT_H
+#define NET_TRANSCRIPT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define MAX_EVENTS_PER_TICK 11
+#define NET_TRANSCRIPT_MAX_WINDOW (1u << 16) ///< Most ticks the window can span, must be a power of two
+
+/**
+ * @brief Inputs of both players on one tick. Action lists are terminated by a 0 entry, unless full.
+ */
+typedef struct tick_events {
+    uint32_t tick;
+    uint8_t events[2][MAX_EVENTS_PER_TICK];
+} tick_events;
+
+/**
+ * @brief A single transcript slot.
+ */
+typedef struct transcript_slot {
+    bool used;          ///< True if the slot holds events for the tick it maps to
+    tick_events events; ///< Events of the tick
+} transcript_slot;
+
+/**
+ * @brief Transcript window. All slots outside of [first_tick, end_tick) are unused, and the window is empty when
+ *        first_tick == end_tick.
+ */
+typedef struct net_transcript {
+    transcript_slot *slots; ///< Slot for a tick is at tick & (capacity - 1)
+    uint32_t capacity;      ///< Number of slots, a power of two
+    uint32_t first_tick;    ///< First tick of the window
+    uint32_t end_tick;      ///< One past the last tick of the window
+} net_transcript;
+
+/**
+ * @brief Allocate an empty transcript.
+ * @param t Transcript to initialize
+ */
+void net_transcript_create(net_transcript *t);
+
+/**
+ * @brief Free the transcript slots.
+ * @param t Transcript to free
+ */
+void net_transcript_free(net_transcript *t);
+
+/**
+ * @brief Remove all events, but keep the slots allocated.
+ * @param t Transcript to clear
+ */
+void net_transcript_clear(net_transcript *t);
+
+/**
+ * @brief Find the events of a tick.
+ * @param t Transcript to search
+ * @param tick Tick to look up
+ * @return Events, or NULL if nothing has been recorded for the tick.
+ */
+tick_events *net_transcript_get(const net_transcript *t, uint32_t tick);
+
+/**
+ * @brief Find the events of a tick, creating an empty entry if there is none.
+ * @details Pointers returned earlier may be invalidated, if the window has to grow.
+ * @param t Transcript to insert to
+ * @param tick Tick to look up
+ * @return Events of the tick, or NULL if the window would have to span more than NET_TRANSCRIPT_MAX_WINDOW ticks
+ */
+tick_events *net_transcript_insert(net_transcript *t, uint32_t tick);
+
+/**
+ * @brief Find the first recorded tick at or after the given tick.
+ * @details Use this for walking ranges: start from the first tick of interest, and continue from the found tick + 1.
+ * @param t Transcript to search
+ * @param tick First tick to consider
+ * @return Events, or NULL if there are no recorded ticks at or after the tick.
+ */
+tick_events *net_transcript_next(const net_transcript *t, uint32_t tick);
+
+/**
+ * @brief Find the last recorded tick before the given tick.
+ * @param t Transcript to search
+ * @param tick Tick to search backwards from (exclusive)
+ * @return Events, or NULL if there are no recorded ticks before the tick.
+ */
+tick_events *net_transcript_prev(const net_transcript *t, uint32_t tick);
+
+/**
+ * @brief Drop all events before the given tick.
+ * @param t Transcript to trim
+ * @param tick First tick to keep
+ */
+void net_transcript_trim(net_transcript *t, uint32_t tick);
+
+#endif // NET_TRANSCRIPT_H
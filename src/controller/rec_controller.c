@@ -4,31 +4,28 @@
 #include "game/game_player.h"
 #include "game/game_state_type.h"
 #include "game/protos/scene.h"
+#include "game/utils/snapshot_ring.h"
 #include "utils/allocator.h"
 #include "utils/crash.h"
 #include "utils/log.h"
 #include <inttypes.h>
 
+// a snapshot is taken every REC_SNAPSHOT_INTERVAL ticks, and the last REC_SNAPSHOT_COUNT of them are kept
+#define REC_SNAPSHOT_INTERVAL 10
+#define REC_SNAPSHOT_COUNT 64
+
 typedef struct {
     int player_id;
     uint32_t last_tick;
     uint32_t max_tick;
     hashmap tick_lookup;
-    vector game_states;
+    snapshot_ring snapshots;
 } rec_controller_data;
 
 void rec_controller_free(controller *ctrl) {
     rec_controller_data *data = ctrl->data;
     if(data) {
-
-        iterator it;
-        vector_iter_begin(&data->game_states, &it);
-        game_state *gs = NULL;
-        foreach(it, gs) {
-            game_state_clone_free(gs);
-        }
-        vector_free(&data->game_states);
-
+        snapshot_ring_free(&data->snapshots);
         hashmap_free(&data->tick_lookup);
         omf_free(data);
     }
@@ -127,11 +124,10 @@ int rec_controller_poll(controller *ctrl, ctrl_event **ev) {
 
 int rec_controller_dyntick(controller *ctrl, uint32_t ticks, ctrl_event **ev) {
     rec_controller_data *data = ctrl->data;
-    if(data->player_id == 0 && ticks % 10 == 0) {
+    if(data->player_id == 0 && ticks % REC_SNAPSHOT_INTERVAL == 0) {
         if(scene_is_arena(game_state_get_scene(ctrl->gs)) &&
            game_state_find_object(ctrl->gs, game_player_get_har_obj_id(game_state_get_player(ctrl->gs, 1)))) {
-            game_state *gs_bak = vector_append_ptr(&data->game_states);
-            game_state_clone(ctrl->gs, gs_bak);
+            snapshot_ring_save(&data->snapshots, ctrl->gs);
         }
     }
     return 0;
@@ -170,15 +166,21 @@ void rec_controller_step_back(controller *ctrl) {
         data->last_tick = ctrl->gs->tick;
         return;
     }
-    game_state *gs_bak = vector_back(&data->game_states);
-    while(vector_size(&data->game_states) > 1 && gs_bak->tick >= ctrl->gs->tick) {
-        game_state_clone_free(gs_bak);
-        vector_pop(&data->game_states);
-        gs_bak = vector_back(&data->game_states);
+    // step back to the newest snapshot before the current tick, or as far back as the ring goes
+    game_state *gs_bak = NULL;
+    if(ctrl->gs->tick > 0) {
+        gs_bak = snapshot_ring_find(&data->snapshots, ctrl->gs->tick - 1);
+    }
+    if(gs_bak == NULL) {
+        gs_bak = snapshot_ring_oldest(&data->snapshots);
+    }
+    if(gs_bak == NULL) {
+        log_debug("no game state to rewind to at tick %d", ctrl->gs->tick);
+        return;
     }
+    snapshot_ring_truncate(&data->snapshots, gs_bak->tick);
 
-    game_state *gs_new = omf_calloc(1, sizeof(game_state));
-    game_state_clone(gs_bak, gs_new);
+    game_state *gs_new = snapshot_ring_restore(gs_bak);
     gs_new->clone = false;
     ctrl->gs->new_state = gs_new;
 
@@ -204,7 +206,7 @@ void rec_controller_create(controller *ctrl, int player, sd_rec_file *rec) {
     data->last_tick = 0;
     data->player_id = player;
     hashmap_create(&data->tick_lookup);
-    vector_create(&data->game_states, sizeof(game_state));
+    snapshot_ring_create(&data->snapshots, REC_SNAPSHOT_COUNT);
     uint32_t last_tick = 0;
     int j = 0;
     data->max_tick = 0;
@@ -1,6 +1,7 @@
 #include "engine.h"
 #include "audio/audio.h"
 #include "console/console.h"
+#include "controller/ai_lookahead.h"
 #include "controller/controller.h"
 #include "formats/altpal.h"
 #include "formats/rec.h"
@@ -10,21 +11,28 @@
 #include "game/utils/settings.h"
 #include "resources/languages.h"
 #include "resources/modmanager.h"
+#include "resources/preloader.h"
 #include "resources/resource_files.h"
 #include "resources/script_cache.h"
 #include "resources/sounds_loader.h"
+#include "resources/sprite_cache.h"
 #include "utils/allocator.h"
 #include "utils/log.h"
 #include "utils/miscmath.h"
 #include "utils/png_writer.h"
+#include "utils/profiler.h"
 #include "utils/time_fmt.h"
 #include "video/vga_state.h"
 #include "video/video.h"
+#include "video/video_export.h"
 #include <SDL.h>
+#include <inttypes.h>
 #include <stdio.h>
 
 #define MAX_TICKS_PER_FRAME 10
 #define TICK_EXPIRY_MS 100
+#define BATCH_EVENT_POLL_TICKS 100
+#define BATCH_AUDIO_BLOCK_FRAMES 1024
 
 static int run = 0;
 static int start_timeout = 30;
@@ -89,6 +97,12 @@ int engine_init(const engine_init_flags *init_flags) {
     }
     vga_state_init();
     script_cache_init();
+    sprite_cache_init();
+    if(!init_flags->no_workers) {
+        preloader_init();
+        ai_lookahead_init();
+    }
+    profiler_init();
 
     // Return successfully
     run = 1;
@@ -148,6 +162,121 @@ void save_rec(game_state *gs) {
     omf_free(time);
 }
 
+bool engine_sim_step(game_state **gs, engine_sim_clock *clock) {
+    // Jump straight to the moment the next tick is due, there is no need to wait for it.
+    int dyntick_ms = game_state_ms_per_dyntick(*gs);
+    int advance = min2(STATIC_TICKS + 1 - clock->static_wait, dyntick_ms + 1 - clock->dynamic_wait);
+    if(advance > 0) {
+        clock->static_wait += advance;
+        clock->dynamic_wait += advance;
+        clock->elapsed_ms += advance;
+    }
+
+    // Same tick order as in the engine_run loop.
+    bool has_static = clock->static_wait > STATIC_TICKS;
+    if(has_static) {
+        game_state_static_tick(*gs, false);
+        if((*gs)->new_state) {
+            game_state *old_gs = *gs;
+            *gs = old_gs->new_state;
+            game_state_clone_recycle(old_gs);
+        }
+        clock->static_wait -= STATIC_TICKS;
+    }
+
+    bool has_dynamic = clock->dynamic_wait > dyntick_ms;
+    if(has_dynamic) {
+        game_state_dynamic_tick(*gs, false);
+        clock->dynamic_wait -= dyntick_ms;
+        if((*gs)->delay > 0) {
+            (*gs)->delay--;
+            clock->dynamic_wait -= 4;
+        }
+    }
+
+    if(has_dynamic || has_static) {
+        game_state_palette_transform(*gs);
+        vga_state_render();
+    }
+    return has_dynamic;
+}
+
+static void render_frame(game_state *gs) {
+    video_render_prepare(game_state_get_framebuffer_options(gs));
+    game_state_render(gs);
+    osd_render();
+    video_render_finish();
+}
+
+/**
+ * Offline audio backends only mix when asked to. Keep the mixed audio in step with the simulated time, and hand it to
+ * the export if one is running. The sample count is derived from the total elapsed time, so no rounding error can
+ * accumulate between steps.
+ */
+static void render_audio(const engine_sim_clock *clock, uint64_t *rendered) {
+    static int16_t buffer[BATCH_AUDIO_BLOCK_FRAMES * 2];
+    unsigned sample_rate;
+    audio_get_music_info(&sample_rate, NULL, NULL);
+    const uint64_t due = clock->elapsed_ms * sample_rate / 1000;
+    while(*rendered < due) {
+        const uint64_t remaining = due - *rendered;
+        const int frames = remaining < BATCH_AUDIO_BLOCK_FRAMES ? (int)remaining : BATCH_AUDIO_BLOCK_FRAMES;
+        audio_render(buffer, frames);
+        video_export_push_audio(buffer, frames);
+        *rendered += frames;
+    }
+}
+
+static void engine_run_batch(game_state **gs, int render_every) {
+    SDL_Event e;
+    engine_sim_clock clock = {0};
+    uint64_t ticks = 0;
+    uint64_t frames = 0;
+    uint64_t audio_frames = 0;
+    uint64_t start = SDL_GetPerformanceCounter();
+    const int export_fps = video_export_get_fps();
+    const bool mix_audio = audio_can_render();
+
+    log_info("Running in batch mode, rendering every %d ticks", render_every);
+    while(run && game_state_is_running(*gs)) {
+        bool has_dynamic = engine_sim_step(gs, &clock);
+        if(mix_audio) {
+            render_audio(&clock, &audio_frames);
+        }
+        if(!has_dynamic) {
+            continue;
+        }
+        ticks++;
+
+        bool render = render_every > 0 && ticks % render_every == 0;
+        if(render || ticks % BATCH_EVENT_POLL_TICKS == 0) {
+            while(SDL_PollEvent(&e)) {
+                if(e.type == SDL_QUIT) {
+                    run = 0;
+                }
+            }
+        }
+        if(export_fps > 0) {
+            // Exported video runs at a fixed frame rate in simulated time. Emit every frame that became due
+            // during this tick, so that the video stays in sync even if a tick is longer than a frame.
+            while(frames * 1000 / export_fps <= clock.elapsed_ms) {
+                video_export_capture_frame();
+                render_frame(*gs);
+                frames++;
+            }
+        } else if(render) {
+            render_frame(*gs);
+        }
+    }
+
+    double seconds = (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+    double tps = seconds > 0 ? ticks / seconds : 0;
+    log_info("Batch mode simulated %" PRIu64 " ticks in %.2f seconds (%.0f ticks/sec)", ticks, seconds, tps);
+    if(!video_export_is_stdout()) {
+        printf("Simulated %" PRIu64 " ticks in %.2f seconds (%.0f ticks/sec)\n", ticks, seconds, tps);
+    }
+}
+
 void engine_run(const engine_init_flags *init_flags) {
     SDL_Event e;
     int visual_debugger = 0;
@@ -162,7 +291,7 @@ void engine_run(const engine_init_flags *init_flags) {
     // Game start timeout.
     // Wait a moment so that people are mentally prepared
     // (with the recording software on) for the game to start :)
-    if(!settings_get()->video.crossfade_on) {
+    if(!settings_get()->video.crossfade_on || init_flags->batch) {
         start_timeout = 0;
     }
     while(start_timeout > 0) {
@@ -189,6 +318,25 @@ void engine_run(const engine_init_flags *init_flags) {
 
     joystick_init();
 
+    // Batch mode runs the whole game without timing, and the regular loop below is skipped once it is done.
+    if(init_flags->batch) {
+        if(path_is_set(&init_flags->export_file)) {
+            // Audio can only be captured if the backend mixes on demand.
+            unsigned sample_rate = 0;
+            unsigned channels = 0;
+            if(audio_can_render()) {
+                audio_get_music_info(&sample_rate, &channels, NULL);
+            } else {
+                log_warn("Audio backend does not support offline mixing, exporting video only");
+            }
+            if(!video_export_open(&init_flags->export_file, init_flags->export_fps, sample_rate, channels)) {
+                run = 0;
+            }
+        }
+        engine_run_batch(&gs, init_flags->render_every);
+        video_export_close();
+    }
+
     // Game loop
     uint64_t frame_start = SDL_GetTicks64(); // Set game tick timer
     int dynamic_wait = 0;
@@ -239,8 +387,7 @@ void engine_run(const engine_init_flags *init_flags) {
                                 game_state *old_gs = gs;
                                 game_state *new_gs = gs->new_state;
                                 gs = new_gs;
-                                game_state_clone_free(old_gs);
-                                omf_free(old_gs);
+                                game_state_clone_recycle(old_gs);
 
                                 // apply palette transforms
                                 game_state_palette_transform(gs);
@@ -354,7 +501,9 @@ void engine_run(const engine_init_flags *init_flags) {
             // that are not dependent on game speed (such as menus).
             has_static = static_wait > STATIC_TICKS;
             if(has_static) {
+                profiler_begin(PROFILER_STATIC_TICK);
                 game_state_static_tick(gs, false);
+                profiler_end(PROFILER_STATIC_TICK);
                 // check if we need to replace the game state
                 if(gs->new_state) {
                     // one of the controllers wants to replace the game state
@@ -362,8 +511,7 @@ void engine_run(const engine_init_flags *init_flags) {
                     game_state *new_gs = gs->new_state;
                     gs = new_gs;
                     // gs->new_state = NULL;
-                    game_state_clone_free(old_gs);
-                    omf_free(old_gs);
+                    game_state_clone_recycle(old_gs);
                 }
                 console_tick(gs);
                 osd_tick();
@@ -375,7 +523,9 @@ void engine_run(const engine_init_flags *init_flags) {
             // with the actual gameplay stuff.
             has_dynamic = dynamic_wait > dyntick_ms;
             if(has_dynamic) {
+                profiler_begin(PROFILER_DYNAMIC_TICK);
                 game_state_dynamic_tick(gs, false);
+                profiler_end(PROFILER_DYNAMIC_TICK);
                 dynamic_wait -= dyntick_ms;
                 if(gs->delay > 0) {
                     log_debug("applying delay %d", gs->delay);
@@ -387,13 +537,16 @@ void engine_run(const engine_init_flags *init_flags) {
 
             // Ensure any pending palette changes are handled after any ticks are made.
             if(has_dynamic || has_static) {
+                profiler_begin(PROFILER_PALETTE);
                 game_state_palette_transform(gs);
                 vga_state_render();
+                profiler_end(PROFILER_PALETTE);
             }
         } while(tick_limit-- && (has_dynamic || has_static));
 
         // Do the actual video rendering jobs
         if(enable_screen_updates) {
+            profiler_begin(PROFILER_RENDER);
             video_render_prepare(game_state_get_framebuffer_options(gs));
             game_state_render(gs);
             if(debugger_render) {
@@ -401,11 +554,15 @@ void engine_run(const engine_init_flags *init_flags) {
             }
             osd_render();
             console_render();
+            profiler_end(PROFILER_RENDER);
+            profiler_begin(PROFILER_PRESENT);
             video_render_finish();
+            profiler_end(PROFILER_PRESENT);
         } else {
             // If screen updates are disabled, then wait
             SDL_Delay(1);
         }
+        profiler_frame_end();
     }
 
     joystick_close();
@@ -417,6 +574,10 @@ void engine_run(const engine_init_flags *init_flags) {
 }
 
 void engine_close(void) {
+    profiler_close();
+    ai_lookahead_close();
+    preloader_close();
+    sprite_cache_close();
     script_cache_close();
     osd_close();
     console_close();
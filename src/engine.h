@@ -2,6 +2,10 @@
 #define ENGINE_H
 
 #include "utils/path.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+struct game_state_t;
 
 // static tick duration, in ms
 #define STATIC_TICKS 10
@@ -15,10 +19,26 @@ typedef struct engine_init_flags {
     path rec_file;
     int warpspeed;
     int speed;
+    int batch;        // run the simulation uncapped, without wall-clock timing
+    int render_every; // in batch mode, render every nth dynamic tick (0 = never)
+    path export_file; // in batch mode, export rendered frames to this file
+    int export_fps;
+    int no_workers; // do not start the preloader and AI lookahead threads, eg. when the process is forked later
 } engine_init_flags;
 
+// Simulated clock for running game ticks without wall-clock timing
+typedef struct engine_sim_clock {
+    int static_wait;
+    int dynamic_wait;
+    uint64_t elapsed_ms; // total simulated time
+} engine_sim_clock;
+
 int engine_init(const engine_init_flags *init_flags); // Init window, audiodevice, etc.
 void engine_run(const engine_init_flags *init_flags); // Run game
 void engine_close(void);                              // Kill window, audiodev
 
+// Advance the simulated clock to the next due tick(s) and run them. Returns true if a dynamic tick was run.
+// The game state may be replaced by the tick, so it is passed by reference.
+bool engine_sim_step(struct game_state_t **gs, engine_sim_clock *clock);
+
 #endif // ENGINE_H
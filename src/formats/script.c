@@ -3,6 +3,7 @@
 #include "formats/tag_list.h"
 #include "formats/tag_list_helpers.h"
 #include "utils/allocator.h"
+#include "utils/miscmath.h"
 #include "utils/sstream.h"
 #include "utils/str.h"
 #include <assert.h>
@@ -24,9 +25,121 @@ void script_frame_create(script_frame *frame, const int tick_len, const int spri
     vector_create(&frame->tags, sizeof(script_frame_tag));
     frame->tick_len = tick_len;
     frame->sprite = sprite;
+    memset(frame->tag_bits, 0, sizeof(frame->tag_bits));
+    memset(frame->tag_rank, 0, sizeof(frame->tag_rank));
+    frame->tag_table = NULL;
+}
+
+// Must be called whenever the tags of a frame change.
+static void script_frame_drop_index(script_frame *frame) {
+    omf_free(frame->tag_table);
+}
+
+static inline unsigned popcount64(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_popcountll(v);
+#else
+    v = v - ((v >> 1) & 0x5555555555555555ULL);
+    v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+    v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (unsigned)((v * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Position of a present tag in the tag table: the number of present tags with a smaller id.
+static inline unsigned tag_table_index(const script_frame *frame, const uint8_t key) {
+    const unsigned word = key >> 6;
+    const uint64_t below = (1ULL << (key & 63)) - 1;
+    return frame->tag_rank[word] + popcount64(frame->tag_bits[word] & below);
+}
+
+static void script_frame_compile(script_frame *frame) {
+    script_frame_drop_index(frame);
+    memset(frame->tag_bits, 0, sizeof(frame->tag_bits));
+
+    iterator it;
+    script_frame_tag *tag;
+    vector_iter_begin(&frame->tags, &it);
+    foreach(it, tag) {
+        frame->tag_bits[tag->key >> 6] |= 1ULL << (tag->key & 63);
+    }
+    unsigned count = 0;
+    for(int i = 0; i < SCRIPT_TAG_WORDS; i++) {
+        frame->tag_rank[i] = count;
+        count += popcount64(frame->tag_bits[i]);
+    }
+
+    // Walk in order, so that later instances of a tag overwrite earlier ones, like the scan in
+    // script_get_tag_by_id does. Empty frames get a table as well, to mark them as compiled.
+    frame->tag_table = omf_calloc(count > 0 ? count : 1, sizeof(script_frame_tag));
+    vector_iter_begin(&frame->tags, &it);
+    foreach(it, tag) {
+        frame->tag_table[tag_table_index(frame, tag->key)] = *tag;
+    }
+}
+
+// Must be called whenever frames are added or their lengths change.
+static void script_drop_index(script *script) {
+    omf_free(script->tick_start);
+}
+
+void script_compile(script *script) {
+    script_drop_index(script);
+    const unsigned count = vector_size(&script->frames);
+    unsigned *tick_start = omf_calloc(count + 1, sizeof(unsigned));
+    unsigned pos = 0;
+    for(unsigned i = 0; i < count; i++) {
+        script_frame *frame = vector_get(&script->frames, i);
+        script_frame_compile(frame);
+        if(tick_start == NULL) {
+            continue;
+        }
+        if(frame->tick_len < 0) {
+            // Binary search needs the start ticks to be in order; leave such scripts to the linear scan.
+            omf_free(tick_start);
+            continue;
+        }
+        tick_start[i] = pos;
+        pos += frame->tick_len;
+    }
+    if(tick_start != NULL) {
+        tick_start[count] = pos;
+        script->tick_start = tick_start;
+    }
+}
+
+/**
+ * Index of the first frame that starts after the given tick, using the start ticks of a compiled script.
+ * Returns the frame count if there is none.
+ */
+static unsigned first_frame_after(const script *script, unsigned ticks) {
+    unsigned lo = 0;
+    unsigned hi = vector_size(&script->frames);
+    while(lo < hi) {
+        const unsigned mid = lo + (hi - lo) / 2;
+        if(script->tick_start[mid] > ticks) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+/**
+ * Index of the frame that contains the given tick in a compiled script, or -1 if the tick is past the end.
+ * Zero length frames never contain a tick, the same way as with the linear scan.
+ */
+static int compiled_frame_index_at(const script *script, unsigned ticks) {
+    const unsigned count = vector_size(&script->frames);
+    if(ticks >= script->tick_start[count]) {
+        return -1;
+    }
+    return (int)first_frame_after(script, ticks) - 1;
 }
 
 int script_frame_clone(const script_frame *src, script_frame *dst) {
+    script_frame_drop_index(dst);
     iterator it;
     script_frame_tag *tag;
     vector_iter_begin(&src->tags, &it);
@@ -54,6 +167,7 @@ void script_frame_free(script_frame *frame) {
     if(frame == NULL) {
         return;
     }
+    script_frame_drop_index(frame);
     vector_free(&frame->tags);
 }
 
@@ -73,6 +187,7 @@ bool script_frame_add_tag(script_frame *frame, const char *key, int value) {
     if(tag.has_param) {
         tag.value = (int16_t)value;
     }
+    script_frame_drop_index(frame);
     vector_append(&frame->tags, &tag);
     return true;
 }
@@ -88,6 +203,7 @@ void script_free(script *script) {
         script_frame_free(frame);
     }
     vector_free(&script->frames);
+    script_drop_index(script);
 }
 
 int script_append_frame(script *script, int tick_len, int sprite_id) {
@@ -95,6 +211,7 @@ int script_append_frame(script *script, int tick_len, int sprite_id) {
 
     script_frame frame;
     script_frame_create(&frame, tick_len, sprite_id);
+    script_drop_index(script);
     vector_append(&script->frames, &frame);
     return SD_SUCCESS;
 }
@@ -110,6 +227,7 @@ int script_clear_tags(script *script, int frame_id) {
         return SD_INVALID_INPUT;
     }
 
+    script_frame_drop_index(frame);
     vector_clear(&frame->tags);
     return SD_SUCCESS;
 }
@@ -125,6 +243,7 @@ int script_set_tick_len_at_frame(script *script, int frame_id, int duration) {
         return SD_INVALID_INPUT;
     }
 
+    script_drop_index(script);
     frame->tick_len = duration;
     return SD_SUCCESS;
 }
@@ -152,6 +271,12 @@ int script_get_tick_pos_at_frame(const script *script, int frame_id) {
     if(script == NULL) {
         return 0;
     }
+    if(script->tick_start != NULL) {
+        if(frame_id <= 0) {
+            return 0;
+        }
+        return script->tick_start[umin2(frame_id, vector_size(&script->frames))];
+    }
     int len = 0;
     script_frame *frame;
     for(int i = 0; i < frame_id; i++) {
@@ -297,6 +422,7 @@ static bool decode_next_frame(script_frame *frame, sstream *s) {
 }
 
 static int decode(script *script, sstream *s, int *invalid_pos) {
+    script_drop_index(script);
     int prev = sstream_pos(s);
     while(!sstream_eof(s)) {
         script_frame frame;
@@ -384,6 +510,10 @@ const script_frame *script_get_frame_at(const script *script, int ticks) {
     if(script == NULL || ticks < 0) {
         return NULL;
     }
+    if(script->tick_start != NULL) {
+        const int index = compiled_frame_index_at(script, ticks);
+        return index < 0 ? NULL : vector_get(&script->frames, index);
+    }
 
     iterator it;
     script_frame *frame;
@@ -439,6 +569,9 @@ int script_get_frame_index_at(const script *script, unsigned ticks) {
     if(script == NULL) {
         return -1;
     }
+    if(script->tick_start != NULL) {
+        return compiled_frame_index_at(script, ticks);
+    }
 
     unsigned pos = 0;
     for(unsigned i = 0; i < vector_size(&script->frames); i++) {
@@ -480,6 +613,13 @@ const script_frame_tag *script_get_tag_by_id(const script_frame *frame, script_t
     if(frame == NULL) {
         return NULL;
     }
+    if(frame->tag_table != NULL) {
+        const uint8_t key = (uint8_t)id;
+        if(!(frame->tag_bits[key >> 6] & (1ULL << (key & 63)))) {
+            return NULL;
+        }
+        return &frame->tag_table[tag_table_index(frame, key)];
+    }
     iterator it;
     script_frame_tag *now;
     vector_iter_end(&frame->tags, &it);
@@ -503,6 +643,10 @@ const script_frame_tag *script_get_tag_by_name(const script_frame *frame, const
 }
 
 int script_is_tag_set_by_id(const script_frame *frame, script_tag id) {
+    if(frame != NULL && frame->tag_table != NULL) {
+        const uint8_t key = (uint8_t)id;
+        return (frame->tag_bits[key >> 6] >> (key & 63)) & 1;
+    }
     return script_get_tag_by_id(frame, id) != NULL;
 }
 
@@ -536,6 +680,15 @@ int script_get_next_frame_with_sprite(const script *script, int sprite_id, unsig
     if(current_tick > script_get_total_ticks(script)) {
         return -1;
     }
+    if(script->tick_start != NULL) {
+        for(unsigned i = first_frame_after(script, current_tick); i < vector_size(&script->frames); i++) {
+            const script_frame *frame = vector_get(&script->frames, i);
+            if(sprite_id == frame->sprite) {
+                return (int)i;
+            }
+        }
+        return -1;
+    }
 
     unsigned pos = 0;
     for(unsigned i = 0; i < vector_size(&script->frames); i++) {
@@ -557,6 +710,14 @@ int script_get_next_frame_with_tag_id(const script *script, script_tag id, uint3
     if(current_tick > script_get_total_ticks(script)) {
         return -1;
     }
+    if(script->tick_start != NULL) {
+        for(unsigned i = first_frame_after(script, current_tick); i < vector_size(&script->frames); i++) {
+            if(script_is_tag_set_by_id(vector_get(&script->frames, i), id)) {
+                return (int)i;
+            }
+        }
+        return -1;
+    }
 
     unsigned pos = 0;
     for(unsigned i = 0; i < vector_size(&script->frames); i++) {
@@ -604,6 +765,7 @@ int script_delete_tag(script *script, int frame_id, const char *tag) {
     vector_iter_begin(&frame->tags, &it);
     foreach(it, now) {
         if(now->key == (uint8_t)wanted) {
+            script_frame_drop_index(frame);
             vector_delete(&frame->tags, &it);
             return SD_SUCCESS;
         }
@@ -639,6 +801,7 @@ int script_set_tag(script *script, int frame_id, const char *tag, int value) {
 
     // Delete old tag (if exists), then add new.
     script_delete_tag(script, frame_id, tag);
+    script_frame_drop_index(frame);
     vector_append(&frame->tags, &new);
     return SD_SUCCESS;
 }
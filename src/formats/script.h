@@ -27,23 +27,36 @@ typedef struct script_frame_tag {
     int16_t value;     ///< Tag parameter value if has_param is set.
 } script_frame_tag;
 
+#define SCRIPT_TAG_WORDS 4 ///< Words in the tag bitset; one bit for each of the 256 possible tag ids
+
 /** @brief Animation frame
  *
  * Describes a single frame in animation string.
+ *
+ * A frame may also have a compiled tag index (see script_compile), which turns tag lookups into bit tests.
+ * The index is only valid while tag_table is set; any change to the tags drops it.
  */
 typedef struct script_frame {
     int sprite;   ///< Sprite ID that the frame relates to
     int tick_len; ///< Length of the frame in ticks
     vector tags;  ///< A list of tags in this frame
+
+    uint64_t tag_bits[SCRIPT_TAG_WORDS]; ///< Bit for each tag id present in the frame
+    uint8_t tag_rank[SCRIPT_TAG_WORDS];  ///< Number of set bits in the preceding words of tag_bits
+    script_frame_tag *tag_table;         ///< Last instance of each present tag in tag id order, or NULL
 } script_frame;
 
 /** @brief Animation script
  *
  * A single animation string. Contains multiple frames, which then contain tags.
  * A valid string must contain at least a single frame.
+ *
+ * A compiled script (see script_compile) also has the start tick of every frame, so that frames can be found
+ * by tick with a binary search. Adding frames or changing their lengths drops the start ticks.
  */
 typedef struct script {
-    vector frames; ///< List of frames in this string
+    vector frames;        ///< List of frames in this string
+    unsigned *tick_start; ///< Start tick of each frame, plus the total length as the last entry, or NULL
 } script;
 
 /** @brief Initialize script parser
@@ -215,6 +228,16 @@ int script_get_frame_count(const script *script);
  */
 const script_frame_tag *script_get_tag_by_name(const script_frame *frame, const char *tag);
 
+/** @brief Build the frame and tag lookup tables of the script
+ *
+ * After this, finding frames by tick is a binary search, and tag lookups by id are bit tests instead of
+ * scans over the tag list. Changing the frames or tags drops the affected tables, and lookups fall back to
+ * scanning until the script is compiled again.
+ *
+ * @param script Script to compile
+ */
+void script_compile(script *script);
+
 /** @brief Returns the information of a tag in a frame, by tag id.
  *
  * @param frame Frame structure to read
@@ -64,26 +64,21 @@ static void resolve(script_reader *r) {
         }
     }
 
-    // Slow path -- full scan from the beginning.
-    uint32_t pos = 0;
-    for(int i = 0; i < script_get_frame_count(r->script); i++) {
-        const script_frame *frame = script_get_frame(r->script, i);
-        const uint32_t next = pos + (uint32_t)frame->tick_len;
-        if(r->tick >= pos && r->tick < next) {
-            r->frame = frame;
-            r->frame_index = i;
-            r->frame_start = pos;
-            r->frame_end = next;
-            r->frame_valid = true;
-            return;
-        }
-        pos = next;
+    // Slow path -- look the frame up. This is a binary search for compiled scripts, and a scan otherwise.
+    const int index = script_get_frame_index_at(r->script, r->tick);
+    if(index >= 0) {
+        r->frame = script_get_frame(r->script, index);
+        r->frame_index = index;
+        r->frame_start = (uint32_t)script_get_tick_pos_at_frame(r->script, index);
+        r->frame_end = r->frame_start + (uint32_t)r->frame->tick_len;
+        r->frame_valid = true;
+        return;
     }
 
     // The position is over the end of the animation. We cache that as [pos ... UINT32_MAX].
     r->frame = NULL;
     r->frame_index = -1;
-    r->frame_start = pos;
+    r->frame_start = script_get_total_ticks(r->script);
     r->frame_end = UINT32_MAX;
     r->frame_valid = true;
 }
@@ -100,7 +95,7 @@ const script_frame *script_reader_frame(const script_reader *r) {
 }
 
 bool script_reader_isset(const script_reader *r, script_tag tag) {
-    return script_get_tag_by_id(script_reader_frame(r), tag) != NULL;
+    return script_is_tag_set_by_id(script_reader_frame(r), tag);
 }
 
 int script_reader_get(const script_reader *r, script_tag tag) {
@@ -18,6 +18,10 @@ void sound_tracker_free(sound_tracker *t) {
     vector_free(&t->entries);
 }
 
+void sound_tracker_clear(sound_tracker *t) {
+    vector_clear(&t->entries);
+}
+
 void sound_tracker_clone(sound_tracker *dst, const sound_tracker *src) {
     iterator it;
     vector_iter_begin((vector *)&src->entries, &it);
@@ -42,6 +42,12 @@ void sound_tracker_create(sound_tracker *t);
  */
 void sound_tracker_free(sound_tracker *t);
 
+/**
+ * @brief Drop all entries from the tracker, keeping the entry vector allocated.
+ * @param t Tracker to clear.
+ */
+void sound_tracker_clear(sound_tracker *t);
+
 /**
  * @brief Clone the tracker instance
  * @param dst Empty destination tracker.
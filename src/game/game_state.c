@@ -26,6 +26,7 @@
 #include "resources/languages.h"
 #include "resources/modmanager.h"
 #include "resources/pilots.h"
+#include "resources/preloader.h"
 #include "utils/allocator.h"
 #include "utils/c_array_util.h"
 #include "utils/c_string_util.h"
@@ -56,13 +57,6 @@ static void _setup_rec_controller(game_state *gs, int player_id, sd_rec_file *re
 // Used for crossfades
 #define FRAME_WAIT_TICKS 30
 
-typedef struct {
-    int layer;      ///< Object rendering layer
-    int persistent; ///< 1 if the object should keep alive across scene boundaries
-    int singleton;  ///< 1 if object should be the only representative of its animation ID
-    object *obj;
-} render_obj;
-
 // 14 bytes of match settings
 void game_state_encode_match_settings(serial *ser, match_settings *ms) {
     serial_write_int16(ser, ms->throw_range);
@@ -274,9 +268,11 @@ int game_state_create(game_state *gs, const engine_init_flags *init_flags) {
     gs->init_flags = init_flags;
     gs->new_state = NULL;
     gs->clone = false;
+    gs->lookahead = false;
     gs->hit_pause = 0;
     game_state_match_settings_reset(gs);
     vector_create(&gs->objects, sizeof(render_obj));
+    object_index_create(&gs->object_index);
     sound_tracker_create(&gs->tracker);
 
     // For screen shake
@@ -399,6 +395,7 @@ error_1:
 error_0:
     omf_free(gs->sc);
     vector_free(&gs->objects);
+    object_index_free(&gs->object_index);
     sound_tracker_free(&gs->tracker);
     return 1;
 }
@@ -429,6 +426,7 @@ int game_state_add_object(game_state *gs, object *obj, int layer, int singleton,
         }
     }
     vector_append(&gs->objects, &o);
+    object_index_add(&gs->object_index, obj);
 
 #ifdef DEBUGMODE_STFU
     animation *ani = object_get_animation(obj);
@@ -468,6 +466,7 @@ void game_state_del_animation(game_state *gs, int anim_id) {
     foreach(it, robj) {
         animation *ani = object_get_animation(robj->obj);
         if(ani != NULL && ani->id == anim_id) {
+            object_index_remove(&gs->object_index, robj->obj->id);
             object_free(robj->obj);
             omf_free(robj->obj);
             vector_delete(&gs->objects, &it);
@@ -484,6 +483,7 @@ void game_state_del_object(game_state *gs, object *target) {
     vector_iter_begin(&gs->objects, &it);
     foreach(it, robj) {
         if(target == robj->obj) {
+            object_index_remove(&gs->object_index, robj->obj->id);
             object_free(robj->obj);
             omf_free(robj->obj);
             vector_delete(&gs->objects, &it);
@@ -498,6 +498,7 @@ void game_state_del_object_by_id(game_state *gs, uint32_t target) {
     vector_iter_begin(&gs->objects, &it);
     foreach(it, robj) {
         if(target == robj->obj->id) {
+            object_index_remove(&gs->object_index, robj->obj->id);
             object_free(robj->obj);
             omf_free(robj->obj);
             vector_delete(&gs->objects, &it);
@@ -523,6 +524,7 @@ void game_state_clear_objects(game_state *gs, int mask) {
     vector_iter_begin(&gs->objects, &it);
     foreach(it, robj) {
         if(object_get_group(robj->obj) & mask) {
+            object_index_remove(&gs->object_index, robj->obj->id);
             object_free(robj->obj);
             omf_free(robj->obj);
             vector_delete(&gs->objects, &it);
@@ -530,11 +532,30 @@ void game_state_clear_objects(game_state *gs, int mask) {
     }
 }
 
+// Start loading the files of the next scene in the background, while the current scene fades out.
+static void preload_scene(game_state *gs, unsigned int scene_id) {
+    path bk_filename;
+    if(scene_get_bk_filename(gs, scene_id, &bk_filename)) {
+        preloader_request_bk(&bk_filename);
+    }
+
+    // HARs are only loaded in the arena, but they are already known when heading to the VS screen.
+    if(scene_id == SCENE_VS || (scene_id >= SCENE_ARENA0 && scene_id <= SCENE_ARENA4)) {
+        for(int i = 0; i < game_state_num_players(gs); i++) {
+            game_player *player = game_state_get_player(gs, i);
+            if(player->pilot != NULL && player->pilot->har_id < NUMBER_OF_HAR_TYPES) {
+                preloader_request_af(har_to_resource(player->pilot->har_id));
+            }
+        }
+    }
+}
+
 void game_state_set_next(game_state *gs, unsigned int next_scene_id) {
     if(gs->next_wait_ticks <= 0) {
         gs->next_wait_ticks = FRAME_WAIT_TICKS;
         gs->next_next_id = SCENE_MENU;
         gs->next_id = next_scene_id;
+        preload_scene(gs, next_scene_id);
     }
 }
 
@@ -718,6 +739,7 @@ int game_load_new(game_state *gs, int scene_id) {
     vector_iter_begin(&gs->objects, &it);
     foreach(it, robj) {
         if(!robj->persistent) {
+            object_index_remove(&gs->object_index, robj->obj->id);
             object_free(robj->obj);
             omf_free(robj->obj);
             vector_delete(&gs->objects, &it);
@@ -844,6 +866,11 @@ void game_state_call_collide(game_state *gs) {
     unsigned int size = vector_size(&gs->objects);
     for(unsigned i = 0; i < size; i++) {
         a = ((render_obj *)vector_get(&gs->objects, i))->obj;
+        // Pairs only do something if the first object has a collision callback. In practice this means
+        // the HARs, so the scan over everything else (scrap, particles, etc.) can be skipped entirely.
+        if(a->collide == NULL) {
+            continue;
+        }
         for(unsigned k = i + 1; k < size; k++) {
             b = ((render_obj *)vector_get(&gs->objects, k))->obj;
             if(a->group != b->group || a->group == GROUP_UNKNOWN || b->group == GROUP_UNKNOWN ||
@@ -863,6 +890,7 @@ void game_state_cleanup(game_state *gs) {
     foreach(it, robj) {
         if(object_is_finished(robj->obj)) {
             /*log_debug("Animation object %d is finished, removing.", robj->obj->cur_animation->id);*/
+            object_index_remove(&gs->object_index, robj->obj->id);
             object_free(robj->obj);
             omf_free(robj->obj);
             vector_delete(&gs->objects, &it);
@@ -1237,7 +1265,7 @@ void game_state_menu_poll(game_state *gs, ctrl_event **ev) {
     joystick_menu_poll_all(gs->menu_ctrl, ev);
 }
 
-void game_state_clone_free(game_state *gs) {
+void game_state_clone_release(game_state *gs) {
     // Free objects
     render_obj *robj;
     iterator it;
@@ -1247,22 +1275,60 @@ void game_state_clone_free(game_state *gs) {
         omf_free(robj->obj);
         vector_delete(&gs->objects, &it);
     }
-    vector_free(&gs->objects);
-    sound_tracker_free(&gs->tracker);
+    object_index_clear(&gs->object_index);
+    sound_tracker_clear(&gs->tracker);
 
     // Free scene
     scene_clone_free(gs->sc);
     // omf_free(gs->sc);
 
-    // Free players
+    // Release player data, but keep the player structs around for reuse
     for(int i = 0; i < 2; i++) {
         // game_player_set_ctrl(gs->players[i], NULL);
         game_player_clone_free(gs->players[i]);
+    }
+}
+
+void game_state_clone_buffers_free(game_state *gs) {
+    vector_free(&gs->objects);
+    object_index_free(&gs->object_index);
+    sound_tracker_free(&gs->tracker);
+    for(int i = 0; i < 2; i++) {
         omf_free(gs->players[i]);
     }
+}
+
+void game_state_clone_free(game_state *gs) {
+    game_state_clone_release(gs);
+    game_state_clone_buffers_free(gs);
     // omf_free(gs);
 }
 
+// A game state that was replaced by a rewound one. It is kept released, so that the next rewind can reuse its
+// buffers. There is never more than one replacement pending, so one is enough.
+static game_state *spare_state = NULL;
+
+game_state *game_state_clone_alloc(game_state *src) {
+    game_state *dst = spare_state;
+    if(dst != NULL) {
+        spare_state = NULL;
+        game_state_clone_into(src, dst);
+    } else {
+        dst = omf_calloc(1, sizeof(game_state));
+        game_state_clone(src, dst);
+    }
+    return dst;
+}
+
+void game_state_clone_recycle(game_state *gs) {
+    game_state_clone_release(gs);
+    if(spare_state != NULL) {
+        game_state_clone_buffers_free(spare_state);
+        omf_free(spare_state);
+    }
+    spare_state = gs;
+}
+
 void game_state_free(game_state **_gs) {
     game_state *gs = *_gs;
     *_gs = NULL;
@@ -1277,6 +1343,7 @@ void game_state_free(game_state **_gs) {
         vector_delete(&gs->objects, &it);
     }
     vector_free(&gs->objects);
+    object_index_free(&gs->object_index);
     sound_tracker_free(&gs->tracker);
 
     // Free scene
@@ -1303,6 +1370,12 @@ void game_state_free(game_state **_gs) {
     }
     omf_free(gs->menu_ctrl);
     omf_free(gs);
+
+    if(spare_state != NULL) {
+        game_state_clone_buffers_free(spare_state);
+        omf_free(spare_state);
+        spare_state = NULL;
+    }
 }
 
 int game_state_ms_per_dyntick(game_state *gs) {
@@ -1331,15 +1404,7 @@ int render_obj_clone(render_obj *src, render_obj *dst, game_state *gs) {
 }
 
 object *game_state_find_object(game_state *gs, uint32_t object_id) {
-    iterator it;
-    vector_iter_begin(&gs->objects, &it);
-    render_obj *robj;
-    foreach(it, robj) {
-        if(robj->obj->id == object_id) {
-            return robj->obj;
-        }
-    }
-    return NULL;
+    return object_index_get(&gs->object_index, object_id);
 }
 
 int game_state_find_objects(game_state *gs, vector *out, bool (*predicate)(const object *obj, void *user_data),
@@ -1361,16 +1426,13 @@ void game_state_play_sound(game_state *gs, int sound_id, const sound_opts *opts)
     sound_tracker_play(&gs->tracker, gs->tick, gs->clone, sound_id, opts);
 }
 
-int game_state_clone(game_state *src, game_state *dst) {
-    // copy all the static fields
-    memcpy(dst, src, sizeof(game_state));
-    // fix any pointers to volatile data
-    vector_create(&dst->objects, sizeof(render_obj));
-    sound_tracker_create(&dst->tracker);
-
+// Clones the volatile data of src into dst. The static fields, the (empty) object vector, object index and
+// sound tracker, and the player structs of dst must already be set up.
+static void game_state_clone_contents(game_state *src, game_state *dst) {
     dst->next_wait_ticks = 0;
     dst->this_wait_ticks = 0;
 
+    vector_reserve(&dst->objects, vector_size(&src->objects));
     iterator it;
     vector_iter_begin(&src->objects, &it);
     render_obj *robj;
@@ -1378,12 +1440,12 @@ int game_state_clone(game_state *src, game_state *dst) {
         render_obj d;
         render_obj_clone(robj, &d, dst);
         vector_append(&dst->objects, &d);
+        object_index_add(&dst->object_index, d.obj);
     }
 
     sound_tracker_clone(&dst->tracker, &src->tracker);
 
     for(int i = 0; i < 2; i++) {
-        dst->players[i] = omf_calloc(1, sizeof(game_player));
         game_player_clone(src->players[i], dst->players[i]);
         // update HAR object pointers
         // dst->players[i]->har_obj_id = src->players[i]->har_obj_id;
@@ -1395,7 +1457,51 @@ int game_state_clone(game_state *src, game_state *dst) {
     dst->new_state = NULL;
 
     dst->clone = true;
+}
+
+static void game_state_clone_new(game_state *src, game_state *dst, bool lookahead) {
+    // copy all the static fields
+    memcpy(dst, src, sizeof(game_state));
+    // fix any pointers to volatile data
+    vector_create(&dst->objects, sizeof(render_obj));
+    object_index_create(&dst->object_index);
+    sound_tracker_create(&dst->tracker);
+    for(int i = 0; i < 2; i++) {
+        dst->players[i] = omf_calloc(1, sizeof(game_player));
+    }
+    // the scene clone callbacks check this, so it must be set before the contents are cloned
+    dst->lookahead = lookahead;
+
+    game_state_clone_contents(src, dst);
+}
+
+int game_state_clone(game_state *src, game_state *dst) {
+    game_state_clone_new(src, dst, false);
+    return 0;
+}
+
+int game_state_clone_lookahead(game_state *src, game_state *dst) {
+    game_state_clone_new(src, dst, true);
+    return 0;
+}
+
+int game_state_clone_into(game_state *src, game_state *dst) {
+    // keep the buffers left over by game_state_clone_release()
+    vector objects = dst->objects;
+    object_index obj_index = dst->object_index;
+    sound_tracker tracker = dst->tracker;
+    game_player *players[2] = {dst->players[0], dst->players[1]};
+
+    // copy all the static fields
+    memcpy(dst, src, sizeof(game_state));
+    dst->objects = objects;
+    dst->object_index = obj_index;
+    dst->tracker = tracker;
+    for(int i = 0; i < 2; i++) {
+        dst->players[i] = players[i];
+    }
 
+    game_state_clone_contents(src, dst);
     return 0;
 }
 
@@ -58,6 +58,19 @@ void game_state_play_sound(game_state *gs, int sound_id, const sound_opts *opts)
 int game_state_clone(game_state *src, game_state *dst);
 void game_state_clone_free(game_state *gs);
 
+// Like game_state_clone(), but reuses the object, sound and player buffers of a released clone
+int game_state_clone_into(game_state *src, game_state *dst);
+// Frees the contents of a cloned game state, keeping its buffers for game_state_clone_into()
+void game_state_clone_release(game_state *gs);
+// Frees the buffers of a released clone
+void game_state_clone_buffers_free(game_state *gs);
+// Clones src into a heap allocated game state, reusing the buffers of the last recycled one if there is one
+game_state *game_state_clone_alloc(game_state *src);
+// Frees a heap allocated clone that has been replaced, keeping its buffers for game_state_clone_alloc()
+void game_state_clone_recycle(game_state *gs);
+// Like game_state_clone(), but for a clone that is simulated on another thread. Free with game_state_clone_free().
+int game_state_clone_lookahead(game_state *src, game_state *dst);
+
 void _setup_keyboard(game_state *gs, int player_id, int control_id);
 void _setup_ai(game_state *gs, int player_id);
 int _setup_joystick(game_state *gs, int player_id, const char *joyname, int offset);
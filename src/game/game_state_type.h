@@ -7,6 +7,7 @@
 #include "formats/rec.h"
 #include "game/audio/sound_tracker.h"
 #include "game/protos/fight_stats.h"
+#include "game/utils/object_index.h"
 #include "game/utils/settings.h"
 #include "utils/random.h"
 #include "utils/vector.h"
@@ -55,6 +56,14 @@ typedef struct {
     bool sim;
 } match_settings;
 
+// An entry of game_state.objects
+typedef struct {
+    int layer;      ///< Object rendering layer
+    int persistent; ///< 1 if the object should keep alive across scene boundaries
+    int singleton;  ///< 1 if object should be the only representative of its animation ID
+    object *obj;
+} render_obj;
+
 typedef struct game_state_t {
     unsigned int run;
     unsigned int paused;
@@ -94,12 +103,14 @@ typedef struct game_state_t {
     int net_mode; // NET_MODE_NONE, NET_MODE_CLIENT, NET_MODE_SERVER
     scene *sc;
     vector objects;
+    object_index object_index; // object id -> object, for all objects in the objects vector
     sound_tracker tracker;
     game_player *players[2];
 
     fight_stats fight_stats;
     void *new_state;
     bool clone;
+    bool lookahead; // Throwaway clone simulated by the AI lookahead workers; must not touch anything it shares
     int delay;
     struct random_t rand;
 
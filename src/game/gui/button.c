@@ -125,6 +125,7 @@ component *button_create(const char *text, const char *help, bool disabled, bool
 
     button *b = omf_calloc(1, sizeof(button));
     b->text = text_create();
+    text_set_render_cache(b->text, true);
     text_set_from_c(b->text, text);
     b->use_border = border;
     b->click_cb = cb;
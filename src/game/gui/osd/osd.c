@@ -2,6 +2,7 @@
 
 #include "game/gui/text/text.h"
 #include "utils/list.h"
+#include "utils/profiler.h"
 #include "video/video.h"
 
 #include <assert.h>
@@ -21,6 +22,10 @@
 #define OSD_DEFAULT_COLOR 0xFD
 #define OSD_DEFAULT_SHADOW 0xC0
 
+#define OSD_PROFILER_TOP_MARGIN 4
+#define OSD_PROFILER_REFRESH 30 // Frames between profiler overlay updates
+#define OSD_PROFILER_BUF_MAX 512
+
 typedef struct osd_block {
     text *data;
     int created_at;
@@ -31,6 +36,11 @@ typedef struct osd {
     int tick;
     vga_index default_text_color;
     vga_index default_text_shadow_color;
+#ifdef DEBUGMODE
+    bool profiler_overlay;
+    text *profiler_text;
+    int profiler_refresh;
+#endif
 } osd;
 
 static osd osd_state;
@@ -52,6 +62,11 @@ bool osd_init(void) {
 
 void osd_close(void) {
     list_free(&osd_state.blocks);
+#ifdef DEBUGMODE
+    if(osd_state.profiler_text) {
+        text_free(&osd_state.profiler_text);
+    }
+#endif
 }
 
 void osd_clear(void) {
@@ -75,6 +90,7 @@ static text *create_text_from(const char *msg, const vga_index color, const vga_
     text_set_horizontal_align(t, TEXT_ALIGN_LEFT);
     text_set_vertical_align(t, TEXT_ALIGN_TOP);
     text_set_word_wrap(t, true);
+    text_set_render_cache(t, true);
     text_set_bounding_box(t, NATIVE_W - 2 * OSD_HORIZONTAL_MARGIN, TEXT_BBOX_MAX);
     text_generate_layout(t);
     return t;
@@ -124,7 +140,51 @@ void osd_tick(void) {
     }
 }
 
+#ifdef DEBUGMODE
+void osd_set_profiler_overlay(bool enabled) {
+    osd_state.profiler_overlay = enabled;
+    osd_state.profiler_refresh = 0;
+}
+
+bool osd_get_profiler_overlay(void) {
+    return osd_state.profiler_overlay;
+}
+
+static void render_profiler_overlay(void) {
+    // Regenerating the text layout is not free, so only do it every now and then.
+    if(osd_state.profiler_refresh-- <= 0) {
+        char buf[OSD_PROFILER_BUF_MAX];
+        int len = snprintf(buf, sizeof(buf), "zone: p50 / p95 / p99 / max ms\n");
+        for(int zone = 0; zone < PROFILER_ZONE_COUNT && len < (int)sizeof(buf); zone++) {
+            profiler_stats stats;
+            profiler_get_stats(zone, &stats);
+            len += snprintf(buf + len, sizeof(buf) - len, "%s: %.2f / %.2f / %.2f / %.2f\n", profiler_zone_name(zone),
+                            stats.p50 / 1000.0f, stats.p95 / 1000.0f, stats.p99 / 1000.0f, stats.max / 1000.0f);
+        }
+        for(int counter = 0; counter < PROFILER_COUNTER_COUNT && len < (int)sizeof(buf); counter++) {
+            profiler_stats stats;
+            profiler_get_counter_stats(counter, &stats);
+            len += snprintf(buf + len, sizeof(buf) - len, "%s: %u / %u / %u / %u\n", profiler_counter_name(counter),
+                            stats.p50, stats.p95, stats.p99, stats.max);
+        }
+        if(osd_state.profiler_text) {
+            text_free(&osd_state.profiler_text);
+        }
+        osd_state.profiler_text =
+            create_text_from(buf, osd_state.default_text_color, osd_state.default_text_shadow_color);
+        osd_state.profiler_refresh = OSD_PROFILER_REFRESH;
+    }
+    text_draw(osd_state.profiler_text, OSD_HORIZONTAL_MARGIN, OSD_PROFILER_TOP_MARGIN);
+}
+#endif // DEBUGMODE
+
 void osd_render(void) {
+#ifdef DEBUGMODE
+    if(osd_state.profiler_overlay) {
+        render_profiler_overlay();
+    }
+#endif
+
     iterator it;
     list_iter_end(&osd_state.blocks, &it);
     osd_block *block;
@@ -82,4 +82,17 @@ void osd_set_default_color(vga_index color);
  */
 void osd_set_default_shadow_color(vga_index shadow_color);
 
+#ifdef DEBUGMODE
+/**
+ * Show or hide the profiler overlay, which lists frame time percentiles per profiler zone in the top left corner.
+ * @param enabled True to show the overlay
+ */
+void osd_set_profiler_overlay(bool enabled);
+
+/**
+ * Check if the profiler overlay is shown.
+ */
+bool osd_get_profiler_overlay(void);
+#endif
+
 #endif // OSD_H
@@ -116,7 +116,11 @@ component *spritebutton_create(const char *text, const surface *img, bool disabl
     component_set_size_hints(c, img->w, img->h);
 
     spritebutton *b = omf_calloc(1, sizeof(spritebutton));
-    b->text = (text != NULL) ? text_create_from_c(text) : NULL;
+    b->text = NULL;
+    if(text != NULL) {
+        b->text = text_create_from_c(text);
+        text_set_render_cache(b->text, true);
+    }
     b->click_cb = cb;
     b->vertical_align = TEXT_ALIGN_MIDDLE;
     b->horizontal_align = TEXT_ALIGN_CENTER;
@@ -1,8 +1,10 @@
 #include <assert.h>
 #include <ctype.h>
+#include <limits.h>
 
 #include "game/gui/text/text.h"
 #include "game/gui/text/text_layout.h"
+#include "game/gui/text/text_markup.h"
 #include "utils/allocator.h"
 #include "utils/log.h"
 #include "utils/miscmath.h"
@@ -15,6 +17,7 @@ enum cache_flags
     INVALIDATE_NONE = 0,
     INVALIDATE_LAYOUT = 0x1,
     INVALIDATE_STYLE = 0x2,
+    INVALIDATE_RENDER = 0x4,
     INVALIDATE_ALL = 0xFF,
 };
 
@@ -40,13 +43,30 @@ struct text {
     uint8_t shadow;
     uint8_t glyph_margin;
     uint8_t word_wrap;
+
+    // Pre-rendered glyphs and shadows, see text_set_render_cache()
+    bool render_cache_enabled;
+    surface *render_cache; // NULL if there is nothing to draw, or if the text can't be cached
+    int16_t render_x;      // Position of the cached surface relative to the render coordinate
+    int16_t render_y;
 };
 
+static void free_render_cache(text *t) {
+    if(t->render_cache != NULL) {
+        // The cache is rebuilt whenever the text changes, don't leave the old pixels behind in the renderer.
+        video_signal_surface_freed(t->render_cache);
+        surface_free(t->render_cache);
+        omf_free(t->render_cache);
+    }
+}
+
 text *text_clone(const text *src) {
     text *dst = omf_malloc(sizeof(text));
     memcpy(dst, src, sizeof(text));
     str_from(&dst->buf, &src->buf);
     text_layout_clone(&dst->layout, &src->layout);
+    dst->render_cache = NULL;
+    dst->cache_flags |= INVALIDATE_RENDER;
     return dst;
 }
 
@@ -69,6 +89,10 @@ static void defaults(text *t) {
     t->shadow = GLYPH_SHADOW_NONE;
     t->glyph_margin = 0;
     t->word_wrap = true;
+    t->render_cache_enabled = false;
+    t->render_cache = NULL;
+    t->render_x = 0;
+    t->render_y = 0;
 }
 
 text *text_create(void) {
@@ -113,6 +137,7 @@ void text_free(text **t) {
     if(t != NULL && *t != NULL) {
         str_free(&(*t)->buf);
         text_layout_free(&(*t)->layout);
+        free_render_cache(*t);
         omf_free(*t);
     }
 }
@@ -121,6 +146,7 @@ void text_free_direct(void *p) {
     text *t = (text *)p;
     str_free(&t->buf);
     text_layout_free(&t->layout);
+    free_render_cache(t);
 }
 
 text_document *text_document_create(void) {
@@ -244,6 +270,16 @@ void text_set_word_wrap(text *t, bool word_wrap) {
     }
 }
 
+void text_set_render_cache(text *t, bool enable) {
+    if(t->render_cache_enabled != enable) {
+        t->render_cache_enabled = enable;
+        t->cache_flags |= INVALIDATE_RENDER;
+        if(!enable) {
+            free_render_cache(t);
+        }
+    }
+}
+
 void text_get_str(const text *t, str *dst) {
     str_from(dst, &t->buf);
 }
@@ -339,11 +375,18 @@ void text_generate_document(text_document *td, str *buf0, font_size font_sz, uin
                             vga_index text_color, vga_index shadow_color, text_vertical_align vertical_align,
                             text_horizontal_align horizontal_align, text_margin margin, uint8_t line_spacing,
                             uint8_t letter_spacing, uint8_t shadow, uint8_t glyph_margin) {
-    size_t start = 0;
-    size_t len = str_size(buf0);
-
-    const char *buf = str_c(buf0);
-
+    text_markup markup;
+    text_markup_create(&markup, buf0);
+    text_generate_markup_document(td, &markup, font_sz, w, h, text_color, shadow_color, vertical_align,
+                                  horizontal_align, margin, line_spacing, letter_spacing, shadow, glyph_margin);
+    text_markup_free(&markup);
+}
+
+void text_generate_markup_document(text_document *td, const text_markup *markup, font_size font_sz, uint16_t w,
+                                   uint16_t h, vga_index text_color, vga_index shadow_color,
+                                   text_vertical_align vertical_align, text_horizontal_align horizontal_align,
+                                   text_margin margin, uint8_t line_spacing, uint8_t letter_spacing, uint8_t shadow,
+                                   uint8_t glyph_margin) {
     uint16_t current_width = w;
     uint16_t current_height = h;
     text_vertical_align current_vertical_align = vertical_align;
@@ -352,86 +395,54 @@ void text_generate_document(text_document *td, str *buf0, font_size font_sz, uin
     uint8_t current_shadow = shadow;
     uint16_t current_x_off = 0;
     uint16_t current_y_off = 0;
-    uint16_t center = 160;
     const font *initial_font = fonts_get_font(font_sz);
     uint16_t current_line_spacing = line_spacing + initial_font->h;
     vga_index current_text_color = text_color;
     vga_index current_shadow_color = shadow_color;
-    int bytes_used;
     int count = 0;
 
-    while(start < len) {
-        while(start < len && buf[start] == '{') {
-            if(strncmp(buf + start, "{CENTER OFF}", 12) == 0) {
-                start += 12;
-                current_horizontal_align = TEXT_ALIGN_LEFT;
-            } else if(strncmp(buf + start, "{CENTER ON}", 11) == 0) {
-                start += 11;
-                current_horizontal_align = TEXT_ALIGN_CENTER;
-            } else if(strncmp(buf + start, "{SIZE 8}", 8) == 0) {
-                start += 8;
-                // swap based on initial font family
-                if(font_sz == FONT_NET1 || font_sz == FONT_NET2) {
-                    current_font_size = FONT_NET1;
-                } else {
-                    current_font_size = FONT_BIG;
-                }
-            } else if(strncmp(buf + start, "{SIZE 6}", 8) == 0) {
-                start += 8;
+    iterator it;
+    const text_markup_op *op;
+    vector_iter_begin(&markup->ops, &it);
+    foreach(it, op) {
+        switch(op->type) {
+            case MARKUP_OP_ALIGN:
+                current_horizontal_align = op->value;
+                continue;
+            case MARKUP_OP_SIZE:
                 // swap based on initial font family
                 if(font_sz == FONT_NET1 || font_sz == FONT_NET2) {
-                    current_font_size = FONT_NET2;
+                    current_font_size = op->value == 8 ? FONT_NET1 : FONT_NET2;
                 } else {
-                    current_font_size = FONT_SMALL;
+                    current_font_size = op->value == 8 ? FONT_BIG : FONT_SMALL;
                 }
-            } else if(strncmp(buf + start, "{SHADOWS ON}", 12) == 0) {
-                start += 12;
-                current_shadow = GLYPH_SHADOW_RIGHT | GLYPH_SHADOW_BOTTOM;
-            } else if(strncmp(buf + start, "{SHADOWS OFF}", 13) == 0) {
-                start += 13;
-                current_shadow = GLYPH_SHADOW_NONE;
-            } else if(strncmp(buf + start, "{COLOR:YELLOW}", 14) == 0) {
-                start += 14;
+                continue;
+            case MARKUP_OP_SHADOW:
+                current_shadow = op->value;
+                continue;
+            case MARKUP_OP_COLOR:
+                current_text_color = op->value;
+                continue;
+            case MARKUP_OP_COLOR_YELLOW:
                 current_text_color = TEXT_YELLOW;
                 current_shadow_color = TEXT_SHADOW_YELLOW;
-            } else if(strncmp(buf + start, "{COLOR:DEFAULT}", 15) == 0) {
-                start += 15;
+                continue;
+            case MARKUP_OP_COLOR_DEFAULT:
                 current_text_color = text_color;
                 current_shadow_color = shadow_color;
-            } else if(sscanf(buf + start, "{WIDTH %hu}%n", &current_width, &bytes_used) == 1 && bytes_used > 0) {
-                current_width = max2(8, min2(current_width, 320));
-                start += bytes_used;
-            } else if(sscanf(buf + start, "{VMOVE %hu}%n", &current_y_off, &bytes_used) == 1 && bytes_used > 0) {
-                current_y_off = min2(current_y_off, 200);
-                start += bytes_used;
-            } else if(sscanf(buf + start, "{CENTER %hu}%n", &center, &bytes_used) == 1 && bytes_used > 0) {
-                start += bytes_used;
-                // TODO we need to handle this properly, it will likely update the x offset
-            } else if(sscanf(buf + start, "{COLOR %i}%n", &current_text_color, &bytes_used) == 1 && bytes_used > 0) {
-                start += bytes_used;
-            } else if(sscanf(buf + start, "{SPACING %hu}%n", &current_line_spacing, &bytes_used) == 1 &&
-                      bytes_used > 0) {
-                start += bytes_used;
-            } else if(sscanf(buf + start, "{SPACING %hu}%n", &current_line_spacing, &bytes_used) == 1 &&
-                      bytes_used > 0) {
-                // handle known typo in page 2 of help menu. We assume the original parser is just looking at the string
-                // prefixes
-                start += bytes_used;
-            } else {
-                char *end = strchr(buf + start, '}');
-                if(end) {
-                    char tmp[20];
-                    memcpy(tmp, buf + start, sizeof(tmp));
-                    tmp[19] = 0;
-                    // log_warn("unhandled markup detected %s", tmp);
-                    start += end + 1 - (buf + start);
-                } else {
-                    // log_warn("unterminated markup detected");
-                    return;
-                }
-            }
+                continue;
+            case MARKUP_OP_WIDTH:
+                current_width = op->value;
+                continue;
+            case MARKUP_OP_VMOVE:
+                current_y_off = op->value;
+                continue;
+            case MARKUP_OP_SPACING:
+                current_line_spacing = op->value;
+                continue;
+            case MARKUP_OP_TEXT:
+                break;
         }
-        start = min2(start, len);
 
         text *t = vector_append_ptr(&td->text_objects);
         defaults(t);
@@ -453,22 +464,8 @@ void text_generate_document(text_document *td, str *buf0, font_size font_sz, uin
         t->shadow = current_shadow;
         t->glyph_margin = glyph_margin;
         // t->max_lines = max_lines;
-
-        char *endptr = strchr(buf + start, '{');
-        if(endptr) {
-            size_t end = endptr - buf;
-            str_from_slice(&t->buf, buf0, start, end);
-            start = end;
-        } else {
-            if(start == len) {
-                str_create(&t->buf); // Initialize with empty, free_cb() will delete it.
-                // empty trailing string
-                vector_delete_at(&td->text_objects, count);
-                continue;
-            }
-            str_from_slice(&t->buf, buf0, start, len);
-            start = len;
-        }
+        t->render_cache_enabled = true; // Documents are generated once and never restyled
+        str_from_slice(&t->buf, &markup->source, op->value, op->value + op->len);
 
         size_t line_len = str_size(&t->buf);
         bool found = false;
@@ -495,7 +492,7 @@ void text_generate_document(text_document *td, str *buf0, font_size font_sz, uin
         if(count) {
             // not the first one, so drop the top margin
             t->margin.top = 0;
-        } else if(start == len) {
+        } else if(text_markup_is_last_run(markup, op)) {
             // last one, so restore the bottom margin
             t->margin.bottom = margin.bottom;
         }
@@ -504,7 +501,7 @@ void text_generate_document(text_document *td, str *buf0, font_size font_sz, uin
         // one and the right margin should only be provided if the line is likely to wrap?
         text_layout_compute(&t->layout, &t->buf, font, t->w, t->h, t->vertical_align, t->horizontal_align, t->margin,
                             t->direction, t->line_spacing, t->letter_spacing, 255);
-        t->cache_flags &= ~INVALIDATE_LAYOUT;
+        t->cache_flags = INVALIDATE_RENDER;
         count++;
     }
 }
@@ -534,6 +531,7 @@ void text_generate_layout(text *t) {
         text_layout_compute(&t->layout, &t->buf, font, t->w, t->h, t->vertical_align, t->horizontal_align, t->margin,
                             t->direction, t->line_spacing, t->letter_spacing, t->word_wrap);
         t->cache_flags &= ~INVALIDATE_LAYOUT;
+        t->cache_flags |= INVALIDATE_RENDER;
     }
 }
 
@@ -566,6 +564,93 @@ static inline void draw_foreground(const text_layout_item *item, const int16_t o
     draw_glyph(item->glyph, item->x + offset_x, item->y + offset_y, color, opacity);
 }
 
+// Copy a glyph to the render cache, with the palette offset that draw_glyph() would have the renderer apply.
+// Returns false if a visible pixel would end up as the transparent index.
+static bool blit_glyph(surface *dst, const surface *glyph, const int x, const int y, const vga_index color) {
+    const int palette_offset = (int)color - 1;
+    for(int gy = 0; gy < glyph->h; gy++) {
+        const vga_pixel *src_row = glyph->data + gy * glyph->w;
+        vga_pixel *dst_row = dst->data + (y + gy) * dst->w + x;
+        for(int gx = 0; gx < glyph->w; gx++) {
+            if(src_row[gx] == glyph->transparent) {
+                continue;
+            }
+            const int index = clamp(src_row[gx] + palette_offset, 0, 255);
+            if(index == dst->transparent) {
+                return false;
+            }
+            dst_row[gx] = index;
+        }
+    }
+    return true;
+}
+
+static bool blit_shadow(surface *dst, const text_layout_item *item, const int x, const int y, const uint8_t shadow,
+                        const vga_index color) {
+    if((shadow & GLYPH_SHADOW_RIGHT) && !blit_glyph(dst, item->glyph, x + 1, y, color)) {
+        return false;
+    }
+    if((shadow & GLYPH_SHADOW_LEFT) && !blit_glyph(dst, item->glyph, x - 1, y, color)) {
+        return false;
+    }
+    if((shadow & GLYPH_SHADOW_BOTTOM) && !blit_glyph(dst, item->glyph, x, y + 1, color)) {
+        return false;
+    }
+    if((shadow & GLYPH_SHADOW_TOP) && !blit_glyph(dst, item->glyph, x, y - 1, color)) {
+        return false;
+    }
+    return true;
+}
+
+// Render the shadows and glyphs to a single surface, in the same order as text_draw_opacity() would draw them.
+static void build_render_cache(text *t) {
+    text_layout_item *item;
+    iterator it;
+
+    free_render_cache(t);
+    t->cache_flags &= ~(INVALIDATE_STYLE | INVALIDATE_RENDER);
+    if(vector_size(&t->layout.items) == 0) {
+        return;
+    }
+
+    int x0 = INT_MAX, y0 = INT_MAX, x1 = INT_MIN, y1 = INT_MIN;
+    vector_iter_begin(&t->layout.items, &it);
+    foreach(it, item) {
+        x0 = min2(x0, item->x);
+        y0 = min2(y0, item->y);
+        x1 = max2(x1, item->x + item->glyph->w);
+        y1 = max2(y1, item->y + item->glyph->h);
+    }
+    x0 -= (t->shadow & GLYPH_SHADOW_LEFT) ? 1 : 0;
+    x1 += (t->shadow & GLYPH_SHADOW_RIGHT) ? 1 : 0;
+    y0 -= (t->shadow & GLYPH_SHADOW_TOP) ? 1 : 0;
+    y1 += (t->shadow & GLYPH_SHADOW_BOTTOM) ? 1 : 0;
+
+    surface *cache = omf_calloc(1, sizeof(surface));
+    surface_create(cache, x1 - x0, y1 - y0);
+    vector_iter_begin(&t->layout.items, &it);
+    foreach(it, item) {
+        if(!blit_shadow(cache, item, item->x - x0, item->y - y0, t->shadow, t->shadow_color)) {
+            goto error_0;
+        }
+    }
+    vector_iter_begin(&t->layout.items, &it);
+    foreach(it, item) {
+        if(!blit_glyph(cache, item->glyph, item->x - x0, item->y - y0, t->text_color)) {
+            goto error_0;
+        }
+    }
+    t->render_cache = cache;
+    t->render_x = x0;
+    t->render_y = y0;
+    return;
+
+error_0:
+    // This color can't be told apart from transparency in a single surface; draw glyph by glyph instead.
+    surface_free(cache);
+    omf_free(cache);
+}
+
 void text_draw_opacity(text *t, int16_t offset_x, int16_t offset_y, uint8_t opacity) {
     assert(t != NULL);
     if(opacity == 0) {
@@ -575,6 +660,18 @@ void text_draw_opacity(text *t, int16_t offset_x, int16_t offset_y, uint8_t opac
     iterator it;
     text_generate_layout(t); // Ensure we have a layout
 
+    // With translucent text, the shadows must show through the glyphs. A single surface can't do that.
+    if(t->render_cache_enabled && opacity == 255) {
+        if(t->cache_flags & (INVALIDATE_STYLE | INVALIDATE_RENDER)) {
+            build_render_cache(t);
+        }
+        if(t->render_cache != NULL) {
+            const surface *cache = t->render_cache;
+            video_draw(cache, offset_x + t->render_x, offset_y + t->render_y);
+            return;
+        }
+    }
+
     // First the shadows for all letters.
     vector_iter_begin(&t->layout.items, &it);
     foreach(it, item) {
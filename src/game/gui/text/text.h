@@ -14,6 +14,7 @@
 #include <stdint.h>
 
 #include "game/gui/text/enums.h"
+#include "game/gui/text/text_markup.h"
 #include "resources/fonts.h"
 #include "utils/str.h"
 #include "video/vga_palette.h"
@@ -219,6 +220,16 @@ void text_set_glyph_margin(text *t, uint8_t glyph_margin);
  */
 void text_set_word_wrap(text *t, bool enable);
 
+/**
+ * @brief Set whether the rendered text is cached
+ * @details When enabled, the glyphs and their shadows are rendered to a single surface whenever the text, layout or
+ *          colors change, and that surface is then drawn instead of every glyph separately. Meant for texts that
+ *          rarely change; every change uploads a new surface. Texts in documents are always cached.
+ * @param t Text object to modify
+ * @param enable True to enable the render cache
+ */
+void text_set_render_cache(text *t, bool enable);
+
 /**
  * @brief Get the text content as a str object
  * @param t Text object to query
@@ -374,6 +385,31 @@ void text_generate_document(text_document *td, str *buf0, font_size font_sz, uin
                             text_horizontal_align horizontal_align, text_margin margin, uint8_t line_spacing,
                             uint8_t letter_spacing, uint8_t shadow, uint8_t glyph_margin);
 
+/**
+ * @brief Generate a text document from compiled markup
+ * @details Same as text_generate_document(), but skips parsing the markup. Use this for texts that are shown
+ *          repeatedly, see lang_get_markup().
+ * @param td Text document to populate
+ * @param markup Compiled source text
+ * @param font_sz Font size
+ * @param w Bounding box width
+ * @param h Bounding box height
+ * @param text_color Text color
+ * @param shadow_color Shadow color
+ * @param vertical_align Vertical alignment
+ * @param horizontal_align Horizontal alignment
+ * @param margin Text margin
+ * @param line_spacing Line spacing
+ * @param letter_spacing Letter spacing
+ * @param shadow Shadow style flags
+ * @param glyph_margin Glyph margin
+ */
+void text_generate_markup_document(text_document *td, const text_markup *markup, font_size font_sz, uint16_t w,
+                                   uint16_t h, vga_index text_color, vga_index shadow_color,
+                                   text_vertical_align vertical_align, text_horizontal_align horizontal_align,
+                                   text_margin margin, uint8_t line_spacing, uint8_t letter_spacing, uint8_t shadow,
+                                   uint8_t glyph_margin);
+
 /**
  * @brief Generate the text layout with all glyphs at correct coordinates
  * @details This will be run by the renderer at first screen render if not yet generated.
@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "game/gui/text/enums.h"
+#include "game/gui/text/text_markup.h"
+#include "utils/c_array_util.h"
+#include "utils/miscmath.h"
+
+typedef struct markup_tag {
+    const char *tag;
+    text_markup_op_type type;
+    int32_t value;
+} markup_tag;
+
+// Tags without arguments
+static const markup_tag fixed_tags[] = {
+    {"{CENTER OFF}",    MARKUP_OP_ALIGN,         TEXT_ALIGN_LEFT                         },
+    {"{CENTER ON}",     MARKUP_OP_ALIGN,         TEXT_ALIGN_CENTER                       },
+    {"{SIZE 8}",        MARKUP_OP_SIZE,          8                                       },
+    {"{SIZE 6}",        MARKUP_OP_SIZE,          6                                       },
+    {"{SHADOWS ON}",    MARKUP_OP_SHADOW,        GLYPH_SHADOW_RIGHT | GLYPH_SHADOW_BOTTOM},
+    {"{SHADOWS OFF}",   MARKUP_OP_SHADOW,        GLYPH_SHADOW_NONE                       },
+    {"{COLOR:YELLOW}",  MARKUP_OP_COLOR_YELLOW,  0                                       },
+    {"{COLOR:DEFAULT}", MARKUP_OP_COLOR_DEFAULT, 0                                       },
+};
+
+static void add_op(text_markup *markup, text_markup_op_type type, int32_t value, uint32_t len) {
+    text_markup_op *op = vector_append_ptr(&markup->ops);
+    op->type = type;
+    op->value = value;
+    op->len = len;
+}
+
+// Parses a single tag at the start of buf. Returns the tag length, or 0 if this is not a tag we know of.
+static int parse_tag(text_markup *markup, const char *buf) {
+    for(unsigned i = 0; i < N_ELEMENTS(fixed_tags); i++) {
+        const size_t tag_len = strlen(fixed_tags[i].tag);
+        if(strncmp(buf, fixed_tags[i].tag, tag_len) == 0) {
+            add_op(markup, fixed_tags[i].type, fixed_tags[i].value, 0);
+            return tag_len;
+        }
+    }
+
+    unsigned short number;
+    int color;
+    int bytes_used = 0;
+    if(sscanf(buf, "{WIDTH %hu}%n", &number, &bytes_used) == 1 && bytes_used > 0) {
+        add_op(markup, MARKUP_OP_WIDTH, max2(8, min2(number, 320)), 0);
+    } else if(sscanf(buf, "{VMOVE %hu}%n", &number, &bytes_used) == 1 && bytes_used > 0) {
+        add_op(markup, MARKUP_OP_VMOVE, min2(number, 200), 0);
+    } else if(sscanf(buf, "{CENTER %hu}%n", &number, &bytes_used) == 1 && bytes_used > 0) {
+        // TODO we need to handle this properly, it will likely update the x offset
+    } else if(sscanf(buf, "{COLOR %i}%n", &color, &bytes_used) == 1 && bytes_used > 0) {
+        add_op(markup, MARKUP_OP_COLOR, color, 0);
+    } else if(sscanf(buf, "{SPACING %hu}%n", &number, &bytes_used) == 1 && bytes_used > 0) {
+        add_op(markup, MARKUP_OP_SPACING, number, 0);
+    } else {
+        bytes_used = 0;
+    }
+    return bytes_used;
+}
+
+void text_markup_create(text_markup *markup, const str *src) {
+    str_from(&markup->source, src);
+    vector_create(&markup->ops, sizeof(text_markup_op));
+
+    const char *buf = str_c(&markup->source);
+    const size_t len = str_size(&markup->source);
+    size_t start = 0;
+    while(start < len) {
+        if(buf[start] == '{') {
+            int tag_len = parse_tag(markup, buf + start);
+            if(tag_len > 0) {
+                start += tag_len;
+                continue;
+            }
+            const char *end = strchr(buf + start, '}');
+            if(end == NULL) {
+                // Unterminated markup, drop everything after it.
+                return;
+            }
+            // Unknown markup, skip it.
+            start = end + 1 - buf;
+            continue;
+        }
+
+        const char *next = strchr(buf + start, '{');
+        const size_t end = next != NULL ? (size_t)(next - buf) : len;
+        add_op(markup, MARKUP_OP_TEXT, start, end - start);
+        start = end;
+    }
+}
+
+void text_markup_free(text_markup *markup) {
+    str_free(&markup->source);
+    vector_free(&markup->ops);
+}
+
+bool text_markup_is_last_run(const text_markup *markup, const text_markup_op *op) {
+    return op->value + op->len == str_size(&markup->source);
+}
@@ -0,0 +1,76 @@
+/**
+ * @file text_markup.h
+ * @brief Compiled text markup
+ * @details Tokenizes the {TAG} markup used by the help pages and other long texts in the language files into a list
+ *          of operations, so that it only needs to be parsed once. text_generate_document() replays the operations.
+ * @copyright MIT License
+ * @date 2026
+ * @author OpenOMF Project
+ */
+
+#ifndef TEXT_MARKUP_H
+#define TEXT_MARKUP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "utils/str.h"
+#include "utils/vector.h"
+
+/**
+ * @brief Markup operation types
+ */
+typedef enum text_markup_op_type
+{
+    MARKUP_OP_TEXT,          ///< Run of text, see text_markup_op
+    MARKUP_OP_ALIGN,         ///< Set the horizontal alignment ({CENTER ON}, {CENTER OFF})
+    MARKUP_OP_SIZE,          ///< Switch to the 8 or 6 pixel font of the document font family ({SIZE n})
+    MARKUP_OP_SHADOW,        ///< Set the shadow style ({SHADOWS ON}, {SHADOWS OFF})
+    MARKUP_OP_COLOR,         ///< Set the text color ({COLOR n})
+    MARKUP_OP_COLOR_YELLOW,  ///< Set the text and shadow colors to yellow ({COLOR:YELLOW})
+    MARKUP_OP_COLOR_DEFAULT, ///< Restore the document text and shadow colors ({COLOR:DEFAULT})
+    MARKUP_OP_WIDTH,         ///< Set the bounding box width ({WIDTH n})
+    MARKUP_OP_VMOVE,         ///< Set the vertical offset ({VMOVE n})
+    MARKUP_OP_SPACING,       ///< Set the line spacing, including the font height ({SPACING n})
+} text_markup_op_type;
+
+/**
+ * @brief Single markup operation
+ */
+typedef struct text_markup_op {
+    uint8_t type;  ///< One of text_markup_op_type
+    int32_t value; ///< Tag argument, or the offset of the text run in the source string
+    uint32_t len;  ///< Length of the text run
+} text_markup_op;
+
+/**
+ * @brief Compiled markup string
+ */
+typedef struct text_markup {
+    str source; ///< Copy of the source string, text runs point here
+    vector ops; ///< Vector of text_markup_op
+} text_markup;
+
+/**
+ * @brief Compile a markup string
+ * @details Unknown tags are skipped. An unterminated tag ends the markup, and any text after it is dropped.
+ * @param markup Markup structure to initialize
+ * @param src Source string
+ */
+void text_markup_create(text_markup *markup, const str *src);
+
+/**
+ * @brief Free a compiled markup string's resources
+ * @param markup Markup to free
+ */
+void text_markup_free(text_markup *markup);
+
+/**
+ * @brief Check if a text run ends the source string
+ * @param markup Markup the operation belongs to
+ * @param op Text run operation
+ * @return True if there is no markup after the text run
+ */
+bool text_markup_is_last_run(const text_markup *markup, const text_markup_op *op);
+
+#endif // TEXT_MARKUP_H
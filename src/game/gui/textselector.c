@@ -172,6 +172,7 @@ component *textselector_create(const char *text, const char *help, textselector_
     text_selector *t = omf_calloc(1, sizeof(text_selector));
     str_from_c(&t->title, text);
     t->text = text_create();
+    text_set_render_cache(t->text, true);
     t->pos = &t->pos_;
     t->userdata = userdata;
     t->toggle = cb;
@@ -1973,8 +1973,9 @@ void har_tick(object *obj) {
     // to show the sprite with animation string that interpolates opacity down
     // Mark new object as the owner of the animation, so that the animation gets
     // removed when the object is finished.
+    // The trail cache is shared by all clones, so AI lookahead clones (which are never drawn) skip this.
     sprite *cur_sprite;
-    if(object_has_effect(obj, EFFECT_TRAIL) && obj->age % 2 == 0 &&
+    if(object_has_effect(obj, EFFECT_TRAIL) && obj->age % 2 == 0 && !obj->gs->lookahead &&
        (cur_sprite = animation_get_sprite(obj->cur_animation, obj->cur_sprite_id))) {
         animation *anim = NULL;
         if(hashmap_get_int(h->trail_cache, obj->cur_sprite_id, (void **)&anim, NULL)) {
@@ -2140,23 +2141,19 @@ bool is_move_chain_allowed(object *obj, af_move *move) {
 
 af_move *match_move(object *obj, char prefix, char *inputs) {
     har *h = object_get_userdata(obj);
-    af_move *move = NULL;
-    size_t len;
-
-    for(int i = ANIM_SCREW + 1; i < 70; i++) {
-        if((move = af_get_move(h->af_data, i))) {
-            len = str_size(&move->move_string);
-            if(str_at(&move->move_string, 0) == prefix &&
-               (len == 1 || !strncmp(str_c(&move->move_string) + 1, inputs, len - 1))) {
-                if(is_move_chain_allowed(obj, move)) {
-                    if(str_size(&move->move_string) > 1) {
-                        // matched a move that was not just a 5P or 5K
-                        // so truncate the buffer
-                        h->inputs[0] = 0;
-                    }
-                    return move;
-                }
+    af_move_set matches;
+    af_move_matcher_match(&h->af_data->matcher, prefix, inputs, &matches);
+
+    // Moves with lower IDs take priority
+    for(int i = af_move_set_next(&matches, ANIM_SCREW + 1); i != -1; i = af_move_set_next(&matches, i + 1)) {
+        af_move *move = af_get_move(h->af_data, i);
+        if(is_move_chain_allowed(obj, move)) {
+            if(str_size(&move->move_string) > 1) {
+                // matched a move that was not just a 5P or 5K
+                // so truncate the buffer
+                h->inputs[0] = 0;
             }
+            return move;
         }
     }
     return NULL;
@@ -2164,20 +2161,21 @@ af_move *match_move(object *obj, char prefix, char *inputs) {
 
 af_move *scrap_destruction_cheat(object *obj, char input) {
     har *h = object_get_userdata(obj);
-    for(int i = 0; i < 70; i++) {
-        af_move *move;
-        if((move = af_get_move(h->af_data, i))) {
-            if(move->category == CAT_SCRAP && h->state == STATE_VICTORY && input == 'K' &&
-               (player_frame_isset(obj, TAG_JF) ||
-                (player_frame_isset(obj, TAG_JN) && i == player_frame_get(obj, TAG_JN)))) {
-                return move;
-            }
+    int jf_tag;
+    af_move_set candidates;
+    if(h->state == STATE_VICTORY && input == 'K') {
+        af_move_matcher_category(&h->af_data->matcher, CAT_SCRAP, &candidates);
+        jf_tag = TAG_JF;
+    } else if(h->state == STATE_SCRAP && input == 'P') {
+        af_move_matcher_category(&h->af_data->matcher, CAT_DESTRUCTION, &candidates);
+        jf_tag = TAG_JF2;
+    } else {
+        return NULL;
+    }
 
-            if(move->category == CAT_DESTRUCTION && h->state == STATE_SCRAP && input == 'P' &&
-               (player_frame_isset(obj, TAG_JF2) ||
-                (player_frame_isset(obj, TAG_JN) && i == player_frame_get(obj, TAG_JN)))) {
-                return move;
-            }
+    for(int i = af_move_set_next(&candidates, 0); i != -1; i = af_move_set_next(&candidates, i + 1)) {
+        if(player_frame_isset(obj, jf_tag) || (player_frame_isset(obj, TAG_JN) && i == player_frame_get(obj, TAG_JN))) {
+            return af_get_move(h->af_data, i);
         }
     }
     return NULL;
@@ -2880,6 +2878,8 @@ int har_create(object *obj, af *af_data, int dir, int har_id, int pilot_id, int
             }
         }
     }
+    // move strings may have been changed above
+    af_move_matcher_build(&af_data->matcher, af_data);
 
     // All done
     return 0;
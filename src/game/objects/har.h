@@ -205,6 +205,7 @@ int har_is_active(object *obj);
 int har_is_crouching(har *h);
 int har_is_walking(har *h);
 int har_is_blocking(object *obj, af_move *move);
+void har_take_damage(object *obj, af_move *move);
 void har_copy_actions(object *new, object *old);
 void har_reset(object *obj);
 
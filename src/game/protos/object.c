@@ -8,12 +8,14 @@
 #include "video/enums.h"
 #include "video/vga_state.h"
 #include "video/video.h"
+#include <SDL.h>
 #include <stdlib.h>
 #include <string.h>
 
 #define UNUSED(x) (void)(x)
 
-static uint32_t object_id = 1;
+// Objects are also created by the AI lookahead workers, so the counter is atomic.
+static SDL_atomic_t object_id = {1};
 
 /** \brief Creates a new, empty object.
  * \param obj Object handle
@@ -24,7 +26,7 @@ static uint32_t object_id = 1;
 void object_create(object *obj, game_state *gs, vec2i pos, vec2f vel) {
     // State
     obj->gs = gs;
-    obj->id = object_id++;
+    obj->id = (uint32_t)SDL_AtomicAdd(&object_id, 1);
 
     // Position related
     obj->pos = vec2i_to_f(pos);
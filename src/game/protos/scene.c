@@ -4,6 +4,7 @@
 #include "resources/af_loader.h"
 #include "resources/bk_loader.h"
 #include "resources/ids.h"
+#include "resources/preloader.h"
 #include "resources/resource_files.h"
 #include "utils/allocator.h"
 #include "utils/log.h"
@@ -18,42 +19,53 @@ void cb_scene_spawn_object(object *parent, int id, vec2i pos, vec2f vel, uint8_t
                            void *userdata);
 void cb_scene_destroy_object(object *parent, int id, void *userdata);
 
-// Loads BK file etc.
-int scene_create(scene *scene, game_state *gs, int scene_id) {
-    if(scene_id == SCENE_NONE) {
-        return 1;
-    }
-
-    path bk_filename;
+bool scene_get_bk_filename(game_state *gs, int scene_id, path *filename) {
     switch(scene_id) {
+        case SCENE_NONE:
+            return false;
         case SCENE_TRN_CUTSCENE: {
             game_player *player = game_state_get_player(gs, 0);
             if(player && player->chr && player->chr->bk_name[0] != '\0') {
-                bk_filename = get_resource_filename(player->chr->bk_name);
-                path_dossify_filename(&bk_filename);
-                break;
+                *filename = get_resource_filename(player->chr->bk_name);
+                path_dossify_filename(filename);
+                return true;
             }
-            log_error("Not a valid time to be going to SCENE_TRN_CUTSCENE");
-            return 1;
+            return false;
         }
         default:
-            bk_filename = get_resource_filename(get_resource_file(BK_INTRO + (scene_id - 1)));
-            break;
+            *filename = get_resource_filename(get_resource_file(BK_INTRO + (scene_id - 1)));
+            return true;
         case SCENE_SCOREBOARD:
-            bk_filename = get_resource_filename("MAIN.BK");
-            break;
+            *filename = get_resource_filename("MAIN.BK");
+            return true;
         case SCENE_LOBBY:
-            bk_filename = get_resource_filename("NETARENA.PCX");
-            break;
+            *filename = get_resource_filename("NETARENA.PCX");
+            return true;
     }
+}
 
-    // Load BK
-    scene->bk_data = omf_calloc(1, sizeof(bk));
-    if(load_bk_file(scene->bk_data, &bk_filename)) {
-        log_error("Unable to load scene %s (%s)!", scene_get_name(scene_id), path_c(&bk_filename));
-        omf_free(scene->bk_data);
+// Loads BK file etc.
+int scene_create(scene *scene, game_state *gs, int scene_id) {
+    if(scene_id == SCENE_NONE) {
         return 1;
     }
+
+    path bk_filename;
+    if(!scene_get_bk_filename(gs, scene_id, &bk_filename)) {
+        log_error("Not a valid time to be going to %s", scene_get_name(scene_id));
+        return 1;
+    }
+
+    // Load BK, unless it has already been loaded in the background
+    scene->bk_data = preloader_take_bk(&bk_filename);
+    if(scene->bk_data == NULL) {
+        scene->bk_data = omf_calloc(1, sizeof(bk));
+        if(load_bk_file(scene->bk_data, &bk_filename)) {
+            log_error("Unable to load scene %s (%s)!", scene_get_name(scene_id), path_c(&bk_filename));
+            omf_free(scene->bk_data);
+            return 1;
+        }
+    }
     scene->id = scene_id;
     scene->gs = gs;
     scene->af_data[0] = NULL;
@@ -95,12 +107,17 @@ int scene_load_har(scene *scene, int player_id) {
         af_free(scene->af_data[player_id]);
         omf_free(scene->af_data[player_id]);
     }
-    scene->af_data[player_id] = omf_calloc(1, sizeof(af));
 
+    // Load AF, unless it has already been loaded in the background
     int resource_id = har_to_resource(player->pilot->har_id);
-    if(load_af_file(scene->af_data[player_id], resource_id)) {
-        log_error("Unable to load HAR %s (%s)!", har_get_name(player->pilot->har_id), get_resource_name(resource_id));
-        return 1;
+    scene->af_data[player_id] = preloader_take_af(resource_id);
+    if(scene->af_data[player_id] == NULL) {
+        scene->af_data[player_id] = omf_calloc(1, sizeof(af));
+        if(load_af_file(scene->af_data[player_id], resource_id)) {
+            log_error("Unable to load HAR %s (%s)!", har_get_name(player->pilot->har_id),
+                      get_resource_name(resource_id));
+            return 1;
+        }
     }
 
     log_debug("Loaded HAR %s (%s).", har_get_name(player->pilot->har_id), get_resource_name(resource_id));
@@ -53,6 +53,7 @@ struct scene_t {
     ticktimer tick_timer;
 };
 
+bool scene_get_bk_filename(game_state *gs, int scene_id, path *filename);
 int scene_create(scene *scene, game_state *gs, int scene_id);
 int scene_load_har(scene *scene, int player_id);
 void scene_init(scene *scene);
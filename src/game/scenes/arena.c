@@ -831,43 +831,6 @@ void maybe_install_har_hooks(scene *scene) {
     har_install_hook(har2, &arena_har_hook, scene);
 }
 
-// djb hash
-uint32_t arena_state_hash(game_state *gs) {
-    uint32_t hash = 5381;
-    // include the arena ID
-    hash = ((hash << 5) + hash) + gs->sc->id;
-    for(int i = 0; i < 2; i++) {
-        game_player *player = game_state_get_player(gs, i);
-        object *obj_har = game_state_find_object(gs, game_player_get_har_obj_id(player));
-        har *har = obj_har->userdata;
-        vec2i pos = object_get_pos(obj_har);
-        vec2f vel = object_get_vel(obj_har);
-        uint32_t x = (uint32_t)pos.x;
-        uint32_t y = (uint32_t)pos.y;
-        uint32_t health = (uint32_t)har->health;
-        uint32_t endurance = (uint32_t)har->endurance;
-        uint32_t vx_bits, vy_bits;
-        hash = ((hash << 5) + hash) + har->id;
-        hash = ((hash << 5) + hash) + player->pilot->power;
-        hash = ((hash << 5) + hash) + player->pilot->agility;
-        hash = ((hash << 5) + hash) + player->pilot->endurance;
-        hash = ((hash << 5) + hash) + x;
-        hash = ((hash << 5) + hash) + y;
-        hash = ((hash << 5) + hash) + health;
-        hash = ((hash << 5) + hash) + endurance;
-        // memcpy to avoid UB on negative floats
-        memcpy(&vx_bits, &vel.x, sizeof(vx_bits));
-        memcpy(&vy_bits, &vel.y, sizeof(vy_bits));
-        hash = ((hash << 5) + hash) + vx_bits;
-        hash = ((hash << 5) + hash) + vy_bits;
-        hash = ((hash << 5) + hash) + har->state;
-        hash = ((hash << 5) + hash) + har->executing_move;
-        hash = ((hash << 5) + hash) + obj_har->cur_animation->id;
-        hash = ((hash << 5) + hash) + random_get_seed(&gs->rand);
-    }
-    return hash;
-}
-
 char *state_name(int state) {
     switch(state) {
         case STATE_STANDING:
@@ -1275,8 +1238,8 @@ void arena_dynamic_tick(scene *scene, int paused) {
         chr_score_tick(game_player_get_score(game_state_get_player(scene->gs, 0)));
         chr_score_tick(game_player_get_score(game_state_get_player(scene->gs, 1)));
 
-        // Set and tick all proggressbars
-        for(int i = 0; i < 2; i++) {
+        // Set and tick all proggressbars. These are shared with lookahead clones, which leave them alone.
+        for(int i = 0; i < 2 && !gs->lookahead; i++) {
             float hp = (float)hars[i]->health / (float)hars[i]->health_max;
             float en = 0.0f;
             if((float)hars[i]->endurance >= 0) {
@@ -1617,6 +1580,10 @@ void arena_clone(scene *src, scene *dst) {
     memcpy(dst->userdata, src->userdata, sizeof(arena_local));
     maybe_install_har_hooks(dst);
 
+    if(dst->gs->lookahead) {
+        // the game menu is shared with the original scene, and lookahead clones are simulated on other threads
+        return;
+    }
     component *c = gui_frame_find(local->game_menu, GAME_MENU_QUIT_ID);
     button_set_userdata(c, dst);
     c = gui_frame_find(local->game_menu, GAME_MENU_RETURN_ID);
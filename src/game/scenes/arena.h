@@ -19,7 +19,6 @@ void arena_set_state(scene *scene, int state);
 vga_palette *arena_get_player_palette(scene *scene, int player);
 void arena_toggle_rein(scene *scene);
 void maybe_install_har_hooks(scene *scene);
-uint32_t arena_state_hash(game_state *gs);
 void arena_state_dump(game_state *gs, char *buf, size_t bufsize);
 void arena_reset(scene *sc);
 int arena_is_over(scene *sc);
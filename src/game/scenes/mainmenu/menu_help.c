@@ -29,13 +29,8 @@ void help_menu_update(help_menu_data *local) {
 
     text_margin margin = {10, 0, 0, 0};
 
-    str helpstr;
-    str_from_c(&helpstr, lang_get(local->page));
-
-    text_generate_document(local->td, &helpstr, FONT_BIG, 280, 170, TEXT_BRIGHT_GREEN, TEXT_SHADOW_GREEN,
-                           TEXT_ALIGN_TOP, TEXT_ALIGN_LEFT, margin, 1, 0, 0, 0);
-
-    str_free(&helpstr);
+    text_generate_markup_document(local->td, lang_get_markup(local->page), FONT_BIG, 280, 170, TEXT_BRIGHT_GREEN,
+                                  TEXT_SHADOW_GREEN, TEXT_ALIGN_TOP, TEXT_ALIGN_LEFT, margin, 1, 0, 0, 0);
 }
 
 void menu_help_free(component *c) {
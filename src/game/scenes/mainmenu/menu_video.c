@@ -153,8 +153,17 @@ void fb_scaling_toggled(component *c, void *userdata, int pos) {
 void renderer_toggled(component *c, void *userdata, int pos) {
     settings_video *v = &settings_get()->video;
     const char *renderer;
-    video_get_renderer_info(pos, &renderer, NULL);
-    strncpy_or_abort(v->renderer, renderer, sizeof(v->renderer));
+    // The selector only lists renderers that show something on screen, so skip the headless ones here as well.
+    for(int r = 0; r < video_get_renderer_count(); r++) {
+        if(video_is_renderer_headless(r)) {
+            continue;
+        }
+        if(pos-- == 0) {
+            video_get_renderer_info(r, &renderer, NULL);
+            strncpy_or_abort(v->renderer, renderer, sizeof(v->renderer));
+            return;
+        }
+    }
 }
 
 void menu_video_done(component *c, void *u) {
@@ -216,17 +225,20 @@ component *menu_video_create(scene *s) {
         textselector_create("API:", "Choose the video renderer API to use", renderer_toggled, local);
     menu_attach(menu, renderer_selector);
 
-    // Add available renderers and make sure correct one is selected by default.
+    // Add available renderers and make sure correct one is selected by default. Headless renderers would leave the
+    // player without a picture, so they are not offered.
     const char *r_name;
+    int r_pos = 0;
     for(int r = 0; r < video_get_renderer_count(); r++) {
-        video_get_renderer_info(r, &r_name, NULL);
-        if(strcmp(r_name, "NULL") == 0) {
+        if(video_is_renderer_headless(r)) {
             continue;
         }
+        video_get_renderer_info(r, &r_name, NULL);
         textselector_add_option(renderer_selector, r_name);
         if(strcmp(r_name, setting->video.renderer) == 0) {
-            textselector_set_pos(renderer_selector, r);
+            textselector_set_pos(renderer_selector, r_pos);
         }
+        r_pos++;
     }
 
     // Resolution selector
@@ -173,8 +173,9 @@ void newsroom_overlay_render(scene *scene) {
         // Render screen capture
         har_screencaps *caps = &(game_state_get_player(scene->gs, (local->won ? 0 : 1))->screencaps);
         int cap_id = (local->screen == 0) ? SCREENCAP_POSE : SCREENCAP_BLOW;
-        if(caps->ok[cap_id]) {
-            video_draw_size(&caps->cap[cap_id], 165, 15, SCREENCAP_W, SCREENCAP_H);
+        const surface *cap = har_screencaps_get(caps, cap_id);
+        if(cap != NULL) {
+            video_draw_size(cap, 165, 15, SCREENCAP_W, SCREENCAP_H);
         }
     }
 
@@ -377,6 +378,7 @@ int newsroom_create(scene *scene) {
     text_set_vertical_align(local->news_str, TEXT_ALIGN_MIDDLE);
     text_set_color(local->news_str, NEWS_TEXT_COLOR);
     text_set_margin(local->news_str, (text_margin){1, 1, 1, 1});
+    text_set_render_cache(local->news_str, true);
 
     game_player *p1 = game_state_get_player(scene->gs, 0);
     game_player *p2 = game_state_get_player(scene->gs, 1);
@@ -630,7 +630,7 @@ int vs_create(scene *scene) {
         local->report = create_report_card(fight_stats); // Set up the statistics texts to the right side of the scene
 
         // Let's add some scrapes
-        sprite *har_sprite = animation_get_sprite(player1_har->cur_animation, player1->pilot->har_id);
+        sprite *har_sprite = animation_get_sprite_writable(player1_har->cur_animation, player1->pilot->har_id);
         ani = &bk_get_info(scene->bk_data, 9)->ani;
 
         int n_scrapes = ((fight_stats->max_hp - fight_stats->hp) * 170) / fight_stats->max_hp;
@@ -1,25 +1,40 @@
 #include "game/utils/har_screencap.h"
+#include "utils/allocator.h"
 #include "utils/miscmath.h"
 #include "video/vga_state.h"
 #include "video/video.h"
 
+static har_screencap *shot_create(void) {
+    har_screencap *shot = omf_calloc(1, sizeof(har_screencap));
+    SDL_AtomicSet(&shot->refs, 1);
+    return shot;
+}
+
+static void shot_release(har_screencap **shot) {
+    if(*shot == NULL) {
+        return;
+    }
+    if(SDL_AtomicDecRef(&(*shot)->refs)) {
+        if((*shot)->raw.data) {
+            surface_free(&(*shot)->raw);
+        }
+        if((*shot)->cap.data) {
+            surface_free(&(*shot)->cap);
+        }
+        omf_free(*shot);
+    }
+    *shot = NULL;
+}
+
 void har_screencaps_create(har_screencaps *caps) {
     for(int i = 0; i < 2; i++) {
-        caps->ok[i] = false;
+        caps->shots[i] = NULL;
     }
 }
 
 void har_screencaps_free(har_screencaps *caps) {
     for(int i = 0; i < 2; i++) {
-        if(caps->ok[i]) {
-            if(caps->raw[i].data) {
-                surface_free(&caps->raw[i]);
-            }
-            if(caps->cap[i].data) {
-                surface_free(&caps->cap[i]);
-            }
-            caps->ok[i] = false;
-        }
+        shot_release(&caps->shots[i]);
     }
 }
 
@@ -28,14 +43,11 @@ void har_screencaps_reset(har_screencaps *caps) {
 }
 
 int har_screencaps_clone(har_screencaps *src, har_screencaps *dst) {
+    // Captures are immutable, so clones (rollback and REC snapshots) just take another reference.
     for(int i = 0; i < 2; i++) {
-        if(src->ok[i]) {
-            if(src->raw[i].data) {
-                surface_create_from(&dst->raw[i], &src->raw[i]);
-            }
-            if(src->cap[i].data) {
-                surface_create_from(&dst->cap[i], &src->cap[i]);
-            }
+        dst->shots[i] = src->shots[i];
+        if(dst->shots[i] != NULL) {
+            SDL_AtomicIncRef(&dst->shots[i]->refs);
         }
     }
     return 1;
@@ -57,15 +69,11 @@ static vec2i camera_position_for(object *obj) {
 
 void har_screencaps_capture(har_screencaps *caps, object *obj, object *obj2, int id) {
     game_state *gs = obj->gs;
-    if(caps->ok[id]) {
-        if(caps->raw[id].data) {
-            surface_free(&caps->raw[id]);
-        }
-        if(caps->cap[id].data) {
-            surface_free(&caps->cap[id]);
-        }
-        caps->ok[id] = false;
+    if(gs->lookahead) {
+        // AI lookahead clones are simulated on worker threads, and must stay away from the renderer and vga_state.
+        return;
     }
+    shot_release(&caps->shots[id]);
 
     // Position
     vec2i pos = camera_position_for(obj);
@@ -85,14 +93,27 @@ void har_screencaps_capture(har_screencaps *caps, object *obj, object *obj2, int
     gs->hide_ui = true;
     game_state_render(gs);
     gs->hide_ui = false;
-    video_render_area_finish(&caps->raw[id]);
-    caps->ok[id] = true;
+    har_screencap *shot = shot_create();
+    video_render_area_finish(&shot->raw);
+    caps->shots[id] = shot;
 }
 
 void har_screencaps_compress(har_screencaps *caps, const vga_palette *pal, int id) {
-    if(caps->ok[id] && caps->raw[id].data) {
-        surface_to_grayscale(&caps->raw[id], &caps->cap[id], pal, 0xD0, 0xDF, 0x60);
-        surface_free(&caps->raw[id]);
-        caps->raw[id].data = NULL;
+    har_screencap *old = caps->shots[id];
+    if(old == NULL || old->raw.data == NULL) {
+        return;
+    }
+    // The old capture may be shared with game state clones, so the result goes to a new one.
+    har_screencap *shot = shot_create();
+    surface_to_grayscale(&old->raw, &shot->cap, pal, 0xD0, 0xDF, 0x60);
+    shot_release(&caps->shots[id]);
+    caps->shots[id] = shot;
+}
+
+const surface *har_screencaps_get(const har_screencaps *caps, int id) {
+    const har_screencap *shot = caps->shots[id];
+    if(shot == NULL || shot->cap.data == NULL) {
+        return NULL;
     }
+    return &shot->cap;
 }
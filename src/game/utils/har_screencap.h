@@ -3,6 +3,7 @@
 
 #include "game/protos/object.h"
 #include "video/surface.h"
+#include <SDL_atomic.h>
 
 #define SCREENCAP_W 140
 #define SCREENCAP_H 100
@@ -10,11 +11,16 @@
 #define SCREENCAP_BLOW 0
 #define SCREENCAP_POSE 1
 
+// A single capture. Never modified after it has been taken, so game state clones can share it.
+typedef struct har_screencap {
+    SDL_atomic_t refs;
+    surface raw; // Captured area, until compressed
+    surface cap; // Grayscale version, after compression
+} har_screencap;
+
 // There should be screencaps for each HAR/player
 typedef struct har_screencaps {
-    surface raw[2];
-    surface cap[2];
-    bool ok[2];
+    har_screencap *shots[2];
 } har_screencaps;
 
 void har_screencaps_create(har_screencaps *caps);
@@ -23,5 +29,6 @@ void har_screencaps_reset(har_screencaps *caps);
 int har_screencaps_clone(har_screencaps *src, har_screencaps *dst);
 void har_screencaps_capture(har_screencaps *caps, object *obj, object *obj2, int id);
 void har_screencaps_compress(har_screencaps *caps, const vga_palette *pal, int id);
+const surface *har_screencaps_get(const har_screencaps *caps, int id);
 
 #endif // HAR_SCREENCAP_H
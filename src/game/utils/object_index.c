@@ -0,0 +1,110 @@
+#include "game/utils/object_index.h"
+#include "game/protos/object.h"
+#include "utils/allocator.h"
+
+#include <string.h>
+
+#define INITIAL_CAPACITY 32
+
+// Object IDs are handed out sequentially, so a multiplicative hash spreads them nicely.
+static inline unsigned object_index_slot(const object_index *idx, uint32_t id) {
+    return (id * 2654435761u) & (idx->capacity - 1);
+}
+
+static void object_index_insert(object_index *idx, uint32_t id, object *obj) {
+    unsigned slot = object_index_slot(idx, id);
+    while(idx->entries[slot].id != 0 && idx->entries[slot].id != id) {
+        slot = (slot + 1) & (idx->capacity - 1);
+    }
+    if(idx->entries[slot].id == 0) {
+        idx->count++;
+    }
+    idx->entries[slot].id = id;
+    idx->entries[slot].obj = obj;
+}
+
+static void object_index_grow(object_index *idx) {
+    object_index_entry *old = idx->entries;
+    unsigned old_capacity = idx->capacity;
+
+    idx->capacity = old_capacity ? old_capacity * 2 : INITIAL_CAPACITY;
+    idx->entries = omf_calloc(idx->capacity, sizeof(object_index_entry));
+    idx->count = 0;
+    for(unsigned i = 0; i < old_capacity; i++) {
+        if(old[i].id != 0) {
+            object_index_insert(idx, old[i].id, old[i].obj);
+        }
+    }
+    omf_free(old);
+}
+
+void object_index_create(object_index *idx) {
+    idx->entries = NULL;
+    idx->capacity = 0;
+    idx->count = 0;
+}
+
+void object_index_free(object_index *idx) {
+    omf_free(idx->entries);
+    idx->capacity = 0;
+    idx->count = 0;
+}
+
+void object_index_clear(object_index *idx) {
+    if(idx->entries != NULL) {
+        memset(idx->entries, 0, idx->capacity * sizeof(object_index_entry));
+    }
+    idx->count = 0;
+}
+
+void object_index_add(object_index *idx, object *obj) {
+    // Keep the load factor at or below 1/2 so that probe chains stay short.
+    if((idx->count + 1) * 2 > idx->capacity) {
+        object_index_grow(idx);
+    }
+    object_index_insert(idx, obj->id, obj);
+}
+
+void object_index_remove(object_index *idx, uint32_t id) {
+    if(idx->count == 0) {
+        return;
+    }
+    unsigned mask = idx->capacity - 1;
+    unsigned slot = object_index_slot(idx, id);
+    while(idx->entries[slot].id != id) {
+        if(idx->entries[slot].id == 0) {
+            return;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    // Backward shift deletion; move any following entries of the probe chain into the hole, so no tombstones
+    // are needed.
+    unsigned hole = slot;
+    unsigned next = (hole + 1) & mask;
+    while(idx->entries[next].id != 0) {
+        unsigned home = object_index_slot(idx, idx->entries[next].id);
+        if(((next - home) & mask) >= ((next - hole) & mask)) {
+            idx->entries[hole] = idx->entries[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    idx->entries[hole].id = 0;
+    idx->entries[hole].obj = NULL;
+    idx->count--;
+}
+
+object *object_index_get(const object_index *idx, uint32_t id) {
+    if(idx->count == 0 || id == 0) {
+        return NULL;
+    }
+    unsigned slot = object_index_slot(idx, id);
+    while(idx->entries[slot].id != 0) {
+        if(idx->entries[slot].id == id) {
+            return idx->entries[slot].obj;
+        }
+        slot = (slot + 1) & (idx->capacity - 1);
+    }
+    return NULL;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file object_index.h
+ * @brief Lookup table from object ID to object
+ * @details Open addressing hash table with linear probing. Object IDs are never 0, so 0 marks an empty slot.
+ *          The table keeps its storage when cleared, so rebuilding it (e.g. after cloning) does not allocate.
+ * @copyright MIT License
+ * @date 2026
+ * @author OpenOMF Project
+ */
+
+#ifndef OBJECT_INDEX_H
+#define OBJECT_INDEX_H
+
+#include <stdint.h>
+
+typedef struct object_t object;
+
+/**
+ * @brief A single object index slot.
+ */
+typedef struct object_index_entry {
+    uint32_t id; ///< Object ID, or 0 if the slot is empty
+    object *obj; ///< Indexed object
+} object_index_entry;
+
+/**
+ * @brief Object lookup table.
+ */
+typedef struct object_index {
+    object_index_entry *entries; ///< Slots; capacity is always a power of two
+    unsigned capacity;           ///< Number of slots
+    unsigned count;              ///< Number of used slots
+} object_index;
+
+/**
+ * @brief Initialize an empty index. Nothing is allocated until the first object is added.
+ * @param idx Index to initialize
+ */
+void object_index_create(object_index *idx);
+
+/**
+ * @brief Free the index storage. The objects themselves are not touched.
+ * @param idx Index to free
+ */
+void object_index_free(object_index *idx);
+
+/**
+ * @brief Remove all objects from the index, but keep the storage for reuse.
+ * @param idx Index to clear
+ */
+void object_index_clear(object_index *idx);
+
+/**
+ * @brief Add an object to the index, keyed by its ID. An existing entry with the same ID is replaced.
+ * @param idx Index to add to
+ * @param obj Object to add
+ */
+void object_index_add(object_index *idx, object *obj);
+
+/**
+ * @brief Remove an object from the index.
+ * @param idx Index to remove from
+ * @param id ID of the object to remove. Unknown IDs are ignored.
+ */
+void object_index_remove(object_index *idx, uint32_t id);
+
+/**
+ * @brief Find an object by its ID.
+ * @param idx Index to search
+ * @param id Object ID
+ * @return Object, or NULL if it is not in the index.
+ */
+object *object_index_get(const object_index *idx, uint32_t id);
+
+#endif // OBJECT_INDEX_H
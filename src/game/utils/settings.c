@@ -312,16 +312,26 @@ int settings_write_defaults(const char *path) {
     return r;
 }
 
-int settings_init(const char *path) {
-    settings_path = path;
+static void settings_add_all_fields(void) {
     memset(&_settings, 0, sizeof(settings));
     for(unsigned i = 0; i < N_ELEMENTS(struct_to_fields); i++) {
         const struct_to_field *s2f = &struct_to_fields[i];
         settings_add_fields(s2f->fields, s2f->num_fields);
     }
+}
+
+int settings_init(const char *path) {
+    settings_path = path;
+    settings_add_all_fields();
     return conf_init(settings_path);
 }
 
+int settings_init_defaults(void) {
+    settings_path = NULL;
+    settings_add_all_fields();
+    return conf_init_defaults();
+}
+
 void settings_load(void) {
     for(unsigned i = 0; i < N_ELEMENTS(struct_to_fields); i++) {
         const struct_to_field *s2f = &struct_to_fields[i];
@@ -334,6 +344,9 @@ void settings_save(void) {
         const struct_to_field *s2f = &struct_to_fields[i];
         settings_save_fields(s2f->_struct, s2f->fields, s2f->num_fields);
     }
+    if(settings_path == NULL) {
+        return;
+    }
     if(conf_write_config(settings_path)) {
         log_error("Failed to write config file!\n");
     }
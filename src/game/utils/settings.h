@@ -141,6 +141,7 @@ typedef struct {
 
 int settings_write_defaults(const char *path);
 int settings_init(const char *path);
+int settings_init_defaults(void); // Default values only, not backed by a file. settings_save() does nothing.
 void settings_free(void);
 
 void settings_load(void);
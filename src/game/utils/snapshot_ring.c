@@ -0,0 +1,101 @@
+#include "game/utils/snapshot_ring.h"
+#include "game/game_state.h"
+#include "utils/allocator.h"
+
+#include <assert.h>
+
+static snapshot *snapshot_ring_at(const snapshot_ring *ring, unsigned index) {
+    return &ring->slots[(ring->head + index) % ring->capacity];
+}
+
+// The buffers are kept for the next snapshot that lands in this slot.
+static void snapshot_ring_drop_newest(snapshot_ring *ring) {
+    game_state_clone_release(&snapshot_ring_at(ring, ring->count - 1)->gs);
+    ring->count--;
+}
+
+void snapshot_ring_create(snapshot_ring *ring, unsigned capacity) {
+    assert(capacity > 0);
+    ring->slots = omf_calloc(capacity, sizeof(snapshot));
+    ring->capacity = capacity;
+    ring->head = 0;
+    ring->count = 0;
+}
+
+void snapshot_ring_clear(snapshot_ring *ring) {
+    while(ring->count > 0) {
+        snapshot_ring_drop_newest(ring);
+    }
+    ring->head = 0;
+}
+
+void snapshot_ring_free(snapshot_ring *ring) {
+    snapshot_ring_clear(ring);
+    for(unsigned i = 0; i < ring->capacity; i++) {
+        if(ring->slots[i].used) {
+            game_state_clone_buffers_free(&ring->slots[i].gs);
+        }
+    }
+    omf_free(ring->slots);
+    ring->capacity = 0;
+}
+
+game_state *snapshot_ring_save(snapshot_ring *ring, game_state *gs) {
+    // Keep the ring sorted by tick; a save always becomes the newest snapshot.
+    while(ring->count > 0 && snapshot_ring_newest(ring)->tick >= gs->tick) {
+        snapshot_ring_drop_newest(ring);
+    }
+
+    snapshot *slot;
+    if(ring->count == ring->capacity) {
+        // Full, so recycle the oldest slot.
+        slot = snapshot_ring_at(ring, 0);
+        ring->head = (ring->head + 1) % ring->capacity;
+        game_state_clone_release(&slot->gs);
+    } else {
+        slot = snapshot_ring_at(ring, ring->count);
+        ring->count++;
+    }
+
+    if(slot->used) {
+        game_state_clone_into(gs, &slot->gs);
+    } else {
+        game_state_clone(gs, &slot->gs);
+        slot->used = true;
+    }
+    return &slot->gs;
+}
+
+game_state *snapshot_ring_find(const snapshot_ring *ring, uint32_t tick) {
+    for(unsigned i = ring->count; i > 0; i--) {
+        snapshot *s = snapshot_ring_at(ring, i - 1);
+        if(s->gs.tick <= tick) {
+            return &s->gs;
+        }
+    }
+    return NULL;
+}
+
+game_state *snapshot_ring_newest(const snapshot_ring *ring) {
+    if(ring->count == 0) {
+        return NULL;
+    }
+    return &snapshot_ring_at(ring, ring->count - 1)->gs;
+}
+
+game_state *snapshot_ring_oldest(const snapshot_ring *ring) {
+    if(ring->count == 0) {
+        return NULL;
+    }
+    return &snapshot_ring_at(ring, 0)->gs;
+}
+
+void snapshot_ring_truncate(snapshot_ring *ring, uint32_t tick) {
+    while(ring->count > 0 && snapshot_ring_newest(ring)->tick > tick) {
+        snapshot_ring_drop_newest(ring);
+    }
+}
+
+game_state *snapshot_ring_restore(game_state *snap) {
+    return game_state_clone_alloc(snap);
+}
@@ -0,0 +1,114 @@
+/**
+ * @file snapshot_ring.h
+ * @brief Fixed size ring of game state snapshots for rewinding
+ * @details Snapshots are kept in tick order in a preallocated set of slots. When the ring is full,
+ *          the oldest snapshot is overwritten, and its buffers are reused for the new one.
+ * @copyright MIT License
+ * @date 2026
+ * @author OpenOMF Project
+ */
+
+#ifndef SNAPSHOT_RING_H
+#define SNAPSHOT_RING_H
+
+#include "game/game_state_type.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief A single snapshot slot.
+ */
+typedef struct snapshot {
+    bool used;     ///< True if the buffers of gs have been allocated
+    game_state gs; ///< Snapshot storage
+} snapshot;
+
+/**
+ * @brief Ring of game state snapshots, ordered by tick.
+ */
+typedef struct snapshot_ring {
+    snapshot *slots;   ///< Preallocated slots
+    unsigned capacity; ///< Number of slots
+    unsigned head;     ///< Slot index of the oldest snapshot
+    unsigned count;    ///< Number of snapshots currently held
+} snapshot_ring;
+
+/**
+ * @brief Allocate the snapshot slots.
+ * @param ring Ring to initialize
+ * @param capacity Maximum number of snapshots to keep. Must be at least 1.
+ */
+void snapshot_ring_create(snapshot_ring *ring, unsigned capacity);
+
+/**
+ * @brief Free all snapshots and the slots.
+ * @param ring Ring to free
+ */
+void snapshot_ring_free(snapshot_ring *ring);
+
+/**
+ * @brief Free all snapshots, but keep the slots and their buffers allocated.
+ * @param ring Ring to clear
+ */
+void snapshot_ring_clear(snapshot_ring *ring);
+
+/**
+ * @brief Save a snapshot of a game state.
+ * @details Any snapshots at or after the tick of gs are dropped first, so the ring stays in tick order.
+ *          If the ring is full, the oldest snapshot is replaced.
+ * @param ring Ring to save to
+ * @param gs Game state to snapshot
+ * @return The stored snapshot. Owned by the ring.
+ */
+game_state *snapshot_ring_save(snapshot_ring *ring, game_state *gs);
+
+/**
+ * @brief Find the newest snapshot taken at or before the given tick.
+ * @param ring Ring to search
+ * @param tick Tick to search for
+ * @return Snapshot, or NULL if there is none.
+ */
+game_state *snapshot_ring_find(const snapshot_ring *ring, uint32_t tick);
+
+/**
+ * @brief Get the newest snapshot.
+ * @param ring Ring to query
+ * @return Snapshot, or NULL if the ring is empty.
+ */
+game_state *snapshot_ring_newest(const snapshot_ring *ring);
+
+/**
+ * @brief Get the oldest snapshot.
+ * @param ring Ring to query
+ * @return Snapshot, or NULL if the ring is empty.
+ */
+game_state *snapshot_ring_oldest(const snapshot_ring *ring);
+
+/**
+ * @brief Drop all snapshots taken after the given tick.
+ * @param ring Ring to truncate
+ * @param tick Last tick to keep
+ */
+void snapshot_ring_truncate(snapshot_ring *ring, uint32_t tick);
+
+/**
+ * @brief Restore a snapshot into a heap allocated game state.
+ * @details The snapshot itself is left untouched, so it can be restored again later. The buffers of the last game
+ *          state passed to game_state_clone_recycle() are reused, so a rewind that replaces the running game state
+ *          does not allocate them again.
+ * @param snap Snapshot to restore, as returned by the ring
+ * @return Restored game state. Free with game_state_clone_recycle().
+ */
+game_state *snapshot_ring_restore(game_state *snap);
+
+/**
+ * @brief Get the number of snapshots in the ring.
+ * @param ring Ring to query
+ * @return Number of snapshots
+ */
+static inline unsigned snapshot_ring_size(const snapshot_ring *ring) {
+    return ring->count;
+}
+
+#endif // SNAPSHOT_RING_H
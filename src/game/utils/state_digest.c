@@ -0,0 +1,423 @@
+#include "game/utils/state_digest.h"
+#include "game/audio/playing_sound.h"
+#include "game/game_player.h"
+#include "game/game_state.h"
+#include "game/objects/har.h"
+#include "game/protos/object.h"
+#include "game/protos/scene.h"
+#include "game/scenes/arena.h"
+#include "utils/allocator.h"
+#include "utils/hashmap.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+#define PRIME64_1 0x9E3779B185EBCA87ULL
+#define PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3 0x165667B19E3779F9ULL
+#define PRIME64_4 0x85EBCA77C2B2AE63ULL
+
+void state_digest_create(state_digest *d) {
+    d->capacity = 1024;
+    d->count = 0;
+    d->words = omf_calloc(d->capacity, sizeof(uint32_t));
+    vector_create(&d->objects, sizeof(object *));
+    d->refs = NULL;
+    d->ref_capacity = 0;
+    d->text = NULL;
+    d->group = NULL;
+    d->index = -1;
+}
+
+void state_digest_free(state_digest *d) {
+    omf_free(d->words);
+    vector_free(&d->objects);
+    omf_free(d->refs);
+    d->ref_capacity = 0;
+    d->capacity = 0;
+    d->count = 0;
+}
+
+// -------- Serialization --------
+
+static void begin_group(state_digest *d, const char *group, int index) {
+    d->group = group;
+    d->index = index;
+}
+
+static void put_word(state_digest *d, uint32_t word) {
+    if(d->count == d->capacity) {
+        d->capacity *= 2;
+        d->words = omf_realloc(d->words, d->capacity * sizeof(uint32_t));
+    }
+    d->words[d->count++] = word;
+}
+
+static void put_key(state_digest *d, const char *name) {
+    if(d->index < 0) {
+        str_append_format(d->text, "%s.%s=", d->group, name);
+    } else {
+        str_append_format(d->text, "%s[%d].%s=", d->group, d->index, name);
+    }
+}
+
+static void put_int(state_digest *d, const char *name, int32_t value) {
+    put_word(d, (uint32_t)value);
+    if(d->text) {
+        put_key(d, name);
+        str_append_format(d->text, "%d\n", value);
+    }
+}
+
+static void put_uint(state_digest *d, const char *name, uint32_t value) {
+    put_word(d, value);
+    if(d->text) {
+        put_key(d, name);
+        str_append_format(d->text, "%" PRIu32 "\n", value);
+    }
+}
+
+static void put_float(state_digest *d, const char *name, float value) {
+    // Hash the bits, so that eg. -0.0 and 0.0 do not compare equal
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    put_word(d, bits);
+    if(d->text) {
+        // 9 significant digits are enough to tell any two floats apart
+        put_key(d, name);
+        str_append_format(d->text, "%.9g\n", value);
+    }
+}
+
+static void put_bytes(state_digest *d, const char *name, const void *buf, size_t len) {
+    const uint8_t *bytes = buf;
+    for(size_t i = 0; i < len; i += 4) {
+        uint32_t word = 0;
+        for(size_t k = i; k < len && k < i + 4; k++) {
+            word |= (uint32_t)bytes[k] << ((k - i) * 8);
+        }
+        put_word(d, word);
+    }
+    if(d->text) {
+        put_key(d, name);
+        for(size_t i = 0; i < len; i++) {
+            str_append_format(d->text, "%02x", bytes[i]);
+        }
+        str_append_char(d->text, '\n');
+    }
+}
+
+static bool any_object(const object *obj, void *userdata) {
+    return true;
+}
+
+static inline unsigned ref_slot(const state_digest *d, uint32_t id) {
+    return (id * 2654435761u) & (d->ref_capacity - 1);
+}
+
+/**
+ * Fill the reference table from the objects list. The table is kept at most half full.
+ */
+static void build_refs(state_digest *d) {
+    unsigned needed = 32;
+    while(needed < vector_size(&d->objects) * 2) {
+        needed *= 2;
+    }
+    if(d->ref_capacity < needed) {
+        omf_free(d->refs);
+        d->refs = omf_calloc(needed, sizeof(state_digest_ref));
+        d->ref_capacity = needed;
+    } else {
+        memset(d->refs, 0, d->ref_capacity * sizeof(state_digest_ref));
+    }
+
+    for(unsigned i = 0; i < vector_size(&d->objects); i++) {
+        uint32_t id = (*(object **)vector_get(&d->objects, i))->id;
+        if(id == 0) {
+            continue;
+        }
+        unsigned slot = ref_slot(d, id);
+        while(d->refs[slot].id != 0 && d->refs[slot].id != id) {
+            slot = (slot + 1) & (d->ref_capacity - 1);
+        }
+        if(d->refs[slot].id == 0) {
+            d->refs[slot].id = id;
+            d->refs[slot].pos = i;
+        }
+    }
+}
+
+/**
+ * Find the position of an object in the walk order, or -1 if there is no such object.
+ * Object ids come from a process wide counter, and differ between peers and between rewinds, so references to other
+ * objects are written as these positions instead.
+ */
+static int object_ref(const state_digest *d, uint32_t id) {
+    if(id == 0) {
+        return -1;
+    }
+    unsigned slot = ref_slot(d, id);
+    while(d->refs[slot].id != 0) {
+        if(d->refs[slot].id == id) {
+            return d->refs[slot].pos;
+        }
+        slot = (slot + 1) & (d->ref_capacity - 1);
+    }
+    return -1;
+}
+
+static void write_object(state_digest *d, const object *obj) {
+    put_int(d, "group", obj->group);
+    put_int(d, "direction", obj->direction);
+    put_float(d, "pos.x", obj->pos.x);
+    put_float(d, "pos.y", obj->pos.y);
+    put_float(d, "vel.x", obj->vel.x);
+    put_float(d, "vel.y", obj->vel.y);
+    put_float(d, "cvel.x", obj->cvel.x);
+    put_float(d, "cvel.y", obj->cvel.y);
+    put_float(d, "gravity", obj->gravity);
+    put_float(d, "vertical_velocity_modifier", obj->vertical_velocity_modifier);
+    put_float(d, "horizontal_velocity_modifier", obj->horizontal_velocity_modifier);
+    put_int(d, "wall_collision", obj->wall_collision);
+    put_int(d, "q_counter", obj->q_counter);
+    put_int(d, "q_val", obj->q_val);
+    put_int(d, "can_hit", obj->can_hit);
+    put_uint(d, "object_flags", obj->object_flags);
+    put_int(d, "animation", obj->cur_animation ? obj->cur_animation->id : -1);
+    put_int(d, "sprite", obj->cur_sprite_id);
+    put_uint(d, "animation_tick", obj->animation_state.reader.tick);
+    put_int(d, "animation_finished", obj->animation_state.finished);
+    put_int(d, "animation_repeat", obj->animation_state.repeat);
+    put_int(d, "animation_reverse", obj->animation_state.reverse);
+    put_int(d, "enemy_obj", object_ref(d, obj->animation_state.enemy_obj_id));
+    put_int(d, "disable_gravity", obj->sprite_state.disable_gravity);
+    put_int(d, "attached_to", object_ref(d, obj->attached_to_id));
+    put_int(d, "halt", obj->halt);
+    put_int(d, "halt_ticks", obj->halt_ticks);
+}
+
+static void write_har(state_digest *d, const har *h) {
+    put_int(d, "id", h->id);
+    put_int(d, "state", h->state);
+    put_int(d, "executing_move", h->executing_move);
+    put_int(d, "health", h->health);
+    put_int(d, "endurance", h->endurance);
+    put_int(d, "stun_timer", h->stun_timer);
+    put_int(d, "damage_done", h->damage_done);
+    put_int(d, "damage_received", h->damage_received);
+    put_int(d, "air_attacked", h->air_attacked);
+    put_int(d, "is_wallhugging", h->is_wallhugging);
+    put_int(d, "is_grabbed", h->is_grabbed);
+    put_int(d, "jump_delay", h->jump_delay);
+    put_float(d, "last_damage_value", h->last_damage_value);
+    put_float(d, "last_stun_value", h->last_stun_value);
+    put_int(d, "in_stasis_ticks", h->in_stasis_ticks);
+    put_int(d, "throw_duration", h->throw_duration);
+    put_int(d, "block_duration", h->block_duration);
+    put_int(d, "walk_destination", h->walk_destination);
+    put_int(d, "walk_done_anim", h->walk_done_anim);
+    put_int(d, "custom_defeat_animation", h->custom_defeat_animation);
+    put_bytes(d, "inputs", h->inputs, sizeof(h->inputs));
+    put_bytes(d, "rehits", h->rehits, sizeof(h->rehits));
+    put_int(d, "rehit_combo", h->rehit_combo);
+}
+
+static void write_sound(state_digest *d, const playing_sound *s) {
+    // The start tick is left out, as it is an absolute tick and the peers count ticks from different points.
+    put_int(d, "sound_id", s->sound_id);
+    put_int(d, "duration", s->duration);
+    put_int(d, "volume", s->volume);
+    put_int(d, "panning", s->panning);
+    put_int(d, "pitch", s->pitch);
+    put_int(d, "follow_object", object_ref(d, s->follow_object_id));
+}
+
+/**
+ * Walk the simulation state in canonical order. Fields that only matter locally (rendering, audio handles,
+ * absolute tick numbers, object ids) are left out, so that two peers in sync produce the same words.
+ */
+static void write_state(state_digest *d, game_state *gs) {
+    d->count = 0;
+    vector_clear(&d->objects);
+    game_state_find_objects(gs, &d->objects, any_object, NULL);
+    build_refs(d);
+    scene *sc = game_state_get_scene(gs);
+
+    begin_group(d, "game", -1);
+    put_uint(d, "version", STATE_DIGEST_VERSION);
+    put_int(d, "scene", sc ? sc->id : -1);
+    put_int(d, "arena_state", sc && scene_is_arena(sc) ? arena_get_state(sc) : -1);
+    put_uint(d, "seed", random_get_seed(&gs->rand));
+    put_int(d, "hit_pause", gs->hit_pause);
+    put_int(d, "speed_slowdown_previous", gs->speed_slowdown_previous);
+    put_int(d, "speed_slowdown_time", gs->speed_slowdown_time);
+    put_int(d, "screen_shake_horizontal", gs->screen_shake_horizontal);
+    put_int(d, "screen_shake_vertical", gs->screen_shake_vertical);
+    put_int(d, "objects", vector_size(&d->objects));
+    put_int(d, "sounds", vector_size(&gs->tracker.entries));
+
+    for(unsigned i = 0; i < vector_size(&d->objects); i++) {
+        begin_group(d, "object", i);
+        write_object(d, *(object **)vector_get(&d->objects, i));
+    }
+
+    for(int i = 0; i < 2; i++) {
+        game_player *player = game_state_get_player(gs, i);
+        begin_group(d, "pilot", i);
+        put_int(d, "power", player->pilot ? player->pilot->power : -1);
+        put_int(d, "agility", player->pilot ? player->pilot->agility : -1);
+        put_int(d, "endurance", player->pilot ? player->pilot->endurance : -1);
+
+        int har_ref = object_ref(d, player->har_obj_id);
+        put_int(d, "har", har_ref);
+        object *obj = har_ref >= 0 ? *(object **)vector_get(&d->objects, har_ref) : NULL;
+        if(obj != NULL && obj->userdata != NULL) {
+            begin_group(d, "har", i);
+            write_har(d, obj->userdata);
+        }
+    }
+
+    for(unsigned i = 0; i < vector_size(&gs->tracker.entries); i++) {
+        begin_group(d, "sound", i);
+        write_sound(d, vector_get(&gs->tracker.entries, i));
+    }
+}
+
+// -------- Hashing --------
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t hash_round(uint64_t acc, uint64_t input) {
+    acc += input * PRIME64_2;
+    acc = rotl64(acc, 31);
+    return acc * PRIME64_1;
+}
+
+static inline uint64_t hash_merge(uint64_t h, uint64_t lane) {
+    h ^= hash_round(0, lane);
+    return h * PRIME64_1 + PRIME64_4;
+}
+
+uint64_t state_digest_hash_words(const uint32_t *words, size_t count) {
+    // xxHash64 style: four independent lanes consume 32 byte stripes, so the main loop vectorizes well.
+    // Input words are combined as numbers rather than read from memory, so the hash is the same on all platforms.
+    uint64_t lanes[4] = {PRIME64_1 + PRIME64_2, PRIME64_2, 0, -PRIME64_1};
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        for(int l = 0; l < 4; l++) {
+            uint64_t input = (uint64_t)words[i + l * 2] | (uint64_t)words[i + l * 2 + 1] << 32;
+            lanes[l] = hash_round(lanes[l], input);
+        }
+    }
+
+    uint64_t h = rotl64(lanes[0], 1) + rotl64(lanes[1], 7) + rotl64(lanes[2], 12) + rotl64(lanes[3], 18);
+    for(int l = 0; l < 4; l++) {
+        h = hash_merge(h, lanes[l]);
+    }
+    h += (uint64_t)count * sizeof(uint32_t);
+
+    for(; i < count; i++) {
+        h ^= words[i] * PRIME64_1;
+        h = rotl64(h, 23) * PRIME64_2 + PRIME64_3;
+    }
+
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+uint64_t state_digest_hash(state_digest *d, game_state *gs) {
+    d->text = NULL;
+    write_state(d, gs);
+    return state_digest_hash_words(d->words, d->count);
+}
+
+void state_digest_dump(state_digest *d, game_state *gs, str *dst) {
+    d->text = dst;
+    write_state(d, gs);
+    d->text = NULL;
+}
+
+// -------- Diffing --------
+
+typedef struct dump_line {
+    const char *key;
+    size_t key_len;
+    const char *value;
+    size_t value_len;
+} dump_line;
+
+/**
+ * Split the next line of a dump to key and value. Returns false at the end of the dump.
+ */
+static bool next_line(const char **pos, dump_line *line) {
+    while(**pos != '\0') {
+        const char *start = *pos;
+        const char *end = strchr(start, '\n');
+        if(end == NULL) {
+            end = start + strlen(start);
+        }
+        *pos = (*end == '\n') ? end + 1 : end;
+
+        const char *eq = memchr(start, '=', end - start);
+        if(eq == NULL) {
+            continue; // Not a field line
+        }
+        line->key = start;
+        line->key_len = eq - start;
+        line->value = eq + 1;
+        line->value_len = end - eq - 1;
+        return true;
+    }
+    return false;
+}
+
+static void index_dump(hashmap *map, const str *dump) {
+    const char *pos = str_c(dump);
+    dump_line line;
+    while(next_line(&pos, &line)) {
+        hashmap_put(map, line.key, line.key_len, &line, sizeof(dump_line));
+    }
+}
+
+int state_digest_diff(const str *a, const str *b, str *dst) {
+    hashmap map_a, map_b;
+    hashmap_create(&map_a);
+    hashmap_create(&map_b);
+    index_dump(&map_a, a);
+    index_dump(&map_b, b);
+
+    int differences = 0;
+    const char *pos = str_c(a);
+    dump_line line;
+    dump_line *other;
+    while(next_line(&pos, &line)) {
+        if(hashmap_get(&map_b, line.key, line.key_len, (void **)&other, NULL) != 0) {
+            str_append_format(dst, "%.*s: %.*s != (missing)\n", (int)line.key_len, line.key, (int)line.value_len,
+                              line.value);
+            differences++;
+        } else if(line.value_len != other->value_len || memcmp(line.value, other->value, line.value_len) != 0) {
+            str_append_format(dst, "%.*s: %.*s != %.*s\n", (int)line.key_len, line.key, (int)line.value_len,
+                              line.value, (int)other->value_len, other->value);
+            differences++;
+        }
+    }
+
+    pos = str_c(b);
+    while(next_line(&pos, &line)) {
+        if(hashmap_get(&map_a, line.key, line.key_len, (void **)&other, NULL) != 0) {
+            str_append_format(dst, "%.*s: (missing) != %.*s\n", (int)line.key_len, line.key, (int)line.value_len,
+                              line.value);
+            differences++;
+        }
+    }
+
+    hashmap_free(&map_a);
+    hashmap_free(&map_b);
+    return differences;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file state_digest.h
+ * @brief Canonical serialization and hashing of the simulation state
+ * @details The simulation state (scene, RNG, every object in the game state, HAR and pilot data, and the sound
+ *          tracker) is walked in a fixed order, and every field is written out as a 32 bit word. The word stream
+ *          is hashed with a 64 bit, four lane hash, and is used for detecting desyncs between network peers.
+ *
+ *          The same walk can also produce a text dump with one "group[index].field=value" line per field. Two
+ *          dumps can be compared with state_digest_diff() to find the fields that differ.
+ *
+ *          Bump STATE_DIGEST_VERSION whenever fields are added, removed or reordered.
+ * @copyright MIT License
+ * @date 2026
+ * @author OpenOMF Project
+ */
+
+#ifndef STATE_DIGEST_H
+#define STATE_DIGEST_H
+
+#include "game/game_state_type.h"
+#include "utils/str.h"
+#include "utils/vector.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define STATE_DIGEST_VERSION 2
+
+/**
+ * @brief Slot of the object reference table. Maps an object ID to the position of the object in the walk.
+ */
+typedef struct state_digest_ref {
+    uint32_t id; ///< Object ID, or 0 if the slot is empty
+    int pos;     ///< Position of the object in the objects list
+} state_digest_ref;
+
+/**
+ * @brief Digest context. Keeps the buffers around, so that hashing does not allocate every tick.
+ */
+typedef struct state_digest {
+    uint32_t *words;        ///< Serialized state
+    size_t count;           ///< Number of words in use
+    size_t capacity;        ///< Number of words allocated
+    vector objects;         ///< Scratch list of object pointers
+    state_digest_ref *refs; ///< Open addressing table of object references, rebuilt on every walk
+    unsigned ref_capacity;  ///< Number of reference slots; always a power of two, or 0
+    str *text;         ///< Dump output, or NULL when only hashing
+    const char *group; ///< Group of the fields being written
+    int index;         ///< Index of the group, or -1 for groups that only exist once
+} state_digest;
+
+/**
+ * @brief Initialize a digest context.
+ * @param d Context to initialize
+ */
+void state_digest_create(state_digest *d);
+
+/**
+ * @brief Free the digest context buffers.
+ * @param d Context to free
+ */
+void state_digest_free(state_digest *d);
+
+/**
+ * @brief Serialize and hash the simulation state.
+ * @param d Digest context
+ * @param gs Game state to hash
+ * @return 64 bit hash of the state
+ */
+uint64_t state_digest_hash(state_digest *d, game_state *gs);
+
+/**
+ * @brief Write the simulation state as text, one field per line.
+ * @param d Digest context
+ * @param gs Game state to dump
+ * @param dst Created string to append the dump to
+ */
+void state_digest_dump(state_digest *d, game_state *gs, str *dst);
+
+/**
+ * @brief Hash a buffer of words. This is the hash state_digest_hash() uses for the serialized state.
+ * @param words Words to hash
+ * @param count Number of words
+ * @return 64 bit hash
+ */
+uint64_t state_digest_hash_words(const uint32_t *words, size_t count);
+
+/**
+ * @brief Compare two dumps made with state_digest_dump().
+ * @details Every differing field is written on its own line. Fields that exist in only one of the dumps are
+ *          listed as well, eg. when one side has an extra projectile.
+ * @param a First dump
+ * @param b Second dump
+ * @param dst Created string to append the differences to
+ * @return Number of differing fields
+ */
+int state_digest_diff(const str *a, const str *b, str *dst);
+
+/**
+ * @brief Fold a 64 bit hash to 32 bits, for places where only 32 bits fit.
+ */
+static inline uint32_t state_digest_fold(uint64_t hash) {
+    return (uint32_t)(hash >> 32) ^ (uint32_t)hash;
+}
+
+#endif // STATE_DIGEST_H
@@ -10,6 +10,7 @@
 #include "utils/c_array_util.h"
 #include "utils/c_string_util.h"
 #include "utils/log.h"
+#include "utils/miscmath.h"
 #include "utils/msgbox.h"
 #include "utils/random.h"
 
@@ -80,10 +81,17 @@ int main(int argc, char *argv[]) {
     struct arg_file *rec = arg_file0("R", "rec", "<file>", "Record a new recfile");
     struct arg_lit *warp = arg_lit0(NULL, "warp", "run the game at warp speed");
     struct arg_int *speed = arg_int0(NULL, "speed", "<speed>", "game speed to use: 1-10");
+    struct arg_lit *batch = arg_lit0(NULL, "batch", "run the simulation as fast as possible, without timing");
+    struct arg_int *render_every =
+        arg_int0(NULL, "render-every", "<n>", "in batch mode, render every nth tick (default: 0, never)");
+    struct arg_file *export_file =
+        arg_file0(NULL, "export", "<file>", "export a played recfile to .y4m or .png frames (- for stdout)");
+    struct arg_int *export_fps = arg_int0(NULL, "export-fps", "<fps>", "frame rate of the export (default: 60)");
     struct arg_str *log_level = arg_str0(NULL, "log-level", "<level>", "Log level (DEBUG, INFO, WARN, ERROR)");
     struct arg_end *end = arg_end(30);
-    void *argtable[] = {help,  vers, listen, lobby, lobbyarg, connect, force_audio_backend, force_renderer,
-                        trace, port, play,   rec,   warp,     speed,   log_level,           end};
+    void *argtable[] = {help,           vers,         listen,      lobby,      lobbyarg,  connect, force_audio_backend,
+                        force_renderer, trace,        port,        play,       rec,       warp,    speed,
+                        batch,          render_every, export_file, export_fps, log_level, end};
     const char *progname = "openomf";
 
     // Make sure everything got allocated
@@ -155,6 +163,25 @@ int main(int argc, char *argv[]) {
         init_flags.speed = -1;
     }
 
+    if(batch->count > 0) {
+        init_flags.batch = 1;
+    }
+    if(render_every->count > 0) {
+        init_flags.render_every = max2(render_every->ival[0], 0);
+    }
+    if(export_file->count > 0) {
+        if(play->count == 0) {
+            fprintf(stderr, "Error: --export requires a recfile to play (--play)\n");
+            goto exit_0;
+        }
+        // Exports always run in batch mode, and draw and mix using the headless backends unless told otherwise.
+        init_flags.batch = 1;
+        path_from_c(&init_flags.export_file, export_file->filename[0]);
+        init_flags.export_fps = export_fps->count > 0 ? clamp(export_fps->ival[0], 1, 1000) : 60;
+        strncpy_or_truncate(init_flags.force_renderer, "Software", sizeof(init_flags.force_renderer));
+        strncpy_or_truncate(init_flags.force_audio_backend, "Offline", sizeof(init_flags.force_audio_backend));
+    }
+
     if(force_renderer->count > 0) {
         strncpy_or_truncate(init_flags.force_renderer, force_renderer->sval[0], sizeof(init_flags.force_renderer));
     }
@@ -0,0 +1,342 @@
+#include "engine.h"
+#include "game/game_state.h"
+#include "game/utils/settings.h"
+#include "resources/resource_files.h"
+#include "resources/resource_paths.h"
+#include "utils/allocator.h"
+#include "utils/c_array_util.h"
+#include "utils/c_string_util.h"
+#include "utils/log.h"
+#include "utils/random.h"
+
+#include <SDL.h>
+#include <argtable3.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+typedef struct rectest_result {
+    uint64_t ticks; ///< Dynamic ticks simulated
+    double seconds; ///< Wall clock time spent on the playback
+} rectest_result;
+
+typedef struct rectest_job {
+    const char *filename;
+    bool should_fail;
+    bool passed;
+    rectest_result result;
+#ifndef _WIN32
+    pid_t pid;
+    int result_fd;
+    FILE *output;
+#endif
+} rectest_job;
+
+/**
+ * Play a single REC file to the end without any event loop or rendering. Game time is simulated,
+ * so ticks are scheduled in the same order as in engine_run, but as fast as the CPU allows.
+ * A failing REC assertion crashes the process.
+ */
+static bool rectest_play(const char *filename, rectest_result *result) {
+    engine_init_flags init_flags;
+    memset(&init_flags, 0, sizeof(init_flags));
+    init_flags.playback = 1;
+    init_flags.speed = 10;
+    path_from_c(&init_flags.rec_file, filename);
+
+    result->ticks = 0;
+    result->seconds = 0;
+    uint64_t start = SDL_GetPerformanceCounter();
+
+    game_state *gs = omf_calloc(1, sizeof(game_state));
+    if(game_state_create(gs, &init_flags)) {
+        game_state_free(&gs);
+        return false;
+    }
+
+    engine_sim_clock clock = {0};
+    while(game_state_is_running(gs)) {
+        if(engine_sim_step(&gs, &clock)) {
+            result->ticks++;
+        }
+    }
+    game_state_free(&gs);
+
+    result->seconds = (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+    return true;
+}
+
+static void rectest_report(const rectest_job *job) {
+    const char *status = job->passed ? "PASS" : "FAIL";
+    if(job->should_fail) {
+        status = job->passed ? "PASS (failed as expected)" : "FAIL (expected a failure)";
+    }
+    double tps = job->result.seconds > 0 ? job->result.ticks / job->result.seconds : 0;
+    printf("%-28s %s (%" PRIu64 " ticks, %.0f ticks/sec)\n", job->filename, status, job->result.ticks, tps);
+    fflush(stdout);
+}
+
+#ifndef _WIN32
+static bool rectest_start(rectest_job *job) {
+    int fds[2];
+    job->output = tmpfile();
+    if(job->output == NULL || pipe(fds) != 0) {
+        log_error("Unable to set up worker for %s: %s", job->filename, strerror(errno));
+        if(job->output) {
+            fclose(job->output);
+        }
+        return false;
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    job->pid = fork();
+    if(job->pid < 0) {
+        log_error("Unable to fork worker for %s: %s", job->filename, strerror(errno));
+        close(fds[0]);
+        close(fds[1]);
+        fclose(job->output);
+        return false;
+    }
+
+    if(job->pid == 0) {
+        // Worker process. Resources were loaded by the parent, and are shared copy-on-write.
+        close(fds[0]);
+        dup2(fileno(job->output), STDOUT_FILENO);
+        dup2(fileno(job->output), STDERR_FILENO);
+        rectest_result result;
+        bool ok = rectest_play(job->filename, &result);
+        if(ok && write(fds[1], &result, sizeof(result)) != sizeof(result)) {
+            ok = false;
+        }
+        fflush(NULL);
+        _exit(ok ? 0 : 1);
+    }
+
+    close(fds[1]);
+    job->result_fd = fds[0];
+    return true;
+}
+
+static void rectest_finish(rectest_job *job, int status) {
+    bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    if(ok && read(job->result_fd, &job->result, sizeof(job->result)) != sizeof(job->result)) {
+        ok = false;
+    }
+    close(job->result_fd);
+    job->passed = ok != job->should_fail;
+    rectest_report(job);
+
+    // Show the worker output for anything that did not go as expected.
+    if(!job->passed) {
+        char buf[1024];
+        size_t len;
+        rewind(job->output);
+        while((len = fread(buf, 1, sizeof(buf), job->output)) > 0) {
+            fwrite(buf, 1, len, stdout);
+        }
+        fflush(stdout);
+    }
+    fclose(job->output);
+}
+
+static void rectest_run_jobs(rectest_job *jobs, int count, int workers) {
+    int next = 0;
+    int running = 0;
+    while(next < count || running > 0) {
+        while(running < workers && next < count) {
+            rectest_job *job = &jobs[next++];
+            if(rectest_start(job)) {
+                running++;
+            } else {
+                job->passed = false;
+                rectest_report(job);
+            }
+        }
+        if(running == 0) {
+            continue;
+        }
+
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if(pid < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            log_error("waitpid failed: %s", strerror(errno));
+            return;
+        }
+        for(int i = 0; i < next; i++) {
+            if(jobs[i].pid == pid) {
+                rectest_finish(&jobs[i], status);
+                running--;
+                break;
+            }
+        }
+    }
+}
+#else
+static void rectest_run_jobs(rectest_job *jobs, int count, int workers) {
+    // No fork() here, so everything runs in this process. A failing assertion ends the whole run.
+    if(workers > 1) {
+        log_warn("Parallel workers are not supported on this platform; running sequentially.");
+    }
+    for(int i = 0; i < count; i++) {
+        bool ok = rectest_play(jobs[i].filename, &jobs[i].result);
+        jobs[i].passed = ok != jobs[i].should_fail;
+        rectest_report(&jobs[i]);
+    }
+}
+#endif
+
+int main(int argc, char *argv[]) {
+    int retval = 1;
+    engine_init_flags init_flags;
+    memset(&init_flags, 0, sizeof(init_flags));
+    strncpy_or_truncate(init_flags.force_renderer, "NULL", sizeof(init_flags.force_renderer));
+    strncpy_or_truncate(init_flags.force_audio_backend, "NULL", sizeof(init_flags.force_audio_backend));
+    // Workers are forked after engine_init(), and would not get any of the threads along.
+    init_flags.no_workers = 1;
+
+    struct arg_lit *help = arg_lit0("h", "help", "print this help and exit");
+    struct arg_int *workers = arg_int0("j", "jobs", "<n>", "Number of REC files to play in parallel (default: CPUs)");
+    struct arg_file *should_fail = arg_filen("x", "should-fail", "<file>", 0, 64, "REC file that is expected to fail");
+    struct arg_str *log_level = arg_str0(NULL, "log-level", "<level>", "Log level (DEBUG, INFO, WARN, ERROR)");
+    struct arg_file *config =
+        arg_file0("c", "config", "<file>", "Settings file to use (default: built-in defaults, not your own settings)");
+    struct arg_file *files = arg_filen(NULL, NULL, "<file>", 0, 1024, "REC files to play");
+    struct arg_end *end = arg_end(30);
+    void *argtable[] = {help, workers, should_fail, log_level, config, files, end};
+    const char *progname = "openomf_rectest";
+
+    // Make sure everything got allocated
+    if(arg_nullcheck(argtable) != 0) {
+        fprintf(stderr, "Error: insufficient memory\n");
+        goto exit_0;
+    }
+
+    // Parse arguments
+    int nerrors = arg_parse(argc, argv, argtable);
+
+    // Handle help
+    if(help->count > 0) {
+        fprintf(stderr, "Usage: %s", progname);
+        arg_print_syntax(stderr, argtable, "\n");
+        fprintf(stderr, "\nArguments:\n");
+        arg_print_glossary(stderr, argtable, "%-25s %s\n");
+        retval = 0;
+        goto exit_0;
+    }
+
+    // Handle errors
+    if(nerrors > 0) {
+        arg_print_errors(stderr, end, progname);
+        fprintf(stderr, "Try '%s --help' for more information.\n", progname);
+        goto exit_0;
+    }
+
+    int job_count = files->count + should_fail->count;
+    if(job_count == 0) {
+        fprintf(stderr, "No REC files given.\n");
+        goto exit_0;
+    }
+
+    // Init log
+    log_init();
+    log_set_colors(false);
+    log_add_stderr(LOG_INFO, false);
+    log_set_level(LOG_INFO);
+    if(log_level->count > 0) {
+        if(!is_log_level(log_level->sval[0])) {
+            fprintf(stderr, "Invalid loging level value %s\n", log_level->sval[0]);
+            goto exit_1;
+        }
+        log_set_level(log_level_text_to_enum(log_level->sval[0], LOG_INFO));
+    }
+
+    // Load file paths
+    if(!resource_path_init()) {
+        goto exit_1;
+    }
+    rand_seed(time(NULL));
+
+    // Init config. Results must not depend on whoever runs the tests, so the user's own settings file is never read.
+    // Settings are only read, never written back.
+    int settings_err = config->count > 0 ? settings_init(config->filename[0]) : settings_init_defaults();
+    if(settings_err) {
+        log_error("Failed to initialize settings");
+        goto exit_1;
+    }
+    settings_load();
+
+    if(SDL_Init(SDL_INIT_TIMER)) {
+        log_error("SDL2 Initialization failed: %s", SDL_GetError());
+        goto exit_2;
+    }
+
+    // Everything that can be shared between the REC files is loaded only once, here.
+    if(engine_init(&init_flags)) {
+        log_error("Failed to initialize game engine: %s", log_last_error());
+        goto exit_3;
+    }
+
+    rectest_job *jobs = omf_calloc(job_count, sizeof(rectest_job));
+    for(int i = 0; i < should_fail->count; i++) {
+        jobs[i].filename = should_fail->filename[i];
+        jobs[i].should_fail = true;
+    }
+    for(int i = 0; i < files->count; i++) {
+        jobs[should_fail->count + i].filename = files->filename[i];
+    }
+
+    int worker_count = workers->count > 0 ? workers->ival[0] : SDL_GetCPUCount();
+    if(worker_count < 1) {
+        worker_count = 1;
+    }
+
+    uint64_t start = SDL_GetPerformanceCounter();
+    rectest_run_jobs(jobs, job_count, worker_count);
+    double seconds = (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+
+    int fail_count = 0;
+    uint64_t total_ticks = 0;
+    for(int i = 0; i < job_count; i++) {
+        total_ticks += jobs[i].result.ticks;
+        if(!jobs[i].passed) {
+            fail_count++;
+        }
+    }
+    printf("\n%d/%d passed in %.2f seconds (%" PRIu64 " ticks, %.0f ticks/sec with %d workers)\n",
+           job_count - fail_count, job_count, seconds, total_ticks, seconds > 0 ? total_ticks / seconds : 0,
+           worker_count);
+    if(fail_count > 0) {
+        printf("Failed %d tests:", fail_count);
+        for(int i = 0; i < job_count; i++) {
+            if(!jobs[i].passed) {
+                printf(" %s", jobs[i].filename);
+            }
+        }
+        printf("\n");
+    }
+    omf_free(jobs);
+    retval = fail_count;
+
+    engine_close();
+exit_3:
+    SDL_Quit();
+exit_2:
+    settings_free();
+exit_1:
+    log_close();
+exit_0:
+    arg_freetable(argtable, N_ELEMENTS(argtable));
+    return retval;
+}
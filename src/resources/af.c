@@ -39,6 +39,9 @@ void af_create(af *a, void *src, str *name) {
     }
 
     modmanager_get_fighter_header(name, a);
+
+    af_move_matcher_create(&a->matcher);
+    af_move_matcher_build(&a->matcher, a);
 }
 
 af_move *af_get_move(const af *a, int id) {
@@ -55,4 +58,5 @@ void af_free(af *a) {
     }
     array_free(&a->moves);
     array_free(&a->sprites);
+    af_move_matcher_free(&a->matcher);
 }
@@ -2,6 +2,7 @@
 #define AF_H
 
 #include "resources/af_move.h"
+#include "resources/af_move_matcher.h"
 #include "utils/allocator.h"
 #include "utils/array.h"
 
@@ -15,6 +16,7 @@ typedef struct af_t {
     float fall_speed;
     array sprites;
     array moves;
+    af_move_matcher matcher; // move strings of moves, for fast matching against inputs
     char sound_translation_table[30];
 } af;
 
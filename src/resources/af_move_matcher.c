@@ -0,0 +1,130 @@
+#include "resources/af_move_matcher.h"
+#include "resources/af.h"
+
+#include <string.h>
+
+#define NO_NODE (-1)
+
+typedef struct move_node {
+    char c;          ///< Move string character leading to this node
+    int child;       ///< First child node, or NO_NODE
+    int sibling;     ///< Next sibling node, or NO_NODE
+    af_move_set end; ///< Moves whose move string ends at this node
+} move_node;
+
+static inline void move_set_add(af_move_set *set, int id) {
+    set->bits[id / 64] |= (uint64_t)1 << (id % 64);
+}
+
+static inline void move_set_union(af_move_set *dst, const af_move_set *src) {
+    for(int i = 0; i < AF_MOVE_SET_WORDS; i++) {
+        dst->bits[i] |= src->bits[i];
+    }
+}
+
+static int new_node(af_move_matcher *m, char c) {
+    move_node *node = vector_append_ptr(&m->nodes);
+    memset(node, 0, sizeof(move_node));
+    node->c = c;
+    node->child = NO_NODE;
+    node->sibling = NO_NODE;
+    return vector_size(&m->nodes) - 1;
+}
+
+static int find_child(const af_move_matcher *m, int parent, char c) {
+    const move_node *p = vector_get(&m->nodes, parent);
+    for(int i = p->child; i != NO_NODE;) {
+        const move_node *node = vector_get(&m->nodes, i);
+        if(node->c == c) {
+            return i;
+        }
+        i = node->sibling;
+    }
+    return NO_NODE;
+}
+
+static int get_or_add_child(af_move_matcher *m, int parent, char c) {
+    int found = find_child(m, parent, c);
+    if(found != NO_NODE) {
+        return found;
+    }
+    // new_node may move the node storage, so only fetch the parent after it.
+    int added = new_node(m, c);
+    move_node *p = vector_get(&m->nodes, parent);
+    move_node *node = vector_get(&m->nodes, added);
+    node->sibling = p->child;
+    p->child = added;
+    return added;
+}
+
+void af_move_matcher_create(af_move_matcher *m) {
+    vector_create(&m->nodes, sizeof(move_node));
+    memset(m->categories, 0, sizeof(m->categories));
+    new_node(m, '\0');
+}
+
+void af_move_matcher_free(af_move_matcher *m) {
+    vector_free(&m->nodes);
+}
+
+void af_move_matcher_build(af_move_matcher *m, const af *a) {
+    vector_clear(&m->nodes);
+    memset(m->categories, 0, sizeof(m->categories));
+    new_node(m, '\0');
+
+    for(int id = 0; id < MAX_AF_MOVES; id++) {
+        const af_move *move = af_get_move(a, id);
+        if(move == NULL) {
+            continue;
+        }
+        if(move->category < AF_MOVE_CATEGORIES) {
+            move_set_add(&m->categories[move->category], id);
+        }
+
+        size_t len = str_size(&move->move_string);
+        if(len == 0) {
+            continue;
+        }
+        const char *s = str_c(&move->move_string);
+        int node = 0;
+        for(size_t i = 0; i < len; i++) {
+            node = get_or_add_child(m, node, s[i]);
+        }
+        move_set_add(&((move_node *)vector_get(&m->nodes, node))->end, id);
+    }
+}
+
+void af_move_matcher_match(const af_move_matcher *m, char prefix, const char *inputs, af_move_set *out) {
+    memset(out, 0, sizeof(af_move_set));
+    int node = find_child(m, 0, prefix);
+    while(node != NO_NODE) {
+        move_set_union(out, &((const move_node *)vector_get(&m->nodes, node))->end);
+        if(*inputs == '\0') {
+            break;
+        }
+        node = find_child(m, node, *inputs++);
+    }
+}
+
+void af_move_matcher_category(const af_move_matcher *m, uint8_t category, af_move_set *out) {
+    if(category < AF_MOVE_CATEGORIES) {
+        *out = m->categories[category];
+    } else {
+        memset(out, 0, sizeof(af_move_set));
+    }
+}
+
+int af_move_set_next(const af_move_set *set, int from) {
+    for(int id = from; id < AF_MOVE_SET_WORDS * 64; id++) {
+        uint64_t word = set->bits[id / 64] >> (id % 64);
+        if(word == 0) {
+            // Nothing left in this word, skip to the next one.
+            id = (id / 64 + 1) * 64 - 1;
+            continue;
+        }
+        if(word & 1) {
+            return id;
+        }
+    }
+    return -1;
+}
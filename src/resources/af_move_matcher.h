@@ -0,0 +1,86 @@
+/**
+ * @file af_move_matcher.h
+ * @brief Precompiled lookup of HAR moves by move string
+ * @details Move strings are stored in a trie, so that all moves matching an input buffer can be found with a
+ *          single walk over the buffer, instead of comparing the buffer against every move string.
+ * @copyright MIT License
+ * @date 2026
+ * @author OpenOMF Project
+ */
+
+#ifndef AF_MOVE_MATCHER_H
+#define AF_MOVE_MATCHER_H
+
+#include "formats/af.h"
+#include "utils/vector.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define AF_MOVE_SET_WORDS ((MAX_AF_MOVES + 63) / 64)
+#define AF_MOVE_CATEGORIES 16 ///< Move categories above this are not tracked by af_move_matcher_category
+
+typedef struct af_t af;
+
+/**
+ * @brief Set of move IDs.
+ */
+typedef struct af_move_set {
+    uint64_t bits[AF_MOVE_SET_WORDS];
+} af_move_set;
+
+/**
+ * @brief Move string trie for a single AF file.
+ */
+typedef struct af_move_matcher {
+    vector nodes;                                ///< Trie nodes; the first node is the root
+    af_move_set categories[AF_MOVE_CATEGORIES]; ///< Moves by category
+} af_move_matcher;
+
+/**
+ * @brief Initialize an empty matcher.
+ * @param m Matcher to initialize
+ */
+void af_move_matcher_create(af_move_matcher *m);
+
+/**
+ * @brief Free the matcher.
+ * @param m Matcher to free
+ */
+void af_move_matcher_free(af_move_matcher *m);
+
+/**
+ * @brief (Re)build the matcher from the current move strings of an AF file.
+ * @details Must be called again if move strings are changed after loading.
+ * @param m Matcher to build
+ * @param a AF file to read the moves from
+ */
+void af_move_matcher_build(af_move_matcher *m, const af *a);
+
+/**
+ * @brief Find all moves whose move string is the prefix followed by a prefix of the input buffer.
+ * @details This matches the same moves as comparing each move string with strncmp().
+ * @param m Matcher to search
+ * @param prefix First character of the move string (the attack button)
+ * @param inputs NUL terminated input buffer, newest input first
+ * @param out Set of matching move IDs
+ */
+void af_move_matcher_match(const af_move_matcher *m, char prefix, const char *inputs, af_move_set *out);
+
+/**
+ * @brief Get all moves of a given category.
+ * @param m Matcher to search
+ * @param category Move category
+ * @param out Set of move IDs
+ */
+void af_move_matcher_category(const af_move_matcher *m, uint8_t category, af_move_set *out);
+
+/**
+ * @brief Find the next move ID in a set, in ascending order.
+ * @param set Set to search
+ * @param from First ID to consider
+ * @return Next ID in the set that is at least from, or -1 if there is none.
+ */
+int af_move_set_next(const af_move_set *set, int from);
+
+#endif // AF_MOVE_MATCHER_H
@@ -1,8 +1,10 @@
 #include "resources/animation.h"
 #include "formats/animation.h"
 #include "resources/modmanager.h"
+#include "resources/sprite_cache.h"
 #include "utils/allocator.h"
 #include "utils/log.h"
+#include <stdio.h>
 #include <stdlib.h>
 
 typedef struct sprite_reference_t {
@@ -54,12 +56,26 @@ void animation_create(animation_source type, str *name, animation *ani, array *s
         } else {
             tmp_sprite = omf_calloc(1, sizeof(sprite));
             sd_sprite *sp;
+            // HAR sprites are never modified after loading, so they can be shared between loads. Scenes draw on
+            // some of their BK sprites, so those are always private.
+            const bool cached = type == AF_ANIMATION && sprite_cache_enabled();
+            char key[64];
+            if(cached) {
+                snprintf(key, sizeof(key), "%s/%d/%d", str_c(name), ani->id, i);
+            }
             // TODO check the mod overrides for a replacement sprite
             if(modmanager_get_sprite(type, name, ani->id, i, &sp)) {
-                sprite_create(tmp_sprite, (void *)sp, i);
-                tmp_sprite->data->render_w = src_sprite->width;
-                tmp_sprite->data->render_h = src_sprite->height;
+                if(cached) {
+                    sprite_create_cached(tmp_sprite, (void *)sp, i, src_sprite->width, src_sprite->height, key);
+                } else {
+                    sprite_create(tmp_sprite, (void *)sp, i);
+                    tmp_sprite->data->render_w = src_sprite->width;
+                    tmp_sprite->data->render_h = src_sprite->height;
+                }
                 tmp_sprite->pos = src_sprite->pos;
+            } else if(cached) {
+                sprite_create_cached(tmp_sprite, (void *)src_sprite, i, src_sprite->render_width,
+                                     src_sprite->render_height, key);
             } else {
                 sprite_create(tmp_sprite, (void *)src_sprite, i);
             }
@@ -148,12 +164,13 @@ int animation_clone(animation *src, animation *dst) {
     foreach(it, tmp_str) {
         str_from(vector_append_ptr(&dst->extra_strings), tmp_str);
     }
+    // Sprites are shared with the source animation, and copied only if either animation modifies them.
     vector_create_with_size(&dst->sprites, sizeof(sprite_reference), vector_size(&src->sprites));
     vector_iter_begin(&src->sprites, &it);
     sprite_reference *spr = NULL;
     foreach(it, spr) {
         sprite_reference spr_clone;
-        spr_clone.sprite = sprite_copy(spr->sprite);
+        spr_clone.sprite = sprite_share(spr->sprite);
         vector_append(&dst->sprites, &spr_clone);
     }
 
@@ -162,12 +179,11 @@ int animation_clone(animation *src, animation *dst) {
 
 void animation_fixup_coordinates(animation *ani, int fix_x, int fix_y) {
     iterator it;
-    sprite_reference *spr;
     // Fix sprite positions
-    vector_iter_begin(&ani->sprites, &it);
-    foreach(it, spr) {
-        spr->sprite->pos.x += fix_x;
-        spr->sprite->pos.y += fix_y;
+    for(int i = 0; i < animation_get_sprite_count(ani); i++) {
+        sprite *sp = animation_get_sprite_writable(ani, i);
+        sp->pos.x += fix_x;
+        sp->pos.y += fix_y;
     }
     // Fix collisions coordinates
     collision_coord *c;
@@ -186,6 +202,19 @@ sprite *animation_get_sprite(animation *ani, int sprite_id) {
     return s->sprite;
 }
 
+sprite *animation_get_sprite_writable(animation *ani, int sprite_id) {
+    sprite_reference *s = (sprite_reference *)vector_get(&ani->sprites, sprite_id);
+    if(s == NULL) {
+        return NULL;
+    }
+    if(sprite_is_shared(s->sprite)) {
+        sprite *copy = sprite_copy(s->sprite);
+        sprite_release(s->sprite);
+        s->sprite = copy;
+    }
+    return s->sprite;
+}
+
 int animation_get_sprite_count(animation *ani) {
     return vector_size(&ani->sprites);
 }
@@ -210,8 +239,7 @@ void animation_free(animation *ani) {
     vector_iter_begin(&ani->sprites, &it);
     sprite_reference *spr;
     foreach(it, spr) {
-        sprite_free(spr->sprite);
-        omf_free(spr->sprite);
+        sprite_release(spr->sprite);
     }
 
     vector_free(&ani->sprites);
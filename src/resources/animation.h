@@ -54,6 +54,12 @@ typedef struct animation_t {
 
 void animation_create(animation_source type, str *name, animation *ani, array *sprites, void *src, int id);
 sprite *animation_get_sprite(animation *ani, int sprite_id);
+
+/**
+ * Get a sprite for modification. If the sprite is shared with a cloned animation, it is replaced with a private copy
+ * first.
+ */
+sprite *animation_get_sprite_writable(animation *ani, int sprite_id);
 void animation_free(animation *ani);
 
 int animation_get_sprite_count(animation *ani);
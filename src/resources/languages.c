@@ -2,6 +2,7 @@
 
 #include "formats/error.h"
 #include "formats/language.h"
+#include "game/gui/text/text_markup.h"
 #include "game/utils/settings.h"
 #include "resource_files.h"
 #include "utils/allocator.h"
@@ -13,6 +14,8 @@
 
 static sd_language *language = NULL;
 static sd_language *language2 = NULL;
+// Compiled on first use by lang_get_markup(). The last slot is shared by all unsupported ids.
+static text_markup *markups[LANG_STR_COUNT + 1];
 
 // Fall back to the default language if the configured one does not resolve.
 static void ensure_valid_language_setting(settings_language *lang_settings) {
@@ -102,6 +105,12 @@ error_0:
 }
 
 void lang_close(void) {
+    for(unsigned int i = 0; i <= LANG_STR_COUNT; i++) {
+        if(markups[i] != NULL) {
+            text_markup_free(markups[i]);
+            omf_free(markups[i]);
+        }
+    }
     sd_language_free(language);
     omf_free(language);
     sd_language_free(language2);
@@ -125,3 +134,15 @@ const char *lang_get2(unsigned int id) {
     }
     return str_c(&entry->data);
 }
+
+const text_markup *lang_get_markup(unsigned int id) {
+    const unsigned int slot = id < LANG_STR_COUNT ? id : LANG_STR_COUNT;
+    if(markups[slot] == NULL) {
+        str src;
+        str_from_c(&src, lang_get(id));
+        markups[slot] = omf_calloc(1, sizeof(text_markup));
+        text_markup_create(markups[slot], &src);
+        str_free(&src);
+    }
+    return markups[slot];
+}
@@ -3,6 +3,8 @@
 
 #include <stdbool.h>
 
+#include "game/gui/text/text_markup.h"
+
 /*
  * This file should handle loading language file(s)
  * and support getting text. Maybe some function to rendering text index on
@@ -45,5 +47,7 @@ enum
 const char *lang_get(unsigned int id);
 // Gets an openomf localization string
 const char *lang_get2(unsigned int id);
+// Gets an OMF 2097 localization string with its markup compiled, for text_generate_markup_document()
+const text_markup *lang_get_markup(unsigned int id);
 
 #endif // LANGUAGES_H
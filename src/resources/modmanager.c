@@ -11,8 +11,11 @@
 #include "utils/miscmath.h"
 #include "vendored/zip/zip.h"
 #include "video/vga_palette.h"
+#include <SDL.h>
+#include <ctype.h>
 #include <errno.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #ifdef OPUSFILE_FOUND
@@ -60,6 +63,12 @@ int find_scale_factor(void) {
 }
 
 static hashmap mod_resources;
+static vector mod_zips;        // Open mod files, images are read from them when first used
+static SDL_mutex *asset_lock;  // Images may be loaded by the preloader thread and the main thread at once
+static SDL_cond *asset_loaded; // Signaled when an image has been decoded
+static hashmap mod_names;      // Fighter and scene names that have animation frame images, to their id
+static hashmap mod_sprites;    // Animation frame images by sprite_key
+static int common_name_id;     // Id of the "common" name, or -1
 static bool mods_allowed = true;
 
 void modmanager_set_allowed(bool allowed) {
@@ -77,6 +86,28 @@ typedef enum
     MOD_BUFFER
 } asset_type;
 
+#define MAX_NAME_LEN 32
+
+// Index key of an animation frame image. Hashed as raw bytes, so there must not be any padding.
+typedef struct {
+    uint32_t name_id;   // Fighter or scene name, from mod_names
+    uint16_t animation; // Animation id
+    uint16_t frame;     // Frame (sprite) index
+    uint8_t source;     // animation_source
+    uint8_t scale;      // Scale factor, or 0 for the unscaled image
+    uint8_t hitcoords;  // 1 for the hitcoord overlay
+    uint8_t unused;
+} sprite_key;
+
+// decoding state of images, which are only decoded when first used
+typedef enum
+{
+    ASSET_UNLOADED,
+    ASSET_LOADING,
+    ASSET_READY,
+    ASSET_FAILED
+} asset_state;
+
 // Manifest structure to track mod information
 typedef struct {
     char *name;     /* Unique name of the mod */
@@ -101,7 +132,11 @@ static void free_manifest_fields(void *data) {
 typedef struct {
     asset_type type;
     size_t size;
-    vga_palette *pal; // only used for sprites/images
+    vga_palette *pal;  // only used for sprites/images
+    asset_state state; // only used for sprites/images
+    bool hitcoords;    // image is a hitcoord overlay, which has no palette
+    struct zip_t *zip; // mod file the image is in
+    size_t entry;      // index of the image in the mod file
     union {
         unsigned char *buf;
         sd_vga_image img;
@@ -109,6 +144,192 @@ typedef struct {
     };
 } mod_asset;
 
+// Decode an image read from a mod file. Called without holding the asset lock.
+static bool decode_image(mod_asset *asset, const void *buf, size_t size) {
+    if(asset->type == MOD_VGA_IMAGE) {
+        if(!asset->hitcoords) {
+            asset->pal = omf_calloc(1, sizeof(vga_palette));
+        }
+        return sd_vga_image_from_png_in_memory(&asset->img, buf, size, asset->hitcoords, asset->pal) == SD_SUCCESS;
+    }
+
+    sd_vga_image img;
+    asset->pal = omf_calloc(1, sizeof(vga_palette));
+    if(sd_vga_image_from_png_in_memory(&img, buf, size, true, asset->pal) != SD_SUCCESS) {
+        return false;
+    }
+    bool ok = sd_sprite_vga_encode(&asset->spr, &img) == SD_SUCCESS;
+    sd_vga_image_free(&img);
+    return ok;
+}
+
+// Decode an image if this is the first time it is used.
+// Returns NULL if the image could not be decoded.
+static mod_asset *load_image(mod_asset *asset) {
+    SDL_LockMutex(asset_lock);
+    while(asset->state == ASSET_LOADING) {
+        SDL_CondWait(asset_loaded, asset_lock);
+    }
+    if(asset->state == ASSET_UNLOADED) {
+        // Reading from the mod file must be done under the lock, but decoding can run in parallel.
+        asset->state = ASSET_LOADING;
+        char entry_name[PATH_MAX_LENGTH] = "";
+        void *buf = NULL;
+        size_t size = 0;
+        if(zip_entry_openbyindex(asset->zip, asset->entry) == 0) {
+            snprintf(entry_name, sizeof(entry_name), "%s", zip_entry_name(asset->zip));
+            size = zip_entry_uncomp_size(asset->zip);
+            buf = omf_calloc(size, 1);
+            if(zip_entry_noallocread(asset->zip, buf, size) < 0) {
+                omf_free(buf);
+            }
+            zip_entry_close(asset->zip);
+        }
+        SDL_UnlockMutex(asset_lock);
+
+        bool ok = buf != NULL && decode_image(asset, buf, size);
+        omf_free(buf);
+        if(ok) {
+            log_info("decoded mod image %s", entry_name);
+        } else {
+            log_warn("failed to load mod image %s", entry_name);
+            omf_free(asset->pal);
+        }
+
+        SDL_LockMutex(asset_lock);
+        asset->state = ok ? ASSET_READY : ASSET_FAILED;
+        SDL_CondBroadcast(asset_loaded);
+    }
+    mod_asset *found = asset->state == ASSET_READY ? asset : NULL;
+    SDL_UnlockMutex(asset_lock);
+    return found;
+}
+
+// Find an image by its file name in the mod, and decode it if this is the first time it is used.
+// Returns NULL if there is no such image, or if it could not be decoded.
+static mod_asset *get_image(const char *filename) {
+    mod_asset *asset;
+    if(hashmap_get_str(&mod_resources, filename, (void **)&asset, NULL)) {
+        return NULL;
+    }
+    return load_image(asset);
+}
+
+// Find an animation frame image from the sprite index.
+// Returns NULL if there is no such image, or if it could not be decoded.
+static mod_asset *get_frame_image(int name_id, animation_source source, int animation, int frame, int scale,
+                                  bool hitcoords) {
+    if(name_id < 0) {
+        return NULL;
+    }
+    sprite_key key;
+    memset(&key, 0, sizeof(sprite_key));
+    key.name_id = name_id;
+    key.animation = animation;
+    key.frame = frame;
+    key.source = source;
+    key.scale = scale;
+    key.hitcoords = hitcoords;
+    mod_asset **asset;
+    if(hashmap_get(&mod_sprites, &key, sizeof(sprite_key), (void **)&asset, NULL)) {
+        return NULL;
+    }
+    return load_image(*asset);
+}
+
+// Find the index id of a fighter or scene name, eg. "FIGHTR0". Returns -1 if no mod has images for it.
+static int find_name_id(const str *name) {
+    char lower[MAX_NAME_LEN];
+    const size_t len = str_size(name);
+    if(len >= sizeof(lower)) {
+        return -1;
+    }
+    for(size_t i = 0; i < len; i++) {
+        lower[i] = tolower((unsigned char)str_c(name)[i]);
+    }
+    lower[len] = '\0';
+    int *id;
+    if(hashmap_get_str(&mod_names, lower, (void **)&id, NULL)) {
+        return -1;
+    }
+    return *id;
+}
+
+// Parse an animation frame image name, one of
+//   fighters|scenes/<name>/<animation>/<frame>.png
+//   fighters|scenes/<name>/<animation>/<frame>-<scale>x.png
+//   fighters|scenes/<name>/<animation>/<frame>-hitcoords.png
+static bool parse_frame_filename(const char *filename, sprite_key *key, char *name) {
+    char dir[16];
+    int animation;
+    int consumed = 0;
+    if(sscanf(filename, "%15[^/]/%31[^/]/%d/%n", dir, name, &animation, &consumed) != 3 || consumed == 0) {
+        return false;
+    }
+    if(strcmp(dir, "fighters") == 0) {
+        key->source = AF_ANIMATION;
+    } else if(strcmp(dir, "scenes") == 0) {
+        key->source = BK_ANIMATION;
+    } else {
+        return false;
+    }
+
+    const char *rest = filename + consumed;
+    char *end;
+    long frame = strtol(rest, &end, 10);
+    if(end == rest || animation < 0 || animation > UINT16_MAX || frame < 0 || frame > UINT16_MAX) {
+        return false;
+    }
+    key->animation = animation;
+    key->frame = frame;
+    if(strcmp(end, ".png") == 0) {
+        return true;
+    }
+    if(strcmp(end, "-hitcoords.png") == 0) {
+        key->hitcoords = 1;
+        return true;
+    }
+    if(*end == '-') {
+        const char *scale_str = end + 1;
+        long scale = strtol(scale_str, &end, 10);
+        if(end != scale_str && scale > 0 && scale <= UINT8_MAX && strcmp(end, "x.png") == 0) {
+            key->scale = scale;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Index all animation frame images, so that they can be found without formatting their file names.
+static void index_frame_images(void) {
+    iterator it;
+    hashmap_pair *pair;
+    hashmap_iter_begin(&mod_resources, &it);
+    foreach(it, pair) {
+        sprite_key key;
+        char name[MAX_NAME_LEN];
+        memset(&key, 0, sizeof(sprite_key));
+        if(!parse_frame_filename((const char *)pair->key, &key, name)) {
+            continue;
+        }
+
+        int *id;
+        if(hashmap_get_str(&mod_names, name, (void **)&id, NULL)) {
+            int new_id = hashmap_size(&mod_names);
+            id = hashmap_put(&mod_names, name, strlen(name) + 1, &new_id, sizeof(int));
+        }
+        key.name_id = *id;
+
+        mod_asset *asset = pair->value;
+        hashmap_put(&mod_sprites, &key, sizeof(sprite_key), &asset, sizeof(mod_asset *));
+    }
+
+    int *id;
+    common_name_id = hashmap_get_str(&mod_names, "common", (void **)&id, NULL) == 0 ? *id : -1;
+    log_info("indexed %d animation frame images from %d fighters and scenes", hashmap_size(&mod_sprites),
+             hashmap_size(&mod_names));
+}
+
 int mod_find(list *mod_list) {
     size_t size = 0;
     path scan = get_system_mod_directory();
@@ -348,6 +569,12 @@ static void mod_sort(hashmap *mod_registry, list *sorted_list) {
 bool modmanager_init(void) {
 
     hashmap_create(&mod_resources);
+    vector_create(&mod_zips, sizeof(struct zip_t *));
+    hashmap_create(&mod_names);
+    hashmap_create(&mod_sprites);
+    common_name_id = -1;
+    asset_lock = SDL_CreateMutex();
+    asset_loaded = SDL_CreateCond();
     list dir_list;
     list_create(&dir_list);
     mod_find(&dir_list);
@@ -389,13 +616,6 @@ bool modmanager_init(void) {
                         continue;
                     }
 
-                    unsigned long long entry_size = zip_entry_uncomp_size(zip);
-                    void *entry_buf = omf_calloc(entry_size, 1);
-                    if(zip_entry_noallocread(zip, entry_buf, entry_size) < 0) {
-                        log_warn("failed to load %s into memory", zip_entry_name(zip));
-                        continue;
-                    }
-
                     path p2;
                     str fn, ext;
                     path_from_str(&p2, &filename);
@@ -405,74 +625,37 @@ bool modmanager_init(void) {
 
                     log_info("path %s has filename %s and extension %s", str_c(&filename), str_c(&fn), str_c(&ext));
 
-                    if(str_ends_with(&filename, "-hitcoords.png")) {
-                        // parse as hitcoord overlay (raw VGA image with 3 layers)
-                        mod_asset *buf = omf_calloc(1, sizeof(mod_asset));
-                        buf->type = MOD_VGA_IMAGE;
-                        buf->pal = NULL;
-
-                        if(sd_vga_image_from_png_in_memory(&buf->img, entry_buf, entry_size, true, NULL) ==
-                           SD_SUCCESS) {
-                            log_info("got hitcoord overlay %dx%d", buf->img.w, buf->img.h);
-                            hashmap_put_str(&mod_resources, str_c(&filename), buf, sizeof(mod_asset));
-                            omf_free(buf);
+                    if(str_equal_c(&ext, ".png")) {
+                        // Only remember where the image is, it is decoded when it is first used. Images in mods
+                        // that load later replace the earlier ones.
+                        mod_asset asset;
+                        memset(&asset, 0, sizeof(mod_asset));
+                        asset.hitcoords = str_ends_with(&filename, "-hitcoords.png");
+                        if(asset.hitcoords || str_equal_c(&fn, "background.png")) {
+                            // hitcoord overlay (raw VGA image with 3 layers) or background image
+                            asset.type = MOD_VGA_IMAGE;
                         } else {
-                            log_warn("failed to load hitcoord overlay %s", str_c(&filename));
-                            omf_free(buf);
+                            asset.type = MOD_SPRITE;
                         }
-                    } else if(str_equal_c(&fn, "background.png")) {
-                        // parse as background image
-                        mod_asset *buf = omf_calloc(1, sizeof(mod_asset));
-                        buf->type = MOD_VGA_IMAGE;
-                        buf->pal = omf_calloc(1, sizeof(vga_palette)); // Allocate memory for palette
-
-                        if(sd_vga_image_from_png_in_memory(&buf->img, entry_buf, entry_size, false, buf->pal) ==
-                           SD_SUCCESS) {
-                            mod_asset *existing;
-                            unsigned int existing_len;
-                            if(!hashmap_get_str(&mod_resources, str_c(&filename), (void **)&existing, &existing_len)) {
-                                // free existing entry
-                                free_mod_asset(existing);
-                            }
+                        asset.state = ASSET_UNLOADED;
+                        asset.zip = zip;
+                        asset.entry = i;
+                        hashmap_put_str(&mod_resources, str_c(&filename), &asset, sizeof(mod_asset));
+                        str_free(&fn);
+                        str_free(&ext);
+                        str_free(&filename);
+                        zip_entry_close(zip);
+                        continue;
+                    }
 
-                            log_info("got vga image %dx%d", buf->img.w, buf->img.h);
+                    unsigned long long entry_size = zip_entry_uncomp_size(zip);
+                    void *entry_buf = omf_calloc(entry_size, 1);
+                    if(zip_entry_noallocread(zip, entry_buf, entry_size) < 0) {
+                        log_warn("failed to load %s into memory", zip_entry_name(zip));
+                        continue;
+                    }
 
-                            hashmap_put_str(&mod_resources, str_c(&filename), buf, sizeof(mod_asset));
-                            omf_free(buf);
-                        } else {
-                            log_warn("failed to load background image %s", str_c(&filename));
-                            omf_free(buf->pal);
-                            omf_free(buf);
-                        }
-                    } else if(str_equal_c(&ext, ".png")) {
-                        // parse as sprite
-                        sd_vga_image img;
-                        mod_asset *buf = omf_calloc(1, sizeof(mod_asset));
-                        buf->type = MOD_SPRITE;
-                        buf->pal = omf_calloc(1, sizeof(vga_palette)); // Allocate memory for palette
-
-                        if(sd_vga_image_from_png_in_memory(&img, entry_buf, entry_size, true, buf->pal) == SD_SUCCESS) {
-                            if(sd_sprite_vga_encode(&buf->spr, &img) == SD_SUCCESS) {
-                                mod_asset *existing;
-                                unsigned int existing_len;
-                                if(!hashmap_get_str(&mod_resources, str_c(&filename), (void **)&existing,
-                                                    &existing_len)) {
-                                    // free existing entry
-                                    free_mod_asset(existing);
-                                }
-                                hashmap_put_str(&mod_resources, str_c(&filename), buf, sizeof(mod_asset));
-                                omf_free(buf);
-                            } else {
-                                log_warn("failed to load sprite %s", str_c(&filename));
-                                omf_free(buf->pal);
-                                omf_free(buf);
-                            }
-                            sd_vga_image_free(&img);
-                        } else {
-                            omf_free(buf->pal);
-                            omf_free(buf);
-                        }
-                    } else if(str_equal_c(&ext, ".ini")) {
+                    if(str_equal_c(&ext, ".ini")) {
                         list *l;
                         unsigned int len;
                         char *ini_buf = omf_calloc(1, entry_size + 1);
@@ -523,16 +706,22 @@ bool modmanager_init(void) {
                     }
 
                     omf_free(entry_buf);
+                    str_free(&fn);
+                    str_free(&ext);
                     str_free(&filename);
                 }
                 zip_entry_close(zip);
             }
+            // Keep the mod open, images are read from it later.
+            vector_append(&mod_zips, &zip);
         } else {
             log_warn("mod %s has no contents", path_c(p));
+            zip_close(zip);
         }
-        zip_close(zip);
     }
 
+    index_frame_images();
+
     list_free(&mod_list);
     list_free(&dir_list);
     return true;
@@ -543,13 +732,12 @@ bool modmanager_get_bk_background(str *name, sd_vga_image **img) {
     str_from_format(&filename, "scenes/%s/background.png", str_c(name));
     str_tolower(&filename);
 
-    unsigned int len;
     bool found = false;
     mod_asset *obuf;
-    if(!hashmap_get_str(&mod_resources, str_c(&filename), (void **)&obuf, &len)) {
+    if((obuf = get_image(str_c(&filename))) != NULL) {
         assert(obuf->type == MOD_VGA_IMAGE);
         *img = &obuf->img;
-        log_info("got vga image %dx%d with size %d", (*img)->w, (*img)->h, len);
+        log_info("got vga image %dx%d", (*img)->w, (*img)->h);
         found = true;
     }
     str_free(&filename);
@@ -560,84 +748,46 @@ bool modmanager_get_sprite(animation_source source, str *name, int animation, in
     if(!mods_allowed) {
         return false;
     }
-    str filename;
-
-    int scale = find_scale_factor();
+    if(source != AF_ANIMATION && source != BK_ANIMATION) {
+        return false;
+    }
 
-    bool found = false;
+    // Common replacements should replace default assets, but not modded ones
+    int common_id = -1;
+    if(omf_strncasecmp("arena", str_c(name), min2(str_size(name), 5)) == 0 && source == BK_ANIMATION &&
+       ((animation >= 6 && animation <= 11) || (animation >= 24 && animation <= 27))) {
+        // TODO make sure this is an arena
+        // For arenas, check for 'common' for animations 6 (round), 7 (number), 8 (you lose), 9 (you win), 10
+        // (fight), 11 (ready), 24 (dust 1), 25 (dust 2), 26 (dust 3), 27 (match counters)
+        common_id = common_name_id;
+    } else if(source == AF_ANIMATION && (animation == 7 || animation == 8 || (animation >= 12 && animation <= 14) ||
+                                         (animation >= 55 && animation <= 57))) {
+        // For fighters, check for 'common' for animations 7 (burning oil/stun), 8 (blocking scrape), 12 (scrap), 13
+        // (bolt), 14 (screw), 55 (blast), 56 (blast 2), 57 (blast 3)
+        common_id = common_name_id;
+    }
 
-    for(int i = scale; i >= 0 && !found; i--) {
+    const int name_id = find_name_id(name);
+    if(name_id < 0 && common_id < 0) {
+        return false;
+    }
 
-        mod_asset *obuf;
-        switch(source) {
-            case AF_ANIMATION:
-                if(i > 0) {
-                    str_from_format(&filename, "fighters/%s/%d/%d-%dx.png", str_c(name), animation, frame, i);
-                } else {
-                    str_from_format(&filename, "fighters/%s/%d/%d.png", str_c(name), animation, frame);
-                }
-                break;
-            case BK_ANIMATION:
-                if(i > 0) {
-                    str_from_format(&filename, "scenes/%s/%d/%d-%dx.png", str_c(name), animation, frame, i);
-                } else {
-                    str_from_format(&filename, "scenes/%s/%d/%d.png", str_c(name), animation, frame);
-                }
-                break;
-            default:
-                return false;
+    int scale = find_scale_factor();
+    for(int i = scale; i >= 0; i--) {
+        mod_asset *obuf = get_frame_image(name_id, source, animation, frame, i, false);
+        if(obuf == NULL) {
+            obuf = get_frame_image(common_id, source, animation, frame, i, false);
         }
-
-        str_tolower(&filename);
-
-        unsigned int len;
-        if(!hashmap_get_str(&mod_resources, str_c(&filename), (void **)&obuf, &len)) {
+        if(obuf != NULL) {
             assert(obuf->type == MOD_SPRITE);
             *spr = &obuf->spr;
-            log_info("got sprite %s %dx%d with scale %d", str_c(&filename), (*spr)->width, (*spr)->height, i);
-            str_free(&filename);
+            log_info("got sprite %s/%d/%d %dx%d with scale %d", str_c(name), animation, frame, (*spr)->width,
+                     (*spr)->height, i);
             return true;
         }
-
-        str_free(&filename);
-
-        // Common replacements should replace default assets, but not modded ones
-        if(omf_strncasecmp("arena", str_c(name), min2(str_size(name), 5)) == 0 && source == BK_ANIMATION &&
-           ((animation >= 6 && animation <= 11) || (animation >= 24 && animation <= 27))) {
-            // TODO make sure this is an arena
-            // For arenas, check for 'common' for animations 6 (round), 7 (number), 8 (you lose), 9 (you win), 10
-            // (fight), 11 (ready), 24 (dust 1), 25 (dust 2), 26 (dust 3), 27 (match counters)
-
-            if(i > 0) {
-                str_from_format(&filename, "scenes/common/%d/%d-%dx.png", animation, frame, i);
-            } else {
-                str_from_format(&filename, "scenes/common/%d/%d.png", animation, frame);
-            }
-        } else if(source == AF_ANIMATION && (animation == 7 || animation == 8 || (animation >= 12 && animation <= 14) ||
-                                             (animation >= 55 && animation <= 57))) {
-            // For fighters, check for 'common' for animations 7 (burning oil/stun), 8 (blocking scrape), 12 (scrap), 13
-            // (bolt), 14 (screw), 55 (blast), 56 (blast 2), 57 (blast 3)
-
-            if(i > 0) {
-                str_from_format(&filename, "fighters/common/%d/%d-%dx.png", animation, frame, i);
-            } else {
-                str_from_format(&filename, "fighters/common/%d/%d.png", animation, frame);
-            }
-        } else {
-            continue;
-        }
-
-        if(!hashmap_get_str(&mod_resources, str_c(&filename), (void **)&obuf, &len)) {
-            assert(obuf->type == MOD_SPRITE);
-            *spr = &obuf->spr;
-            log_info("got sprite %s %dx%d with scale %d", str_c(&filename), (*spr)->width, (*spr)->height, i);
-            found = true;
-        }
-
-        str_free(&filename);
     }
 
-    return found;
+    return false;
 }
 
 bool modmanager_get_hitcoords(animation_source source, str *name, int animation, int frame, vector *coords,
@@ -645,27 +795,14 @@ bool modmanager_get_hitcoords(animation_source source, str *name, int animation,
     if(!mods_allowed) {
         return false;
     }
-
-    str filename;
-    switch(source) {
-        case AF_ANIMATION:
-            str_from_format(&filename, "fighters/%s/%d/%d-hitcoords.png", str_c(name), animation, frame);
-            break;
-        case BK_ANIMATION:
-            str_from_format(&filename, "scenes/%s/%d/%d-hitcoords.png", str_c(name), animation, frame);
-            break;
-        default:
-            return false;
+    if(source != AF_ANIMATION && source != BK_ANIMATION) {
+        return false;
     }
-    str_tolower(&filename);
 
-    unsigned int len;
-    mod_asset *obuf;
-    if(hashmap_get_str(&mod_resources, str_c(&filename), (void **)&obuf, &len)) {
-        str_free(&filename);
+    mod_asset *obuf = get_frame_image(find_name_id(name), source, animation, frame, 0, true);
+    if(obuf == NULL) {
         return false;
     }
-    str_free(&filename);
 
     assert(obuf->type == MOD_VGA_IMAGE);
     sd_vga_image *img = &obuf->img;
@@ -1391,7 +1528,7 @@ bool modmanager_get_pilot_mod(const char *trn_name, uint8_t pilot_id, sd_pilot *
     str_from_format(&filename, "tournaments/%s/pilots/%d/pilot.png", trn_name, pilot_id);
     str_tolower(&filename);
     mod_asset *obuf;
-    if(!hashmap_get_str(&mod_resources, str_c(&filename), (void **)&obuf, &len)) {
+    if((obuf = get_image(str_c(&filename))) != NULL) {
         assert(obuf->type == MOD_SPRITE);
         log_info("found portrait for pilot %d in %s", pilot_id, trn_name);
         if(pilot_data->photo) {
@@ -1409,7 +1546,7 @@ bool modmanager_get_pilot_mod(const char *trn_name, uint8_t pilot_id, sd_pilot *
     str_tolower(&filename);
 
     // copy HAR color palette, if exists
-    if(!hashmap_get_str(&mod_resources, str_c(&filename), (void **)&obuf, &len)) {
+    if((obuf = get_image(str_c(&filename))) != NULL) {
         assert(obuf->type == MOD_SPRITE);
         palette_copy(&pilot_data->palette, obuf->pal, 0, 48);
     }
@@ -1639,7 +1776,7 @@ bool modmanager_get_tournament_mod(const char *tournament_name, sd_tournament_fi
     str_from_format(&filename, "tournaments/%s/logos/logo.png", tournament_name);
     str_tolower(&filename);
     mod_asset *obuf;
-    if(!hashmap_get_str(&mod_resources, str_c(&filename), (void **)&obuf, &len)) {
+    if((obuf = get_image(str_c(&filename))) != NULL) {
         assert(obuf->type == MOD_SPRITE);
         sd_sprite_free(tourn_data->locales[0]->logo);
         sd_sprite_copy(tourn_data->locales[0]->logo, &obuf->spr);
@@ -1667,10 +1804,14 @@ static void free_mod_asset(void *data) {
         // Free other resources based on type
         switch(asset->type) {
             case MOD_VGA_IMAGE:
-                sd_vga_image_free(&asset->img);
+                if(asset->state == ASSET_READY) {
+                    sd_vga_image_free(&asset->img);
+                }
                 break;
             case MOD_SPRITE:
-                sd_sprite_free(&asset->spr);
+                if(asset->state == ASSET_READY) {
+                    sd_sprite_free(&asset->spr);
+                }
                 break;
             case MOD_BUFFER:
                 if(asset->buf) {
@@ -1744,6 +1885,18 @@ void modmanager_shutdown(void) {
         str_free(&key);
     }
     hashmap_free(&mod_resources);
+    hashmap_free(&mod_names);
+    hashmap_free(&mod_sprites);
+
+    iterator zip_it;
+    struct zip_t **zip;
+    vector_iter_begin(&mod_zips, &zip_it);
+    foreach(zip_it, zip) {
+        zip_close(*zip);
+    }
+    vector_free(&mod_zips);
+    SDL_DestroyCond(asset_loaded);
+    SDL_DestroyMutex(asset_lock);
 }
 
 bool modmanager_get_player_pics(sd_pic_file *players) {
@@ -1761,7 +1914,7 @@ bool modmanager_get_player_pics(sd_pic_file *players) {
         // Check for png replacement
         str_from_format(&filename, "players/%i/pilot.png", i);
         mod_asset *obuf;
-        if(!hashmap_get_str(&mod_resources, str_c(&filename), (void **)&obuf, &len)) {
+        if((obuf = get_image(str_c(&filename))) != NULL) {
             assert(obuf->type == MOD_SPRITE);
             sd_sprite_free(photo->sprite);
             sd_sprite_copy(photo->sprite, &obuf->spr);
@@ -1773,7 +1926,7 @@ bool modmanager_get_player_pics(sd_pic_file *players) {
         str_from_format(&filename, "players/%i/har_color.png", i);
 
         // copy HAR color palette, if exists
-        if(!hashmap_get_str(&mod_resources, str_c(&filename), (void **)&obuf, &len)) {
+        if((obuf = get_image(str_c(&filename))) != NULL) {
             assert(obuf->type == MOD_SPRITE);
             palette_copy(&photo->pal, obuf->pal, 0, 48);
         }
@@ -0,0 +1,246 @@
+#include "resources/preloader.h"
+#include "resources/af_loader.h"
+#include "resources/bk_loader.h"
+#include "resources/ids.h"
+#include "utils/allocator.h"
+#include "utils/log.h"
+
+#include <SDL.h>
+#include <string.h>
+
+#define MAX_JOBS 6 // Next scene BK, two HARs, and some room for requests that are never taken
+
+typedef enum preload_type
+{
+    PRELOAD_BK,
+    PRELOAD_AF,
+} preload_type;
+
+typedef enum job_state
+{
+    JOB_FREE,
+    JOB_PENDING,
+    JOB_RUNNING,
+    JOB_DONE,
+    JOB_FAILED,
+} job_state;
+
+typedef struct preload_job {
+    job_state state;
+    preload_type type;
+    path filename;      // BK file, for PRELOAD_BK
+    int resource_id;    // AF resource, for PRELOAD_AF
+    unsigned int order; // Request order; jobs are loaded and evicted oldest first
+    void *data;         // Loaded bk or af, once the job is done
+} preload_job;
+
+typedef struct preloader {
+    SDL_Thread *thread;
+    SDL_mutex *lock;
+    SDL_cond *wake;     // Signaled when a job is added, or when closing
+    SDL_cond *finished; // Signaled when a job has been loaded
+    preload_job jobs[MAX_JOBS];
+    preloader_load_fn load;
+    unsigned int next_order;
+    bool closing;
+} preloader;
+
+static preloader *loader = NULL;
+
+static void free_data(preload_type type, void *data) {
+    if(data == NULL) {
+        return;
+    }
+    if(type == PRELOAD_BK) {
+        bk_free(data);
+    } else {
+        af_free(data);
+    }
+    omf_free(data);
+}
+
+static void *load_data(const path *filename, int resource_id) {
+    if(filename != NULL) {
+        bk *b = omf_calloc(1, sizeof(bk));
+        if(load_bk_file(b, filename)) {
+            omf_free(b);
+            return NULL;
+        }
+        return b;
+    }
+    af *a = omf_calloc(1, sizeof(af));
+    if(load_af_file(a, resource_id)) {
+        omf_free(a);
+        return NULL;
+    }
+    return a;
+}
+
+static preload_job *find_job(preloader *pl, preload_type type, const path *filename, int resource_id) {
+    for(int i = 0; i < MAX_JOBS; i++) {
+        preload_job *job = &pl->jobs[i];
+        if(job->state == JOB_FREE || job->type != type) {
+            continue;
+        }
+        if(type == PRELOAD_BK ? strcmp(job->filename.buf, filename->buf) == 0 : job->resource_id == resource_id) {
+            return job;
+        }
+    }
+    return NULL;
+}
+
+static preload_job *oldest_job(preloader *pl, job_state a, job_state b) {
+    preload_job *found = NULL;
+    for(int i = 0; i < MAX_JOBS; i++) {
+        preload_job *job = &pl->jobs[i];
+        if((job->state == a || job->state == b) && (found == NULL || job->order < found->order)) {
+            found = job;
+        }
+    }
+    return found;
+}
+
+static int preloader_thread(void *userdata) {
+    preloader *pl = userdata;
+    SDL_LockMutex(pl->lock);
+    while(true) {
+        preload_job *job;
+        while((job = oldest_job(pl, JOB_PENDING, JOB_PENDING)) == NULL && !pl->closing) {
+            SDL_CondWait(pl->wake, pl->lock);
+        }
+        if(pl->closing) {
+            break;
+        }
+
+        // Running jobs are never moved or evicted, so the job can be filled in after the load.
+        job->state = JOB_RUNNING;
+        const preload_type type = job->type;
+        const path filename = job->filename;
+        const int resource_id = job->resource_id;
+        SDL_UnlockMutex(pl->lock);
+        void *data = pl->load(type == PRELOAD_BK ? &filename : NULL, resource_id);
+        SDL_LockMutex(pl->lock);
+
+        job->data = data;
+        job->state = data != NULL ? JOB_DONE : JOB_FAILED;
+        SDL_CondBroadcast(pl->finished);
+    }
+    SDL_UnlockMutex(pl->lock);
+    return 0;
+}
+
+void preloader_init(void) {
+    preloader_init_with(load_data);
+}
+
+void preloader_init_with(preloader_load_fn load) {
+    preloader *pl = omf_calloc(1, sizeof(preloader));
+    pl->load = load;
+    pl->lock = SDL_CreateMutex();
+    pl->wake = SDL_CreateCond();
+    pl->finished = SDL_CreateCond();
+    pl->thread = SDL_CreateThread(preloader_thread, "preloader", pl);
+    if(pl->thread == NULL) {
+        log_warn("Unable to start preloader thread, assets will be loaded on demand: %s", SDL_GetError());
+        SDL_DestroyCond(pl->finished);
+        SDL_DestroyCond(pl->wake);
+        SDL_DestroyMutex(pl->lock);
+        omf_free(pl);
+        return;
+    }
+    loader = pl;
+}
+
+void preloader_close(void) {
+    preloader *pl = loader;
+    if(pl == NULL) {
+        return;
+    }
+    SDL_LockMutex(pl->lock);
+    pl->closing = true;
+    SDL_CondSignal(pl->wake);
+    SDL_UnlockMutex(pl->lock);
+    SDL_WaitThread(pl->thread, NULL);
+
+    for(int i = 0; i < MAX_JOBS; i++) {
+        free_data(pl->jobs[i].type, pl->jobs[i].data);
+    }
+    SDL_DestroyCond(pl->finished);
+    SDL_DestroyCond(pl->wake);
+    SDL_DestroyMutex(pl->lock);
+    omf_free(pl);
+    loader = NULL;
+}
+
+static void request(preload_type type, const path *filename, int resource_id) {
+    preloader *pl = loader;
+    if(pl == NULL) {
+        return;
+    }
+    SDL_LockMutex(pl->lock);
+    if(find_job(pl, type, filename, resource_id) != NULL) {
+        goto exit_0;
+    }
+    preload_job *job = oldest_job(pl, JOB_FREE, JOB_FREE);
+    if(job == NULL) {
+        // Make room by dropping the oldest file that nobody has taken.
+        job = oldest_job(pl, JOB_DONE, JOB_FAILED);
+        if(job == NULL) {
+            log_debug("Preloader is busy, not preloading %s",
+                      type == PRELOAD_BK ? path_c(filename) : get_resource_name(resource_id));
+            goto exit_0;
+        }
+        free_data(job->type, job->data);
+    }
+    job->type = type;
+    if(type == PRELOAD_BK) {
+        job->filename = *filename;
+    } else {
+        path_clear(&job->filename);
+    }
+    job->resource_id = resource_id;
+    job->order = pl->next_order++;
+    job->data = NULL;
+    job->state = JOB_PENDING;
+    SDL_CondSignal(pl->wake);
+
+exit_0:
+    SDL_UnlockMutex(pl->lock);
+}
+
+static void *take(preload_type type, const path *filename, int resource_id) {
+    preloader *pl = loader;
+    if(pl == NULL) {
+        return NULL;
+    }
+    void *data = NULL;
+    SDL_LockMutex(pl->lock);
+    preload_job *job = find_job(pl, type, filename, resource_id);
+    if(job != NULL) {
+        // A job that has not been started yet is dropped, loading it here is no slower than waiting for it.
+        while(job->state == JOB_RUNNING) {
+            SDL_CondWait(pl->finished, pl->lock);
+        }
+        data = job->data;
+        job->data = NULL;
+        job->state = JOB_FREE;
+    }
+    SDL_UnlockMutex(pl->lock);
+    return data;
+}
+
+void preloader_request_bk(const path *filename) {
+    request(PRELOAD_BK, filename, 0);
+}
+
+void preloader_request_af(int resource_id) {
+    request(PRELOAD_AF, NULL, resource_id);
+}
+
+bk *preloader_take_bk(const path *filename) {
+    return take(PRELOAD_BK, filename, 0);
+}
+
+af *preloader_take_af(int resource_id) {
+    return take(PRELOAD_AF, NULL, resource_id);
+}
@@ -0,0 +1,75 @@
+/**
+ * @file preloader.h
+ * @brief Background loading of BK and AF files for upcoming scenes
+ * @details Loading a BK or AF file decodes every sprite in it, which takes long enough to cause a visible hitch on
+ *          scene changes. As soon as the next scene (and the HARs that will fight in it) is known, the files can be
+ *          requested from the preloader, which loads them on a worker thread. When the scene is created, the loaded
+ *          file is taken from the preloader instead of loading it again.
+ *
+ *          Taking a file that was never requested, that is still waiting in the queue or that failed to load returns
+ *          NULL, and the caller should load the file itself. Taking a file that is being loaded right now waits for
+ *          the load to finish.
+ * @copyright MIT License
+ * @date 2026
+ * @author OpenOMF Project
+ */
+
+#ifndef PRELOADER_H
+#define PRELOADER_H
+
+#include "resources/af.h"
+#include "resources/bk.h"
+#include "utils/path.h"
+
+/**
+ * @brief Loads a requested file on the preloader thread.
+ * @param filename BK file to load, or NULL for an AF file
+ * @param resource_id AF resource to load, if filename is NULL
+ * @return Allocated bk or af, or NULL if loading failed
+ */
+typedef void *(*preloader_load_fn)(const path *filename, int resource_id);
+
+/**
+ * @brief Start the preloader thread. If this fails, requests are ignored and everything is loaded synchronously.
+ */
+void preloader_init(void);
+
+/**
+ * @brief Start the preloader thread with a custom load function. This is for tests; files are still freed with
+ *        bk_free() and af_free() if they are never taken.
+ * @param load Function that loads the requested files
+ */
+void preloader_init_with(preloader_load_fn load);
+
+/**
+ * @brief Stop the preloader thread, and free all files that were loaded but never taken.
+ */
+void preloader_close(void);
+
+/**
+ * @brief Start loading a BK file in the background. Does nothing if the file has already been requested.
+ * @param filename BK file to load, as given to load_bk_file()
+ */
+void preloader_request_bk(const path *filename);
+
+/**
+ * @brief Start loading an AF file in the background. Does nothing if the file has already been requested.
+ * @param resource_id AF resource to load, as given to load_af_file()
+ */
+void preloader_request_af(int resource_id);
+
+/**
+ * @brief Take a preloaded BK file.
+ * @param filename BK file to take
+ * @return Loaded BK file, owned by the caller from now on, or NULL if the caller must load the file itself.
+ */
+bk *preloader_take_bk(const path *filename);
+
+/**
+ * @brief Take a preloaded AF file.
+ * @param resource_id AF resource to take
+ * @return Loaded AF file, owned by the caller from now on, or NULL if the caller must load the file itself.
+ */
+af *preloader_take_af(int resource_id);
+
+#endif // PRELOADER_H
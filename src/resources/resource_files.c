@@ -49,6 +49,17 @@ path get_snapshot_rec_filename(const char *timestamp) {
     return path;
 }
 
+path get_desync_dump_filename(const char *name) {
+    path path = get_state_dir();
+    path_append(&path, "desync");
+    if(!path_exists(&path)) {
+        path_mkdir(&path);
+    }
+
+    path_append(&path, name);
+    return path;
+}
+
 path get_save_directory(void) {
     path name = get_state_dir();
     path_append(&name, "save");
@@ -8,6 +8,7 @@ path get_log_filename(void);
 path get_scores_filename(void);
 path get_screenshot_filename(const char *timestamp);
 path get_snapshot_rec_filename(const char *timestamp);
+path get_desync_dump_filename(const char *name);
 path get_save_directory(void);
 bool scan_save_directory(list *results, const char *pattern);
 path get_shader_filename(const char *shader_name);
@@ -5,8 +5,11 @@
 #include "utils/hashmap.h"
 #include "utils/log.h"
 
+#include <SDL.h>
+
 typedef struct script_cache {
     hashmap scripts; ///< Maps an animation string to its script instance
+    SDL_mutex *lock; ///< Scripts are also looked up by the AI lookahead workers
 } script_cache;
 
 static script_cache state;
@@ -20,16 +23,21 @@ static void free_value(void *value) {
 
 void script_cache_init(void) {
     hashmap_create_cb(&state.scripts, free_value);
+    state.lock = SDL_CreateMutex();
 }
 
 void script_cache_close(void) {
     hashmap_free(&state.scripts);
+    SDL_DestroyMutex(state.lock);
+    state.lock = NULL;
 }
 
 const script *script_cache_get(const char *str) {
     void *value;
     unsigned int value_len;
+    SDL_LockMutex(state.lock);
     if(hashmap_get_str(&state.scripts, str, &value, &value_len) == 0) {
+        SDL_UnlockMutex(state.lock);
         return *(script **)value;
     }
 
@@ -39,11 +47,16 @@ const script *script_cache_get(const char *str) {
     if(script_decode(s, str, &invalid_pos) != SD_SUCCESS) {
         crash_with_args("Failed to decode string '%s'; error at position %d.", str, invalid_pos);
     }
+    // Cached scripts are never modified, so the tag index stays valid for their lifetime.
+    script_compile(s);
     hashmap_put_str(&state.scripts, str, &s, sizeof(s));
     log_debug("Cached script '%s'; cache size now %d.", str, hashmap_reserved(&state.scripts));
+    SDL_UnlockMutex(state.lock);
     return s;
 }
 
 void script_cache_clear(void) {
+    SDL_LockMutex(state.lock);
     hashmap_clear(&state.scripts);
+    SDL_UnlockMutex(state.lock);
 }
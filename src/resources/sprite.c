@@ -1,5 +1,6 @@
 #include "formats/sprite.h"
 #include "resources/sprite.h"
+#include "resources/sprite_cache.h"
 #include "utils/allocator.h"
 #include <stdlib.h>
 
@@ -9,6 +10,13 @@ void sprite_create_custom(sprite *sp, vec2i pos, surface *data) {
     sp->data = data;
 }
 
+static void decode_surface(surface *dst, const sd_sprite *sdsprite) {
+    sd_vga_image raw;
+    sd_sprite_vga_decode(&raw, sdsprite);
+    surface_create_from_data(dst, raw.w, raw.h, (unsigned char *)raw.data);
+    sd_vga_image_free(&raw);
+}
+
 void sprite_create(sprite *sp, void *src, int id) {
     sd_sprite *sdsprite = (sd_sprite *)src;
     sp->id = id;
@@ -23,12 +31,35 @@ void sprite_create(sprite *sp, void *src, int id) {
     // Load data
     sp->data = omf_calloc(1, sizeof(surface));
     sp->owned = true;
-    sd_vga_image raw;
-    sd_sprite_vga_decode(&raw, sdsprite);
-    surface_create_from_data(sp->data, raw.w, raw.h, (unsigned char *)raw.data);
+    sp->shared = false;
+    decode_surface(sp->data, sdsprite);
     sp->data->render_w = sdsprite->render_width;
     sp->data->render_h = sdsprite->render_height;
-    sd_vga_image_free(&raw);
+}
+
+void sprite_create_cached(sprite *sp, void *src, int id, int render_w, int render_h, const char *key) {
+    sd_sprite *sdsprite = (sd_sprite *)src;
+    sp->id = id;
+    sp->pos = sdsprite->pos;
+    sp->owned = false;
+    sp->shared = false;
+
+    if(sdsprite->width == 0 || sdsprite->height == 0) {
+        sp->data = NULL;
+        return;
+    }
+
+    // Decode only if nobody has done it yet. The render size is part of the surface, so it must be set before
+    // the surface is shared.
+    sp->shared = true;
+    sp->data = sprite_cache_acquire(key);
+    if(sp->data == NULL) {
+        surface tmp;
+        decode_surface(&tmp, sdsprite);
+        tmp.render_w = render_w;
+        tmp.render_h = render_h;
+        sp->data = sprite_cache_insert(key, &tmp);
+    }
 }
 
 void sprite_create_reference(sprite *sp, void *src, int id, void *data) {
@@ -37,12 +68,16 @@ void sprite_create_reference(sprite *sp, void *src, int id, void *data) {
     sp->pos = sdsprite->pos;
     sp->data = data;
     sp->owned = false;
+    sp->shared = false;
 }
 
 int sprite_clone(sprite *src, sprite *dst) {
     memcpy(dst, src, sizeof(sprite));
     dst->data = omf_calloc(1, sizeof(surface));
     surface_create_from(dst->data, src->data);
+    dst->owned = true;
+    dst->shared = false;
+    SDL_AtomicSet(&dst->extra, 0);
     return 0;
 }
 
@@ -50,6 +85,10 @@ void sprite_free(sprite *sp) {
     if(sp->owned) {
         surface_free(sp->data);
         omf_free(sp->data);
+    } else if(sp->shared) {
+        sprite_cache_release(sp->data);
+        sp->data = NULL;
+        sp->shared = false;
     }
 }
 
@@ -75,3 +114,21 @@ sprite *sprite_copy(sprite *src) {
     new->owned = true;
     return new;
 }
+
+sprite *sprite_share(sprite *sp) {
+    SDL_AtomicIncRef(&sp->extra);
+    return sp;
+}
+
+bool sprite_is_shared(sprite *sp) {
+    return SDL_AtomicGet(&sp->extra) > 0;
+}
+
+void sprite_release(sprite *sp) {
+    // SDL_AtomicAdd returns the old value; if there were no other owners, this was the last one.
+    if(SDL_AtomicAdd(&sp->extra, -1) > 0) {
+        return;
+    }
+    sprite_free(sp);
+    omf_free(sp);
+}
@@ -3,21 +3,41 @@
 
 #include "utils/vec.h"
 #include "video/surface.h"
+#include <SDL_atomic.h>
 
 typedef struct sprite_t {
     int id;
     vec2i pos;
     surface *data;
-    bool owned; // if we own the `data` surface
+    bool owned;         // if we own the `data` surface
+    bool shared;        // if `data` is a reference to a sprite cache surface
+    SDL_atomic_t extra; // number of owners besides the first one, see sprite_share()
 } sprite;
 
 void sprite_create(sprite *sp, void *src, int id);
 void sprite_create_custom(sprite *sp, vec2i pos, surface *sur);
 void sprite_create_reference(sprite *sp, void *src, int id, void *data);
+void sprite_create_cached(sprite *sp, void *src, int id, int render_w, int render_h, const char *key);
 int sprite_clone(sprite *src, sprite *dst);
 void sprite_free(sprite *sp);
 
 vec2i sprite_get_size(sprite *s);
 sprite *sprite_copy(sprite *src);
 
+/**
+ * Add an owner to a heap allocated sprite. Shared sprites must not be modified; take a private copy first, eg. with
+ * animation_get_sprite_writable().
+ */
+sprite *sprite_share(sprite *sp);
+
+/**
+ * Check if a sprite has more than one owner.
+ */
+bool sprite_is_shared(sprite *sp);
+
+/**
+ * Drop an owner of a heap allocated sprite. The last owner frees the sprite and its surface.
+ */
+void sprite_release(sprite *sp);
+
 #endif // SPRITE_H
@@ -0,0 +1,149 @@
+#include "resources/sprite_cache.h"
+
+#include "utils/allocator.h"
+#include "utils/hashmap.h"
+#include "utils/log.h"
+
+#include <SDL.h>
+#include <string.h>
+
+#define UNUSED_BUDGET (16 * 1024 * 1024) // Bytes of unreferenced surfaces kept around for reuse
+
+typedef struct cache_entry cache_entry;
+
+struct cache_entry {
+    surface sur; // Must be first; released surfaces are cast back to their entry.
+    int refs;
+    char *key;
+    cache_entry *prev; // Neighbours in the unused list, while refs is 0
+    cache_entry *next;
+};
+
+typedef struct sprite_cache {
+    hashmap entries;          ///< Maps a sprite key to its cache_entry pointer
+    SDL_mutex *lock;          ///< Sprites are also loaded by the preloader thread
+    cache_entry *unused_head; ///< Least recently released entry
+    cache_entry *unused_tail; ///< Most recently released entry
+    size_t unused_bytes;      ///< Total size of the entries in the unused list
+} sprite_cache;
+
+static sprite_cache *cache = NULL;
+
+static size_t entry_size(const cache_entry *entry) {
+    return (size_t)entry->sur.w * entry->sur.h * sizeof(vga_pixel);
+}
+
+// Called by the hashmap as free callback.
+static void free_value(void *value) {
+    cache_entry *entry = *(cache_entry **)value;
+    surface_free(&entry->sur);
+    omf_free(entry->key);
+    omf_free(entry);
+}
+
+static void unlink_unused(sprite_cache *c, cache_entry *entry) {
+    if(entry->prev != NULL) {
+        entry->prev->next = entry->next;
+    } else {
+        c->unused_head = entry->next;
+    }
+    if(entry->next != NULL) {
+        entry->next->prev = entry->prev;
+    } else {
+        c->unused_tail = entry->prev;
+    }
+    entry->prev = NULL;
+    entry->next = NULL;
+    c->unused_bytes -= entry_size(entry);
+}
+
+static void append_unused(sprite_cache *c, cache_entry *entry) {
+    entry->prev = c->unused_tail;
+    entry->next = NULL;
+    if(c->unused_tail != NULL) {
+        c->unused_tail->next = entry;
+    } else {
+        c->unused_head = entry;
+    }
+    c->unused_tail = entry;
+    c->unused_bytes += entry_size(entry);
+}
+
+void sprite_cache_init(void) {
+    cache = omf_calloc(1, sizeof(sprite_cache));
+    hashmap_create_cb(&cache->entries, free_value);
+    cache->lock = SDL_CreateMutex();
+}
+
+void sprite_cache_close(void) {
+    if(cache == NULL) {
+        return;
+    }
+    int in_use = hashmap_size(&cache->entries);
+    for(cache_entry *entry = cache->unused_head; entry != NULL; entry = entry->next) {
+        in_use--;
+    }
+    if(in_use > 0) {
+        log_warn("Sprite cache closed while %d surfaces are still in use", in_use);
+    }
+    hashmap_free(&cache->entries);
+    SDL_DestroyMutex(cache->lock);
+    omf_free(cache);
+}
+
+bool sprite_cache_enabled(void) {
+    return cache != NULL;
+}
+
+surface *sprite_cache_acquire(const char *key) {
+    void *value;
+    cache_entry *entry = NULL;
+    SDL_LockMutex(cache->lock);
+    if(hashmap_get_str(&cache->entries, key, &value, NULL) == 0) {
+        entry = *(cache_entry **)value;
+        if(entry->refs++ == 0) {
+            unlink_unused(cache, entry);
+        }
+    }
+    SDL_UnlockMutex(cache->lock);
+    return entry != NULL ? &entry->sur : NULL;
+}
+
+surface *sprite_cache_insert(const char *key, surface *sur) {
+    void *value;
+    cache_entry *entry;
+    SDL_LockMutex(cache->lock);
+    if(hashmap_get_str(&cache->entries, key, &value, NULL) == 0) {
+        // Somebody else decoded the same sprite at the same time; use theirs.
+        surface_free(sur);
+        entry = *(cache_entry **)value;
+        if(entry->refs++ == 0) {
+            unlink_unused(cache, entry);
+        }
+    } else {
+        entry = omf_calloc(1, sizeof(cache_entry));
+        entry->sur = *sur;
+        entry->refs = 1;
+        const size_t key_len = strlen(key) + 1;
+        entry->key = omf_malloc(key_len);
+        memcpy(entry->key, key, key_len);
+        hashmap_put_str(&cache->entries, key, &entry, sizeof(cache_entry *));
+    }
+    SDL_UnlockMutex(cache->lock);
+    memset(sur, 0, sizeof(surface));
+    return &entry->sur;
+}
+
+void sprite_cache_release(surface *sur) {
+    cache_entry *entry = (cache_entry *)sur;
+    SDL_LockMutex(cache->lock);
+    if(--entry->refs == 0) {
+        append_unused(cache, entry);
+        while(cache->unused_bytes > UNUSED_BUDGET) {
+            cache_entry *oldest = cache->unused_head;
+            unlink_unused(cache, oldest);
+            hashmap_del_str(&cache->entries, oldest->key);
+        }
+    }
+    SDL_UnlockMutex(cache->lock);
+}
@@ -0,0 +1,63 @@
+/**
+ * @file sprite_cache.h
+ * @brief Process-wide cache of decoded HAR sprite surfaces.
+ * @details Sprite surfaces are reference counted and shared between all loads of the same file, so that loading a
+ *          HAR again (mirror matches, rematches, tournament rounds) does not decode it again. Shared surfaces keep
+ *          their guid, so the renderer does not upload them to the texture atlas again either.
+ *
+ *          Surfaces that are no longer referenced are kept around until their total size goes over a budget, and
+ *          are then freed least recently used first.
+ *
+ *          Shared surfaces must not be modified. Take a copy with sprite_copy() first.
+ * @copyright MIT License
+ * @date 2026
+ * @author OpenOMF Project
+ */
+
+#ifndef SPRITE_CACHE_H
+#define SPRITE_CACHE_H
+
+#include "video/surface.h"
+
+#include <stdbool.h>
+
+/**
+ * @brief Initialize the sprite cache. Call once during engine startup before any lookups.
+ */
+void sprite_cache_init(void);
+
+/**
+ * @brief Free every cached surface and the cache itself. Call once during engine shutdown.
+ * @details Must not be called while any sprite still references a cached surface.
+ */
+void sprite_cache_close(void);
+
+/**
+ * @brief Check if the cache is available. When it is not, sprites should own their surfaces.
+ */
+bool sprite_cache_enabled(void);
+
+/**
+ * @brief Find a surface and take a reference to it.
+ * @param key Unique name of the sprite, eg. source file, animation and frame
+ * @return Shared surface, or NULL if it is not cached.
+ */
+surface *sprite_cache_acquire(const char *key);
+
+/**
+ * @brief Add a surface to the cache, and take a reference to it.
+ * @details The surface contents are moved to the cache. If another thread has added the same key meanwhile, the
+ *          given surface is freed and the cached one is returned instead.
+ * @param key Unique name of the sprite
+ * @param sur Decoded surface. Will be emptied.
+ * @return Shared surface
+ */
+surface *sprite_cache_insert(const char *key, surface *sur);
+
+/**
+ * @brief Drop a reference taken with sprite_cache_acquire() or sprite_cache_insert().
+ * @param sur Shared surface
+ */
+void sprite_cache_release(surface *sur);
+
+#endif // SPRITE_CACHE_H
@@ -77,6 +77,12 @@ error_0:
     return 1;
 }
 
+int conf_init_defaults(void) {
+    conf_ensure_opt_init();
+    cfg = cfg_init((cfg_opt_t *)cfg_opts.data, CFGF_IGNORE_UNKNOWN);
+    return cfg == NULL;
+}
+
 int conf_write_config(const char *filename) {
     conf_ensure_opt_init();
     FILE *fp = fopen(filename, "w");
@@ -47,6 +47,12 @@ void conf_addstring(char *name, char *default_val);
  */
 int conf_init(const char *filename);
 
+/**
+ * @brief Initialize the configuration system with the default values only. No file is read.
+ * @return 0 on success, non-zero on error
+ */
+int conf_init_defaults(void);
+
 /**
  * @brief Write current configuration values to a file.
  * @param filename Path to the configuration file to write
@@ -0,0 +1,214 @@
+#include "utils/profiler.h"
+
+#ifdef DEBUGMODE
+
+#include "utils/allocator.h"
+#include "utils/log.h"
+#include "utils/path.h"
+
+#include <SDL.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_TRACE_EVENTS 65536 // Must be a power of two
+
+typedef struct trace_event {
+    uint64_t start_us;
+    uint32_t duration_us;
+    profiler_zone zone;
+} trace_event;
+
+typedef struct profiler {
+    uint64_t origin;    // Performance counter value at reset, trace timestamps start from here
+    uint64_t frequency; // Performance counter ticks per second
+    uint64_t zone_start[PROFILER_ZONE_COUNT];
+    int zone_depth[PROFILER_ZONE_COUNT];
+    uint32_t accum[PROFILER_ZONE_COUNT]; // Time spent in each zone during the current frame
+    uint32_t frames[PROFILER_FRAMES][PROFILER_ZONE_COUNT];
+    uint32_t counter_accum[PROFILER_COUNTER_COUNT];
+    uint32_t counter_frames[PROFILER_FRAMES][PROFILER_COUNTER_COUNT];
+    int frame_head;
+    int frame_count;
+    trace_event *events;
+    uint32_t event_head;
+    uint32_t event_count;
+} profiler;
+
+static const char *zone_names[PROFILER_ZONE_COUNT] = {
+    "frame", "static_tick", "dynamic_tick", "replay", "palette", "render", "present",
+};
+
+static const char *counter_names[PROFILER_COUNTER_COUNT] = {
+    "palette_upload_bytes",
+};
+
+static profiler *prof = NULL;
+
+static uint64_t now_us(void) {
+    // Split into whole seconds and the rest, so that long sessions can not overflow the multiplication.
+    const uint64_t ticks = SDL_GetPerformanceCounter() - prof->origin;
+    return ticks / prof->frequency * 1000000 + ticks % prof->frequency * 1000000 / prof->frequency;
+}
+
+static void add_event(profiler_zone zone, uint64_t start_us, uint64_t end_us) {
+    trace_event *ev = &prof->events[(prof->event_head + prof->event_count) & (MAX_TRACE_EVENTS - 1)];
+    ev->start_us = start_us;
+    ev->duration_us = end_us - start_us;
+    ev->zone = zone;
+    if(prof->event_count < MAX_TRACE_EVENTS) {
+        prof->event_count++;
+    } else {
+        prof->event_head = (prof->event_head + 1) & (MAX_TRACE_EVENTS - 1);
+    }
+}
+
+void profiler_init(void) {
+    prof = omf_calloc(1, sizeof(profiler));
+    prof->events = omf_calloc(MAX_TRACE_EVENTS, sizeof(trace_event));
+    prof->frequency = SDL_GetPerformanceFrequency();
+    profiler_reset();
+}
+
+void profiler_close(void) {
+    if(prof != NULL) {
+        omf_free(prof->events);
+        omf_free(prof);
+    }
+}
+
+void profiler_reset(void) {
+    if(prof == NULL) {
+        return;
+    }
+    prof->origin = SDL_GetPerformanceCounter();
+    memset(prof->zone_depth, 0, sizeof(prof->zone_depth));
+    memset(prof->accum, 0, sizeof(prof->accum));
+    memset(prof->counter_accum, 0, sizeof(prof->counter_accum));
+    prof->frame_head = 0;
+    prof->frame_count = 0;
+    prof->event_head = 0;
+    prof->event_count = 0;
+    prof->zone_start[PROFILER_FRAME] = 0;
+}
+
+void profiler_begin(profiler_zone zone) {
+    if(prof == NULL || prof->zone_depth[zone]++ > 0) {
+        return;
+    }
+    prof->zone_start[zone] = now_us();
+}
+
+void profiler_end(profiler_zone zone) {
+    if(prof == NULL || prof->zone_depth[zone] == 0 || --prof->zone_depth[zone] > 0) {
+        return;
+    }
+    uint64_t end = now_us();
+    prof->accum[zone] += end - prof->zone_start[zone];
+    add_event(zone, prof->zone_start[zone], end);
+}
+
+void profiler_count(profiler_counter counter, uint32_t value) {
+    if(prof == NULL) {
+        return;
+    }
+    prof->counter_accum[counter] += value;
+}
+
+void profiler_frame_end(void) {
+    if(prof == NULL) {
+        return;
+    }
+    // The frame zone covers everything from the end of the previous frame to the end of this one.
+    uint64_t end = now_us();
+    prof->accum[PROFILER_FRAME] = end - prof->zone_start[PROFILER_FRAME];
+    add_event(PROFILER_FRAME, prof->zone_start[PROFILER_FRAME], end);
+    prof->zone_start[PROFILER_FRAME] = end;
+
+    memcpy(prof->frames[prof->frame_head], prof->accum, sizeof(prof->accum));
+    memset(prof->accum, 0, sizeof(prof->accum));
+    memcpy(prof->counter_frames[prof->frame_head], prof->counter_accum, sizeof(prof->counter_accum));
+    memset(prof->counter_accum, 0, sizeof(prof->counter_accum));
+    prof->frame_head = (prof->frame_head + 1) % PROFILER_FRAMES;
+    if(prof->frame_count < PROFILER_FRAMES) {
+        prof->frame_count++;
+    }
+}
+
+const char *profiler_zone_name(profiler_zone zone) {
+    return zone_names[zone];
+}
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void compute_stats(uint32_t *samples, int count, profiler_stats *stats) {
+    qsort(samples, count, sizeof(uint32_t), compare_u32);
+    stats->p50 = samples[(count - 1) * 50 / 100];
+    stats->p95 = samples[(count - 1) * 95 / 100];
+    stats->p99 = samples[(count - 1) * 99 / 100];
+    stats->max = samples[count - 1];
+}
+
+int profiler_get_stats(profiler_zone zone, profiler_stats *stats) {
+    memset(stats, 0, sizeof(profiler_stats));
+    if(prof == NULL || prof->frame_count == 0) {
+        return 0;
+    }
+    uint32_t samples[PROFILER_FRAMES];
+    const int count = prof->frame_count;
+    for(int i = 0; i < count; i++) {
+        samples[i] = prof->frames[i][zone];
+    }
+    compute_stats(samples, count, stats);
+    return count;
+}
+
+const char *profiler_counter_name(profiler_counter counter) {
+    return counter_names[counter];
+}
+
+int profiler_get_counter_stats(profiler_counter counter, profiler_stats *stats) {
+    memset(stats, 0, sizeof(profiler_stats));
+    if(prof == NULL || prof->frame_count == 0) {
+        return 0;
+    }
+    uint32_t samples[PROFILER_FRAMES];
+    const int count = prof->frame_count;
+    for(int i = 0; i < count; i++) {
+        samples[i] = prof->counter_frames[i][counter];
+    }
+    compute_stats(samples, count, stats);
+    return count;
+}
+
+bool profiler_dump_trace(const char *filename) {
+    if(prof == NULL) {
+        return false;
+    }
+    path p;
+    path_from_c(&p, filename);
+    FILE *fp = path_fopen(&p, "w");
+    if(fp == NULL) {
+        log_error("Unable to open trace file %s for writing", filename);
+        return false;
+    }
+    fputs("{\"traceEvents\":[\n", fp);
+    for(uint32_t i = 0; i < prof->event_count; i++) {
+        const trace_event *ev = &prof->events[(prof->event_head + i) & (MAX_TRACE_EVENTS - 1)];
+        // Frames go on their own row, so that the zones within them are easy to read.
+        fprintf(fp, "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%" PRIu64 ",\"dur\":%" PRIu32 ",\"pid\":1,\"tid\":%d}",
+                i > 0 ? ",\n" : "", zone_names[ev->zone], ev->start_us, ev->duration_us,
+                ev->zone == PROFILER_FRAME ? 1 : 2);
+    }
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", fp);
+    fclose(fp);
+    log_info("Wrote %" PRIu32 " trace events to %s", prof->event_count, filename);
+    return true;
+}
+
+#endif // DEBUGMODE
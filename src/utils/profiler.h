@@ -0,0 +1,152 @@
+/**
+ * @file profiler.h
+ * @brief Per-subsystem frame profiler.
+ * @details Code sections are timed by wrapping them in profiler_begin()/profiler_end() calls. Time spent in each zone
+ *          is summed up per frame, and the last PROFILER_FRAMES frames are kept in a ring buffer for statistics. Each
+ *          timed section is also recorded as a trace event, and the recent events can be written out in the Chrome
+ *          trace event format (open with chrome://tracing or Perfetto).
+ *
+ *          Besides time, per-frame amounts (such as bytes uploaded to the GPU) can be summed up in counters with
+ *          profiler_count(). They are kept in the same ring buffer and have the same statistics.
+ *
+ *          The profiler only exists in debug builds. In release builds all functions are empty inline stubs, so
+ *          the instrumentation compiles out completely.
+ * @copyright MIT License
+ * @date 2026
+ * @author OpenOMF Project
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PROFILER_FRAMES 240
+
+typedef enum profiler_zone
+{
+    PROFILER_FRAME,
+    PROFILER_STATIC_TICK,
+    PROFILER_DYNAMIC_TICK,
+    PROFILER_REPLAY,
+    PROFILER_PALETTE,
+    PROFILER_RENDER,
+    PROFILER_PRESENT,
+    PROFILER_ZONE_COUNT
+} profiler_zone;
+
+typedef enum profiler_counter
+{
+    PROFILER_PALETTE_UPLOAD_BYTES,
+    PROFILER_COUNTER_COUNT
+} profiler_counter;
+
+/**
+ * @brief Statistics of one zone or counter over the recent frames, in microseconds (or counter units) per frame.
+ */
+typedef struct profiler_stats {
+    uint32_t p50;
+    uint32_t p95;
+    uint32_t p99;
+    uint32_t max;
+} profiler_stats;
+
+#ifdef DEBUGMODE
+
+/**
+ * @brief Initialize the profiler and start the first frame.
+ */
+void profiler_init(void);
+
+/**
+ * @brief Free the profiler buffers.
+ */
+void profiler_close(void);
+
+/**
+ * @brief Drop all recorded samples and trace events.
+ */
+void profiler_reset(void);
+
+/**
+ * @brief Start timing a zone. Nested calls for the same zone are only counted once.
+ * @param zone Zone to time
+ */
+void profiler_begin(profiler_zone zone);
+
+/**
+ * @brief Stop timing a zone.
+ * @param zone Zone started with profiler_begin
+ */
+void profiler_end(profiler_zone zone);
+
+/**
+ * @brief Add to a counter for the current frame.
+ * @param counter Counter to add to
+ * @param value Amount to add
+ */
+void profiler_count(profiler_counter counter, uint32_t value);
+
+/**
+ * @brief Finish the current frame, and store its per-zone times in the ring buffer.
+ */
+void profiler_frame_end(void);
+
+/**
+ * @brief Get the name of a zone.
+ * @param zone Zone
+ * @return Zone name (static string)
+ */
+const char *profiler_zone_name(profiler_zone zone);
+
+/**
+ * @brief Compute percentiles of the per-frame times of a zone over the recorded frames.
+ * @param zone Zone
+ * @param stats Output statistics
+ * @return Number of frames the statistics were computed from
+ */
+int profiler_get_stats(profiler_zone zone, profiler_stats *stats);
+
+/**
+ * @brief Get the name of a counter.
+ * @param counter Counter
+ * @return Counter name (static string)
+ */
+const char *profiler_counter_name(profiler_counter counter);
+
+/**
+ * @brief Compute percentiles of the per-frame values of a counter over the recorded frames.
+ * @param counter Counter
+ * @param stats Output statistics
+ * @return Number of frames the statistics were computed from
+ */
+int profiler_get_counter_stats(profiler_counter counter, profiler_stats *stats);
+
+/**
+ * @brief Write the recorded trace events as Chrome trace JSON.
+ * @param filename Output file
+ * @return true on success
+ */
+bool profiler_dump_trace(const char *filename);
+
+#else
+
+static inline void profiler_init(void) {
+}
+static inline void profiler_close(void) {
+}
+static inline void profiler_reset(void) {
+}
+static inline void profiler_begin(profiler_zone zone) {
+}
+static inline void profiler_end(profiler_zone zone) {
+}
+static inline void profiler_count(profiler_counter counter, uint32_t value) {
+}
+static inline void profiler_frame_end(void) {
+}
+
+#endif // DEBUGMODE
+
+#endif // PROFILER_H
@@ -3,7 +3,13 @@
 
 // A simple psuedorandom number generator
 
-static struct random_t rand_state = {1};
+// The global generator is only used for effects and AI decisions that do not need to be reproducible. It is per
+// thread, so that the AI lookahead workers do not race the main thread for it.
+#if defined(_MSC_VER)
+static __declspec(thread) struct random_t rand_state = {1};
+#else
+static _Thread_local struct random_t rand_state = {1};
+#endif
 
 void random_seed(struct random_t *r, uint32_t seed) {
     r->seed = seed;
@@ -1,7 +1,8 @@
 /**
  * @file random.h
  * @brief Pseudo-random number generation.
- * @details Provides both instanced and global random number generators.
+ * @details Provides both instanced and global random number generators. The global generator has separate state for
+ *          each thread.
  * @copyright MIT License
  * @date 2026
  * @author OpenOMF Project
@@ -173,6 +173,11 @@ bool sprite_packer_alloc(sprite_packer *packer, uint16_t w, uint16_t h, sprite_r
     return true;
 }
 
+void sprite_packer_release(sprite_packer *packer, const sprite_region *region) {
+    vector_append(&packer->free_space, region);
+    vector_sort(&packer->free_space, space_sort);
+}
+
 void sprite_packer_reset(sprite_packer *packer) {
     vector_clear(&packer->free_space);
     const sprite_region item = {0, 0, packer->w, packer->h};
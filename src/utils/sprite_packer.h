@@ -56,6 +56,14 @@ void sprite_packer_free(sprite_packer **packer);
  */
 bool sprite_packer_alloc(sprite_packer *packer, uint16_t w, uint16_t h, sprite_region *out);
 
+/**
+ * @brief Return a previously allocated region to the packer.
+ * @details The region is not merged with its neighbours, so it can only be reused for rectangles that fit in it.
+ * @param packer The packer the region was allocated from
+ * @param region Region returned by sprite_packer_alloc()
+ */
+void sprite_packer_release(sprite_packer *packer, const sprite_region *region);
+
 /**
  * @brief Reset the packer to its initial state.
  * @details Clears all allocations, making the entire area available again.
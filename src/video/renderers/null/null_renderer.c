@@ -77,6 +77,8 @@ static void signal_scene_change(void *userdata) {
 }
 static void signal_draw_atlas(void *userdata, bool toggle) {
 }
+static void signal_surface_freed(void *userdata, const surface *sur) {
+}
 
 static void renderer_create(renderer *gl3_renderer) {
 }
@@ -107,4 +109,5 @@ void null_renderer_set_callbacks(renderer *gl3_renderer) {
     gl3_renderer->capture_screen = capture_screen;
     gl3_renderer->signal_scene_change = signal_scene_change;
     gl3_renderer->signal_draw_atlas = signal_draw_atlas;
+    gl3_renderer->signal_surface_freed = signal_surface_freed;
 }
@@ -8,9 +8,11 @@
 #include "video/renderers/opengl3/helpers/render_target.h"
 #include "video/renderers/opengl3/helpers/shaders.h"
 #include "video/renderers/opengl3/helpers/texture_atlas.h"
+#include "video/renderers/opengl3/helpers/upload_ring.h"
 
 #include "utils/allocator.h"
 #include "utils/log.h"
+#include "utils/profiler.h"
 #include "video/vga_state.h"
 
 #define TEX_UNIT_ATLAS 0
@@ -27,6 +29,7 @@ typedef struct gl3_context {
     texture_atlas *atlas;
     object_array *objects;
     gl_palette *palette;
+    upload_ring *uploads;
     render_target *paletted_target;
     render_target *rgba_target;
     remaps *remaps;
@@ -164,6 +167,7 @@ static bool setup_context(void *userdata, int window_w, int window_h, bool fulls
     ctx->atlas = atlas_create(TEX_UNIT_ATLAS, 2048, 2048);
     ctx->objects = object_array_create(2048.0f, 2048.0f);
     ctx->palette = gl_palette_create(TEX_UNIT_PALETTE);
+    ctx->uploads = upload_ring_create(sizeof(vga_palette) + sizeof(vga_remap_tables));
     ctx->paletted_target = render_target_create(TEX_UNIT_FBO, fb_w, fb_h, GL_RGBA16, GL_RGBA, GL_NEAREST);
     ctx->rgba_target = render_target_create(TEX_UNIT_FBO2, fb_w, fb_h, GL_RGBA8, GL_RGBA, GL_NEAREST);
     ctx->remaps = remaps_create(TEX_UNIT_REMAPS);
@@ -303,6 +307,7 @@ static void close_context(void *userdata) {
     render_target_free(&ctx->paletted_target);
     render_target_free(&ctx->rgba_target);
     gl_palette_free(&ctx->palette);
+    upload_ring_free(&ctx->uploads);
     object_array_free(&ctx->objects);
     atlas_free(&ctx->atlas);
     delete_program(ctx->palette_prog_id);
@@ -319,8 +324,9 @@ static void draw_surface(void *userdata, const surface *src_surface, SDL_Rect *d
                          unsigned int options) {
     const gl3_context *ctx = userdata;
     uint16_t tx, ty, tw, th;
-    if(atlas_get(ctx->atlas, src_surface, &tx, &ty, &tw, &th)) {
-        object_array_add(ctx->objects, dst->x, dst->y, dst->w, dst->h, tx, ty, tw, th, flip_mode,
+    uint8_t page;
+    if(atlas_get(ctx->atlas, src_surface, &tx, &ty, &tw, &th, &page)) {
+        object_array_add(ctx->objects, dst->x, dst->y, dst->w, dst->h, tx, ty, tw, th, page, flip_mode,
                          src_surface->transparent, remap_offset, remap_rounds, palette_offset, palette_limit, opacity,
                          options);
     }
@@ -402,12 +408,13 @@ static inline void set_screen_viewport(const gl3_context *ctx) {
 
 /**
  * If palette is dirty, flush it to the texture. Note that the range is inclusive (dirty area is start <= x <= end).
+ * The damage from all ticks and palette transforms since the last frame has already been combined by vga_state.
  */
 static inline void flush_palettes(gl3_context *ctx) {
     vga_index first, last;
     vga_palette *pal;
     if(vga_state_is_palette_dirty(&pal, &first, &last)) {
-        gl_palette_update(ctx->palette, pal, first, last);
+        gl_palette_update(ctx->palette, ctx->uploads, pal, first, last);
         vga_state_mark_palette_flushed();
     }
 }
@@ -418,11 +425,21 @@ static inline void flush_palettes(gl3_context *ctx) {
 static inline void flush_remaps(gl3_context *ctx) {
     vga_remap_tables *tables;
     if(vga_state_is_remap_dirty(&tables)) {
-        remaps_update(ctx->remaps, tables);
+        remaps_update(ctx->remaps, ctx->uploads, tables);
         vga_state_mark_remaps_flushed();
     }
 }
 
+/**
+ * Stream the palette and remap changes of this frame to the GPU through one upload ring segment.
+ */
+static inline void flush_vga_state(gl3_context *ctx) {
+    upload_ring_begin(ctx->uploads);
+    flush_palettes(ctx);
+    flush_remaps(ctx);
+    profiler_count(PROFILER_PALETTE_UPLOAD_BYTES, upload_ring_end(ctx->uploads));
+}
+
 static inline void finish_offscreen(gl3_context *ctx) {
     object_array_finish(ctx->objects);
 
@@ -435,9 +452,12 @@ static inline void finish_offscreen(gl3_context *ctx) {
     activate_program(ctx->palette_prog_id);
     render_target_activate(ctx->paletted_target);
 
+    // Batches are split on blend mode and atlas page changes; both bindings are skipped if they are already set.
     object_array_blend_mode mode;
-    while(object_array_get_batch(ctx->objects, &batch, &mode)) {
+    uint8_t page;
+    while(object_array_get_batch(ctx->objects, &batch, &mode, &page)) {
         video_set_blend_mode(ctx, mode);
+        atlas_bind_page(ctx->atlas, page);
         object_array_draw(ctx->objects, &batch);
     }
 }
@@ -449,6 +469,7 @@ static void finish_debug_atlas(gl3_context *ctx) {
     render_target_deactivate();
     set_screen_viewport(ctx);
     activate_program(ctx->debug_atlas_prog_id);
+    atlas_bind_page(ctx->atlas, 0);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
 }
@@ -482,8 +503,7 @@ static inline void finish_onscreen(gl3_context *ctx) {
 
 static void render_finish(void *userdata) {
     gl3_context *ctx = userdata;
-    flush_palettes(ctx);
-    flush_remaps(ctx);
+    flush_vga_state(ctx);
     finish_offscreen(ctx);
     if(ctx->draw_atlas) {
         finish_debug_atlas(ctx);
@@ -491,6 +511,8 @@ static void render_finish(void *userdata) {
         finish_onscreen(ctx);
     }
 
+    atlas_frame_done(ctx->atlas);
+
     // Snap screenshot from the freshly rendered state.
     if(ctx->screenshot_cb) {
         capture_screenshot(ctx);
@@ -544,6 +566,11 @@ static void signal_draw_atlas(void *userdata, bool toggle) {
     ctx->draw_atlas = toggle;
 }
 
+static void signal_surface_freed(void *userdata, const surface *sur) {
+    gl3_context *ctx = userdata;
+    atlas_release(ctx->atlas, sur);
+}
+
 static void renderer_create(renderer *gl3_renderer) {
     gl3_renderer->ctx = omf_calloc(1, sizeof(gl3_context));
 }
@@ -576,4 +603,5 @@ void gl3_renderer_set_callbacks(renderer *gl3_renderer) {
     gl3_renderer->capture_screen = capture_screen;
     gl3_renderer->signal_scene_change = signal_scene_change;
     gl3_renderer->signal_draw_atlas = signal_draw_atlas;
+    gl3_renderer->signal_surface_freed = signal_surface_freed;
 }
@@ -40,6 +40,7 @@ typedef struct object_array {
     GLint fans_starts[MAX_FANS];
     GLsizei fans_sizes[MAX_FANS];
     object_array_blend_mode modes[MAX_FANS];
+    uint8_t pages[MAX_FANS]; // Atlas page of each object
 } object_array;
 
 #define ATTRIB(index, stride, step, size, type, normalize)                                                             \
@@ -109,23 +110,29 @@ void object_array_begin(const object_array *array, object_array_batch *state) {
     state->start = 0;
     state->end = 0;
     state->mode = (array->item_count > 0) ? array->modes[0] : MODE_SET;
+    state->page = (array->item_count > 0) ? array->pages[0] : 0;
 }
 
-bool object_array_get_batch(const object_array *array, object_array_batch *state, object_array_blend_mode *mode) {
+bool object_array_get_batch(const object_array *array, object_array_batch *state, object_array_blend_mode *mode,
+                            uint8_t *page) {
     if(state->end >= array->item_count) {
         return false;
     }
     state->start = state->end;
     object_array_blend_mode next;
+    uint8_t next_page;
     do {
         next = array->modes[state->end];
-        if(next != state->mode) {
+        next_page = array->pages[state->end];
+        if(next != state->mode || next_page != state->page) {
             break;
         }
         state->end++;
     } while(state->end < array->item_count);
     *mode = state->mode;
+    *page = state->page;
     state->mode = next;
+    state->page = next_page;
     return true;
 }
 
@@ -148,8 +155,8 @@ void object_array_draw(const object_array *array, object_array_batch *state) {
     ptr.options = options;
 
 static void add_item(object_array *array, float dx, float dy, int x, int y, int w, int h, int tx, int ty, int tw,
-                     int th, int flags, int transparency, int remap_offset, int remap_rounds, int pal_offset,
-                     int pal_limit, int opacity, unsigned int options) {
+                     int th, uint8_t page, int flags, int transparency, int remap_offset, int remap_rounds,
+                     int pal_offset, int pal_limit, int opacity, unsigned int options) {
     float tx0, tx1;
     if(flags & FLIP_HORIZONTAL) {
         tx0 = (tx + tw) * dx;
@@ -181,6 +188,7 @@ static void add_item(object_array *array, float dx, float dy, int x, int y, int
 
     array->fans_starts[array->item_count] = array->item_count * 4;
     array->fans_sizes[array->item_count] = 4;
+    array->pages[array->item_count] = page;
     if(options & SPRITE_DARK_TINT) {
         array->modes[array->item_count] = MODE_DARK_TINT;
     } else if(options & SPRITE_SHADOW) {
@@ -195,15 +203,15 @@ static void add_item(object_array *array, float dx, float dy, int x, int y, int
     array->item_count++;
 }
 
-void object_array_add(object_array *array, int x, int y, int w, int h, int tx, int ty, int tw, int th, int flags,
-                      int transparency, int remap_offset, int remap_rounds, int pal_offset, int pal_limit, int opacity,
-                      unsigned int options) {
+void object_array_add(object_array *array, int x, int y, int w, int h, int tx, int ty, int tw, int th, uint8_t page,
+                      int flags, int transparency, int remap_offset, int remap_rounds, int pal_offset, int pal_limit,
+                      int opacity, unsigned int options) {
     if(array->item_count >= MAX_FANS) {
         log_error("Too many objects!");
         return;
     }
     float dx = 1.0f / array->src_w;
     float dy = 1.0f / array->src_h;
-    add_item(array, dx, dy, x, y, w, h, tx, ty, tw, th, flags, transparency, remap_offset, remap_rounds, pal_offset,
-             pal_limit, opacity, options);
+    add_item(array, dx, dy, x, y, w, h, tx, ty, tw, th, page, flags, transparency, remap_offset, remap_rounds,
+             pal_offset, pal_limit, opacity, options);
 }
@@ -3,6 +3,7 @@
 
 #include "video/enums.h"
 #include <epoxy/gl.h>
+#include <stdint.h>
 
 typedef struct object_array object_array;
 
@@ -19,6 +20,7 @@ typedef struct {
     int start;
     int end;
     object_array_blend_mode mode;
+    uint8_t page;
 } object_array_batch;
 
 object_array *object_array_create(GLfloat src_w, GLfloat src_h);
@@ -27,10 +29,11 @@ void object_array_free(object_array **array);
 void object_array_prepare(object_array *array);
 void object_array_finish(object_array *array);
 void object_array_begin(const object_array *array, object_array_batch *state);
-bool object_array_get_batch(const object_array *array, object_array_batch *state, object_array_blend_mode *mode);
+bool object_array_get_batch(const object_array *array, object_array_batch *state, object_array_blend_mode *mode,
+                            uint8_t *page);
 void object_array_draw(const object_array *array, object_array_batch *state);
-void object_array_add(object_array *array, int x, int y, int w, int h, int tx, int ty, int tw, int th, int flags,
-                      int transparency, int remap_offset, int remap_rounds, int pal_offset, int pal_limit, int opacity,
-                      unsigned int options);
+void object_array_add(object_array *array, int x, int y, int w, int h, int tx, int ty, int tw, int th, uint8_t page,
+                      int flags, int transparency, int remap_offset, int remap_rounds, int pal_offset, int pal_limit,
+                      int opacity, unsigned int options);
 
 #endif // OBJECT_ARRAY_H
@@ -2,9 +2,14 @@
 #include "utils/allocator.h"
 #include "video/renderers/opengl3/helpers/texture.h"
 
+#include <stdbool.h>
+#include <string.h>
+
 typedef struct gl_palette {
     GLuint texture_unit_id;
     GLuint texture_id;
+    vga_palette uploaded; // Copy of the texture contents
+    bool synced;          // True once the whole palette has been uploaded, and the copy can be trusted
 } gl_palette;
 
 gl_palette *gl_palette_create(GLuint texture_unit_id) {
@@ -15,10 +20,27 @@ gl_palette *gl_palette_create(GLuint texture_unit_id) {
     return pal;
 }
 
-void gl_palette_update(const gl_palette *pal, const vga_palette *data, const vga_index first, const vga_index last) {
+void gl_palette_update(gl_palette *pal, upload_ring *ring, const vga_palette *data, vga_index first, vga_index last) {
+    // Palette transforms mark their whole range as damaged on every tick, even when the colors stay the same. Skip
+    // the colors at either end of the range that the texture already has.
+    if(pal->synced) {
+        while(first <= last && memcmp(&pal->uploaded.colors[first], &data->colors[first], sizeof(vga_color)) == 0) {
+            first++;
+        }
+        while(last > first && memcmp(&pal->uploaded.colors[last], &data->colors[last], sizeof(vga_color)) == 0) {
+            last--;
+        }
+        if(first > last) {
+            return;
+        }
+    } else if(first == 0 && last == VGA_PALETTE_SIZE - 1) {
+        pal->synced = true;
+    }
+
     const GLsizei count = last - first + 1;
-    texture_update(pal->texture_unit_id, pal->texture_id, first, 0, count, 1, GL_RGB, GL_UNSIGNED_BYTE,
-                   (const char *)&data->colors[first]);
+    memcpy(&pal->uploaded.colors[first], &data->colors[first], count * sizeof(vga_color));
+    const void *src = upload_ring_write(ring, &data->colors[first], count * sizeof(vga_color));
+    texture_update(pal->texture_unit_id, pal->texture_id, first, 0, count, 1, GL_RGB, GL_UNSIGNED_BYTE, src);
 }
 
 void gl_palette_free(gl_palette **pal) {
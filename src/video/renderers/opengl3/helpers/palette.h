@@ -1,6 +1,7 @@
 #ifndef GL_PALETTE_H
 #define GL_PALETTE_H
 
+#include "video/renderers/opengl3/helpers/upload_ring.h"
 #include "video/vga_palette.h"
 #include <epoxy/gl.h>
 
@@ -15,14 +16,16 @@ typedef struct gl_palette gl_palette;
 gl_palette *gl_palette_create(GLuint texture_unit_id);
 
 /**
- * Upload a range of palette colors to the texture.
+ * Upload a range of palette colors to the texture. Colors at the ends of the range that are already in the texture
+ * are skipped.
  *
  * @param pal Palette object
+ * @param ring Upload ring to stream the colors through
  * @param data Source palette containing the color data
  * @param first First palette index to update (inclusive)
  * @param last Last palette index to update (inclusive)
  */
-void gl_palette_update(const gl_palette *pal, const vga_palette *data, vga_index first, vga_index last);
+void gl_palette_update(gl_palette *pal, upload_ring *ring, const vga_palette *data, vga_index first, vga_index last);
 
 /**
  * Free the palette texture and object. Sets the pointer to NULL.
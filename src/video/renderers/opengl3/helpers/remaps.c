@@ -22,10 +22,11 @@ remaps *remaps_create(const GLuint texture_unit_id) {
     return maps;
 }
 
-void remaps_update(const remaps *remaps, const vga_remap_tables *data) {
+void remaps_update(const remaps *remaps, upload_ring *ring, const vga_remap_tables *data) {
     GLenum type = (sizeof(vga_pixel) == 2) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_BYTE;
+    const void *src = upload_ring_write(ring, data, sizeof(vga_remap_tables));
     texture_update(remaps->texture_unit_id, remaps->texture_id, 0, 0, REMAPS_WIDTH, REMAPS_HEIGHT, GL_RED_INTEGER, type,
-                   data);
+                   src);
 }
 
 void remaps_free(remaps **maps) {
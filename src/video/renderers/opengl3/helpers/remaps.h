@@ -1,6 +1,7 @@
 #ifndef REMAPS_H
 #define REMAPS_H
 
+#include "video/renderers/opengl3/helpers/upload_ring.h"
 #include "video/vga_remap.h"
 #include <epoxy/gl.h>
 
@@ -19,9 +20,10 @@ remaps *remaps_create(GLuint texture_unit_id);
  * Upload all remap tables to the texture.
  *
  * @param remaps Remaps object
+ * @param ring Upload ring to stream the tables through
  * @param data Source remap table data (1024x19 uint16 entries)
  */
-void remaps_update(const remaps *remaps, const vga_remap_tables *data);
+void remaps_update(const remaps *remaps, upload_ring *ring, const vga_remap_tables *data);
 
 /**
  * Free the remap texture and object. Sets the pointer to NULL.
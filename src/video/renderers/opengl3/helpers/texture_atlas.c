@@ -5,38 +5,96 @@
 #include "utils/hashmap.h"
 #include "utils/log.h"
 #include "utils/sprite_packer.h"
+#include "utils/vector.h"
+#include "video/renderers/opengl3/helpers/bindings.h"
 #include "video/renderers/opengl3/helpers/texture.h"
 #include "video/renderers/opengl3/helpers/texture_atlas.h"
 
+#define MAX_PAGES 4
+#define EVICT_FRAMES 120 // A page may be reused once none of its surfaces have been drawn for this many frames
+
 typedef struct {
     uint16_t x;
     uint16_t y;
     uint16_t w;
     uint16_t h;
+    uint16_t page;
 } atlas_entry;
 
-static_assert(8 == sizeof(atlas_entry), "atlas_entry should pack into 8 bytes");
+static_assert(10 == sizeof(atlas_entry), "atlas_entry should pack into 10 bytes");
 
-typedef struct texture_atlas {
-    hashmap items;
+typedef struct {
+    sprite_region region;
+    uint16_t page;
+} released_area;
+
+typedef struct {
     sprite_packer *packer;
     GLuint texture_id;
+    uint32_t last_used; // Frame in which a surface from this page was last drawn
+} atlas_page;
+
+typedef struct texture_atlas {
+    hashmap items;
+    vector released; // Areas of freed surfaces, handed back to the pages once the frame is done
+    atlas_page pages[MAX_PAGES];
+    int page_count;
+    uint32_t frame;
     uint16_t w;
     uint16_t h;
     GLuint tex_unit;
 } texture_atlas;
 
+static void page_create(texture_atlas *atlas) {
+    atlas_page *page = &atlas->pages[atlas->page_count++];
+    GLenum internal_fmt = (sizeof(vga_pixel) == 2) ? GL_R16UI : GL_R8UI;
+    GLenum type = (sizeof(vga_pixel) == 2) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_BYTE;
+    page->packer = sprite_packer_create(atlas->w, atlas->h);
+    page->texture_id =
+        texture_create(atlas->tex_unit, atlas->w, atlas->h, internal_fmt, GL_RED_INTEGER, type, GL_NEAREST);
+    page->last_used = atlas->frame;
+    log_debug("Texture atlas page %d (%dx%d) created", atlas->page_count - 1, atlas->w, atlas->h);
+}
+
+static void page_free(texture_atlas *atlas, atlas_page *page) {
+    sprite_packer_free(&page->packer);
+    texture_free(atlas->tex_unit, page->texture_id);
+    page->texture_id = 0;
+}
+
+/**
+ * Forget everything stored on the page. The texture is kept, the next uploads will simply overwrite it.
+ */
+static void page_evict(texture_atlas *atlas, int index) {
+    iterator it;
+    hashmap_iter_begin(&atlas->items, &it);
+    const hashmap_pair *pair = NULL;
+    foreach(it, pair) {
+        const atlas_entry *entry = pair->value;
+        if(entry->page == index) {
+            hashmap_delete(&atlas->items, &it);
+        }
+    }
+    // The whole page is free now, so released areas on it must not be handed back a second time.
+    for(unsigned i = vector_size(&atlas->released); i > 0; i--) {
+        const released_area *area = vector_get(&atlas->released, i - 1);
+        if(area->page == index) {
+            vector_swapdelete_at(&atlas->released, i - 1);
+        }
+    }
+    sprite_packer_reset(atlas->pages[index].packer);
+    log_debug("Texture atlas page %d evicted", index);
+}
+
 texture_atlas *atlas_create(GLuint tex_unit, uint16_t width, uint16_t height) {
     texture_atlas *atlas = omf_calloc(1, sizeof(texture_atlas));
     hashmap_create(&atlas->items);
-    atlas->packer = sprite_packer_create(width, height);
+    vector_create(&atlas->released, sizeof(released_area));
     atlas->w = width;
     atlas->h = height;
     atlas->tex_unit = tex_unit;
-    GLenum internal_fmt = (sizeof(vga_pixel) == 2) ? GL_R16UI : GL_R8UI;
-    GLenum type = (sizeof(vga_pixel) == 2) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_BYTE;
-    atlas->texture_id = texture_create(tex_unit, width, height, internal_fmt, GL_RED_INTEGER, type, GL_NEAREST);
-    log_debug("Texture atlas %dx%d created", width, height);
+    page_create(atlas);
+    atlas_bind_page(atlas, 0);
     return atlas;
 }
 
@@ -44,29 +102,71 @@ void atlas_free(texture_atlas **atlas) {
     texture_atlas *obj = *atlas;
     if(obj != NULL) {
         hashmap_free(&obj->items);
-        sprite_packer_free(&obj->packer);
-        texture_free(obj->tex_unit, obj->texture_id);
+        vector_free(&obj->released);
+        for(int i = 0; i < obj->page_count; i++) {
+            page_free(obj, &obj->pages[i]);
+        }
         omf_free(obj);
         *atlas = NULL;
         log_debug("Texture atlas freed");
     }
 }
 
-bool atlas_insert(texture_atlas *atlas, const vga_pixel *data, uint16_t w, uint16_t h, uint16_t *nx, uint16_t *ny) {
+/**
+ * Find room for a new area. Existing pages are tried first, then pages that have not been drawn from recently are
+ * evicted, least recently used first. A new page is created only when all pages are in active use.
+ */
+static bool find_region(texture_atlas *atlas, uint16_t w, uint16_t h, sprite_region *region, int *page) {
+    for(int i = 0; i < atlas->page_count; i++) {
+        if(sprite_packer_alloc(atlas->pages[i].packer, w, h, region)) {
+            *page = i;
+            return true;
+        }
+    }
+
+    int oldest = -1;
+    for(int i = 0; i < atlas->page_count; i++) {
+        if(atlas->frame - atlas->pages[i].last_used < EVICT_FRAMES) {
+            continue;
+        }
+        if(oldest < 0 || atlas->pages[i].last_used < atlas->pages[oldest].last_used) {
+            oldest = i;
+        }
+    }
+    if(oldest >= 0) {
+        page_evict(atlas, oldest);
+        *page = oldest;
+        return sprite_packer_alloc(atlas->pages[oldest].packer, w, h, region);
+    }
+
+    if(atlas->page_count < MAX_PAGES) {
+        page_create(atlas);
+        *page = atlas->page_count - 1;
+        return sprite_packer_alloc(atlas->pages[*page].packer, w, h, region);
+    }
+    return false;
+}
+
+bool atlas_insert(texture_atlas *atlas, const vga_pixel *data, uint16_t w, uint16_t h, uint16_t *nx, uint16_t *ny,
+                  uint8_t *npage) {
     sprite_region region;
-    if(!sprite_packer_alloc(atlas->packer, w, h, &region)) {
+    int page;
+    if(w > atlas->w || h > atlas->h || !find_region(atlas, w, h, &region, &page)) {
         log_error("Texture atlas has no room for %dx%d area", w, h);
         return false;
     }
 
     GLenum type = (sizeof(vga_pixel) == 2) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_BYTE;
-    texture_update(atlas->tex_unit, atlas->texture_id, region.x, region.y, w, h, GL_RED_INTEGER, type, data);
+    texture_update(atlas->tex_unit, atlas->pages[page].texture_id, region.x, region.y, w, h, GL_RED_INTEGER, type,
+                   data);
     *nx = region.x;
     *ny = region.y;
+    *npage = page;
     return true;
 }
 
-bool atlas_get(texture_atlas *atlas, const surface *surface, uint16_t *x, uint16_t *y, uint16_t *w, uint16_t *h) {
+bool atlas_get(texture_atlas *atlas, const surface *surface, uint16_t *x, uint16_t *y, uint16_t *w, uint16_t *h,
+               uint8_t *page) {
     // First, check if item is already in the texture atlas. If it is, return coords immediately.
     atlas_entry *coords;
     if(hashmap_get_int(&atlas->items, surface->guid, (void **)&coords, NULL) == 0) {
@@ -74,17 +174,22 @@ bool atlas_get(texture_atlas *atlas, const surface *surface, uint16_t *x, uint16
         *y = coords->y;
         *w = surface->w;
         *h = surface->h;
+        *page = coords->page;
+        atlas->pages[coords->page].last_used = atlas->frame;
         return true;
     }
 
     // If item is NOT in the texture atlas, add it now.
     uint16_t nx, ny;
-    if(atlas_insert(atlas, surface->data, surface->w, surface->h, &nx, &ny)) {
+    uint8_t npage;
+    if(atlas_insert(atlas, surface->data, surface->w, surface->h, &nx, &ny, &npage)) {
         *x = nx;
         *y = ny;
         *w = surface->w;
         *h = surface->h;
-        atlas_entry cached = {nx, ny, surface->w, surface->h};
+        *page = npage;
+        atlas->pages[npage].last_used = atlas->frame;
+        atlas_entry cached = {nx, ny, surface->w, surface->h, npage};
         hashmap_put_int(&atlas->items, surface->guid, &cached, sizeof(atlas_entry));
         return true;
     }
@@ -92,8 +197,42 @@ bool atlas_get(texture_atlas *atlas, const surface *surface, uint16_t *x, uint16
     return false;
 }
 
+void atlas_bind_page(texture_atlas *atlas, uint8_t page) {
+    assert(page < atlas->page_count);
+    bindings_bind_tex(atlas->tex_unit, atlas->pages[page].texture_id);
+}
+
+void atlas_release(texture_atlas *atlas, const surface *surface) {
+    atlas_entry *coords;
+    if(hashmap_get_int(&atlas->items, surface->guid, (void **)&coords, NULL) != 0) {
+        return;
+    }
+    // Draws from the area may still be queued for this frame, so it can't be overwritten yet.
+    released_area area = {.region = {coords->x, coords->y, coords->w, coords->h}, .page = coords->page};
+    vector_append(&atlas->released, &area);
+    hashmap_del_int(&atlas->items, surface->guid);
+}
+
+void atlas_frame_done(texture_atlas *atlas) {
+    iterator it;
+    released_area *area;
+    vector_iter_begin(&atlas->released, &it);
+    foreach(it, area) {
+        sprite_packer_release(atlas->pages[area->page].packer, &area->region);
+    }
+    vector_clear(&atlas->released);
+    atlas->frame++;
+}
+
 void atlas_reset(texture_atlas *atlas) {
+    // Drop the extra pages, so that the next scene gets packed tightly into as few pages as possible.
     hashmap_clear(&atlas->items);
-    sprite_packer_reset(atlas->packer);
+    vector_clear(&atlas->released);
+    while(atlas->page_count > 1) {
+        page_free(atlas, &atlas->pages[--atlas->page_count]);
+    }
+    sprite_packer_reset(atlas->pages[0].packer);
+    atlas->pages[0].last_used = atlas->frame;
+    atlas_bind_page(atlas, 0);
     log_debug("Texture atlas reset");
 }
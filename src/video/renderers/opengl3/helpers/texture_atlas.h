@@ -10,8 +10,13 @@ typedef struct texture_atlas texture_atlas;
 texture_atlas *atlas_create(GLuint tex_unit, uint16_t width, uint16_t height);
 void atlas_free(texture_atlas **atlas);
 
-bool atlas_insert(texture_atlas *atlas, const vga_pixel *data, uint16_t w, uint16_t h, uint16_t *nx, uint16_t *ny);
-bool atlas_get(texture_atlas *atlas, const surface *surface, uint16_t *x, uint16_t *y, uint16_t *w, uint16_t *h);
+bool atlas_insert(texture_atlas *atlas, const vga_pixel *data, uint16_t w, uint16_t h, uint16_t *nx, uint16_t *ny,
+                  uint8_t *npage);
+bool atlas_get(texture_atlas *atlas, const surface *surface, uint16_t *x, uint16_t *y, uint16_t *w, uint16_t *h,
+               uint8_t *page);
+void atlas_bind_page(texture_atlas *atlas, uint8_t page);
+void atlas_release(texture_atlas *atlas, const surface *surface);
+void atlas_frame_done(texture_atlas *atlas);
 void atlas_reset(texture_atlas *atlas);
 
 #endif // TEXTURE_ATLAS_H
@@ -0,0 +1,124 @@
+#include <stdbool.h>
+#include <string.h>
+
+#include "utils/allocator.h"
+#include "utils/log.h"
+#include "video/renderers/opengl3/helpers/upload_ring.h"
+
+#define SEGMENTS 3              // Frames that may be in flight at once
+#define ALIGNMENT 4             // Start every write at an aligned offset
+#define FENCE_TIMEOUT 100000000 // Nanoseconds to wait for the GPU before giving up on a fence
+
+typedef struct upload_ring {
+    GLuint buffer_id;
+    GLsizeiptr segment_size;
+    GLsync fences[SEGMENTS];
+    int segment;         // Segment being written
+    GLsizeiptr used;     // Bytes used in the current segment
+    GLsizeiptr written;  // Bytes uploaded since upload_ring_begin(), including writes that did not fit
+    unsigned char *base; // Persistent mapping of the whole buffer, or NULL
+    bool bound;
+} upload_ring;
+
+upload_ring *upload_ring_create(GLsizeiptr segment_size) {
+    upload_ring *ring = omf_calloc(1, sizeof(upload_ring));
+    ring->segment_size = (segment_size + ALIGNMENT - 1) & ~(GLsizeiptr)(ALIGNMENT - 1);
+    ring->segment = SEGMENTS - 1;
+    const GLsizeiptr total = ring->segment_size * SEGMENTS;
+
+    glGenBuffers(1, &ring->buffer_id);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring->buffer_id);
+    if(epoxy_has_gl_extension("GL_ARB_buffer_storage")) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_PIXEL_UNPACK_BUFFER, total, NULL, flags);
+        ring->base = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, total, flags);
+    } else {
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, total, NULL, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    log_debug("Upload ring of %d bytes created (%s)", (int)total, ring->base ? "persistent" : "mapped per write");
+    return ring;
+}
+
+void upload_ring_begin(upload_ring *ring) {
+    ring->segment = (ring->segment + 1) % SEGMENTS;
+    ring->used = 0;
+    ring->written = 0;
+    GLsync fence = ring->fences[ring->segment];
+    if(fence != NULL) {
+        const GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT);
+        if(result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) {
+            // The GPU may still be reading the segment. Keep the fence for the next time around, and mark the
+            // segment as full so that this frame uploads from client memory.
+            log_warn("Upload ring segment %d is still in use after waiting", ring->segment);
+            ring->used = ring->segment_size;
+            return;
+        }
+        glDeleteSync(fence);
+        ring->fences[ring->segment] = NULL;
+    }
+}
+
+const void *upload_ring_write(upload_ring *ring, const void *data, GLsizeiptr size) {
+    const GLsizeiptr start = (ring->used + ALIGNMENT - 1) & ~(GLsizeiptr)(ALIGNMENT - 1);
+    ring->written += size;
+    if(start + size > ring->segment_size) {
+        if(ring->bound) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            ring->bound = false;
+        }
+        return data;
+    }
+
+    const GLintptr offset = ring->segment * ring->segment_size + start;
+    if(!ring->bound) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring->buffer_id);
+        ring->bound = true;
+    }
+    if(ring->base != NULL) {
+        memcpy(ring->base + offset, data, size);
+    } else {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+        void *dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, offset, size, flags);
+        if(dst == NULL) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            ring->bound = false;
+            return data;
+        }
+        memcpy(dst, data, size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+    ring->used = start + size;
+    return (const void *)offset;
+}
+
+GLsizeiptr upload_ring_end(upload_ring *ring) {
+    if(ring->bound) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        ring->bound = false;
+    }
+    // A segment that was still in use kept its old fence, and nothing was written to it
+    if(ring->used > 0 && ring->fences[ring->segment] == NULL) {
+        ring->fences[ring->segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    return ring->written;
+}
+
+void upload_ring_free(upload_ring **ring) {
+    upload_ring *obj = *ring;
+    if(obj != NULL) {
+        for(int i = 0; i < SEGMENTS; i++) {
+            if(obj->fences[i] != NULL) {
+                glDeleteSync(obj->fences[i]);
+            }
+        }
+        if(obj->base != NULL) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, obj->buffer_id);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        glDeleteBuffers(1, &obj->buffer_id);
+        omf_free(obj);
+        *ring = NULL;
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef UPLOAD_RING_H
+#define UPLOAD_RING_H
+
+#include <epoxy/gl.h>
+
+typedef struct upload_ring upload_ring;
+
+/**
+ * Create a pixel unpack buffer for streaming texture uploads. The buffer is split into one segment per frame in
+ * flight, and a segment is reused only after the GPU has signaled that it is done with it.
+ *
+ * If GL_ARB_buffer_storage is available, the buffer is mapped persistently once. Otherwise each write maps the
+ * segment range unsynchronized, which is safe because of the same fences.
+ *
+ * @param segment_size Maximum number of bytes that can be written per frame
+ * @return Allocated ring object, must be freed with upload_ring_free()
+ */
+upload_ring *upload_ring_create(GLsizeiptr segment_size);
+
+/**
+ * Start writing to the next segment. Waits for the GPU if the segment is still in use. If the wait times out or
+ * fails, the segment is left alone and every write of this frame goes to client memory instead.
+ *
+ * @param ring Ring object
+ */
+void upload_ring_begin(upload_ring *ring);
+
+/**
+ * Copy data to the current segment, and bind the buffer for unpacking.
+ *
+ * @param ring Ring object
+ * @param data Data to upload
+ * @param size Size of the data in bytes
+ * @return Pointer to give to glTexSubImage2D() and friends. This is either an offset into the bound buffer, or if
+ *         the segment is full, the data pointer itself with the buffer unbound.
+ */
+const void *upload_ring_write(upload_ring *ring, const void *data, GLsizeiptr size);
+
+/**
+ * Finish the segment. Fences it if anything was written, and unbinds the buffer, so that other texture uploads
+ * read from client memory again.
+ *
+ * @param ring Ring object
+ * @return Number of bytes uploaded since upload_ring_begin()
+ */
+GLsizeiptr upload_ring_end(upload_ring *ring);
+
+/**
+ * Free the buffer, fences and object. Sets the pointer to NULL.
+ *
+ * @param ring Pointer to ring object pointer
+ */
+void upload_ring_free(upload_ring **ring);
+
+#endif // UPLOAD_RING_H
@@ -50,6 +50,7 @@ typedef void (*capture_screen_fn)(void *ctx, video_screenshot_signal screenshot_
 // Extra signals, implemented only if renderer implementation supports and/or requires it
 typedef void (*signal_scene_change_fn)(void *ctx);
 typedef void (*signal_draw_atlas_fn)(void *ctx, bool toggle);
+typedef void (*signal_surface_freed_fn)(void *ctx, const surface *sur);
 
 struct renderer {
     is_available_fn is_available;
@@ -77,6 +78,7 @@ struct renderer {
 
     signal_scene_change_fn signal_scene_change;
     signal_draw_atlas_fn signal_draw_atlas;
+    signal_surface_freed_fn signal_surface_freed;
 
     void *ctx;
 };
@@ -0,0 +1,507 @@
+#include "video/renderers/software/software_renderer.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "utils/allocator.h"
+#include "utils/log.h"
+#include "utils/miscmath.h"
+#include "video/enums.h"
+#include "video/vga_state.h"
+
+#define NATIVE_W 320
+#define NATIVE_H 200
+#define FB_SIZE (NATIVE_W * NATIVE_H)
+#define MAX_INDEX 1023
+#define MAX_REMAP_ENC 255
+#define MAGIC_REMAP_ROUNDS 12
+#define DARK_TINT_REMAP 4
+#define PHI 1.61803398874989484820459f
+
+// Same as object_array_blend_mode in the OpenGL3 renderer; selects which framebuffer channels a draw writes.
+typedef enum sw_blend_mode
+{
+    SW_MODE_SET = 0,           // index, remap, tint, add
+    SW_MODE_REMAP = 1,         // remap
+    SW_MODE_ADD = 2,           // add
+    SW_MODE_DARK_TINT = 3,     // remap, tint, add
+    SW_MODE_SPRITE_SHADOW = 4, // remap, max blended
+} sw_blend_mode;
+
+typedef struct draw_params {
+    sw_blend_mode mode;
+    int transparent;
+    int remap_offset;
+    int remap_rounds;
+    int palette_offset;
+    int palette_limit;
+    int opacity;
+    unsigned int options;
+} draw_params;
+
+// The paletted framebuffer is stored as one plane per channel of the OpenGL3 renderer's RGBA16 target, and
+// resolved to RGB with the same rules as rgba.frag:
+//   index: palette index
+//   remap: remap_offset + remap_rounds * 19 [+ index]
+//   tint:  dark tint palette index
+//   add:   additive index (index * 60)
+typedef struct sw_context {
+    uint16_t index[FB_SIZE];
+    uint8_t remap[FB_SIZE];
+    uint16_t tint[FB_SIZE];
+    uint16_t add[FB_SIZE];
+    unsigned char rgb[FB_SIZE * 3];
+
+    vga_palette palette;
+    vga_remap_tables remaps;
+    float row_noise[NATIVE_H];
+
+    int screen_w;
+    int screen_h;
+    int fb_scale;
+    bool fullscreen;
+    bool vsync;
+    int aspect;
+    int target_move_x;
+    int target_move_y;
+    unsigned framebuffer_options;
+    SDL_Rect area;
+
+    video_screenshot_signal screenshot_cb;
+} sw_context;
+
+static bool is_available(void) {
+    return true;
+}
+
+static const char *get_description(void) {
+    return "Headless software renderer";
+}
+
+static const char *get_name(void) {
+    return "Software";
+}
+
+static void set_context_state(sw_context *ctx, int window_w, int window_h, bool fullscreen, bool vsync, int aspect,
+                              int fb_scale) {
+    ctx->screen_w = window_w;
+    ctx->screen_h = window_h;
+    ctx->fullscreen = fullscreen;
+    ctx->vsync = vsync;
+    ctx->aspect = aspect;
+    ctx->fb_scale = fb_scale;
+}
+
+static bool setup_context(void *userdata, int window_w, int window_h, bool fullscreen, bool vsync, int aspect,
+                          int framerate_limit, int fb_scale, int scaling_mode) {
+    sw_context *ctx = userdata;
+    set_context_state(ctx, window_w, window_h, fullscreen, vsync, aspect, fb_scale);
+
+    // OMF applied its opacity noise row by row; the row part is the same for every draw, so precalculate it.
+    // Rows are counted from the bottom and sampled at pixel centers, like gl_FragCoord in palette.frag.
+    for(int y = 0; y < NATIVE_H; y++) {
+        ctx->row_noise[y] = tanf(10.0f * PHI * (NATIVE_H - y - 0.5f));
+    }
+
+    vga_state_mark_dirty();
+    log_info("Software Renderer initialized!");
+    return true;
+}
+
+static void get_context_state(void *userdata, int *window_w, int *window_h, bool *fullscreen, bool *vsync, int *aspect,
+                              int *fb_scale) {
+    const sw_context *ctx = userdata;
+    if(window_w != NULL) {
+        *window_w = ctx->screen_w;
+    }
+    if(window_h != NULL) {
+        *window_h = ctx->screen_h;
+    }
+    if(fullscreen != NULL) {
+        *fullscreen = ctx->fullscreen;
+    }
+    if(vsync != NULL) {
+        *vsync = ctx->vsync;
+    }
+    if(aspect != NULL) {
+        *aspect = ctx->aspect;
+    }
+    if(fb_scale != NULL) {
+        *fb_scale = ctx->fb_scale;
+    }
+}
+
+static bool reset_context_with(void *userdata, int window_w, int window_h, bool fullscreen, bool vsync, int aspect,
+                               int framerate_limit, int fb_scale, int scaling_mode) {
+    sw_context *ctx = userdata;
+    set_context_state(ctx, window_w, window_h, fullscreen, vsync, aspect, fb_scale);
+    log_info("Software renderer reset.");
+    return true;
+}
+
+static void reset_context(void *userdata) {
+}
+
+static void close_context(void *userdata) {
+    log_info("Software renderer closed.");
+}
+
+/**
+ * If palette is dirty, copy the changed range. Note that the range is inclusive (dirty area is start <= x <= end).
+ */
+static void flush_palettes(sw_context *ctx) {
+    vga_index first, last;
+    vga_palette *pal;
+    if(vga_state_is_palette_dirty(&pal, &first, &last)) {
+        memcpy(&ctx->palette.colors[first], &pal->colors[first], (last - first + 1) * sizeof(vga_color));
+        vga_state_mark_palette_flushed();
+    }
+}
+
+static void flush_remaps(sw_context *ctx) {
+    vga_remap_tables *tables;
+    if(vga_state_is_remap_dirty(&tables)) {
+        memcpy(&ctx->remaps, tables, sizeof(vga_remap_tables));
+        vga_state_mark_remaps_flushed();
+    }
+}
+
+static inline int remap_lookup(const sw_context *ctx, int table, int index) {
+    if(table < 0 || table >= VGA_REMAP_COUNT || index < 0 || index >= VGA_PALETTE_SIZE) {
+        return 0;
+    }
+    return ctx->remaps.tables[table].data[index];
+}
+
+static sw_blend_mode get_blend_mode(unsigned int options, int remap_rounds) {
+    if(options & SPRITE_DARK_TINT) {
+        return SW_MODE_DARK_TINT;
+    } else if(options & SPRITE_SHADOW) {
+        return SW_MODE_SPRITE_SHADOW;
+    } else if(remap_rounds > 0) {
+        return SW_MODE_REMAP;
+    } else if(options & SPRITE_INDEX_ADD) {
+        return SW_MODE_ADD;
+    }
+    return SW_MODE_SET;
+}
+
+static inline bool is_decimated(const sw_context *ctx, int x, int y, int opacity) {
+    float value = ctx->row_noise[y] + (0x6b * (x + 0.5f)) / 256.0f;
+    value -= floorf(value);
+    return value > opacity / 255.0f;
+}
+
+/**
+ * Fetch the palette index to write for a source pixel, or -1 if the pixel should be discarded.
+ */
+static inline int sample_index(const sw_context *ctx, const draw_params *p, const surface *src, int sx, int sy) {
+    if(p->options & SPRITE_SHADOW) {
+        // make four samples to generate coverage
+        int coverage = 0;
+        for(int row = sy - 1; row <= sy + 2; row++) {
+            if(row >= 0 && row < src->h && src->data[row * src->w + sx] != p->transparent) {
+                coverage++;
+            }
+        }
+        return coverage > 0 ? coverage : -1;
+    }
+
+    int index = src->data[sy * src->w + sx];
+    if(index == p->transparent) {
+        return -1;
+    }
+
+    // Palette offset and limit (for e.g. fonts)
+    if(index <= p->palette_limit) {
+        index = clamp(index + p->palette_offset, 0, p->palette_limit);
+    }
+
+    bool no_remap = (p->options & SPRITE_HAR_QUIRKS) && index > 0x30;
+    if((p->options & SPRITE_REMAP) && !no_remap) {
+        index = remap_lookup(ctx, p->remap_offset, index);
+    }
+    return index;
+}
+
+static inline void write_pixel(sw_context *ctx, const draw_params *p, int pos, int index) {
+    switch(p->mode) {
+        case SW_MODE_SET:
+            ctx->index[pos] = min2(index, MAX_INDEX);
+            ctx->remap[pos] = 0;
+            ctx->tint[pos] = 0;
+            ctx->add[pos] = 0;
+            break;
+        case SW_MODE_REMAP:
+            ctx->remap[pos] = min2(p->remap_offset + p->remap_rounds * VGA_REMAP_COUNT + index, MAX_REMAP_ENC);
+            break;
+        case SW_MODE_ADD:
+            ctx->add[pos] = min2(index * 60, MAX_INDEX);
+            break;
+        case SW_MODE_DARK_TINT:
+            // use magic rounds to detect if dark_tint's remap has been
+            // overwritten by the pause menu's background
+            ctx->remap[pos] = min2(p->remap_offset + MAGIC_REMAP_ROUNDS * VGA_REMAP_COUNT, MAX_REMAP_ENC);
+            ctx->tint[pos] = min2(index, MAX_INDEX);
+            ctx->add[pos] = 0;
+            break;
+        case SW_MODE_SPRITE_SHADOW:
+            // Shadows only ever add remap rounds, so they are max-blended over whatever is below.
+            if(p->remap_rounds > 0) {
+                int remap = min2(p->remap_offset + p->remap_rounds * VGA_REMAP_COUNT + index, MAX_REMAP_ENC);
+                ctx->remap[pos] = max2(ctx->remap[pos], remap);
+            }
+            break;
+    }
+}
+
+/**
+ * Plain opaque row copy. This is the vast majority of all drawn pixels (backgrounds, unremapped sprites), so keep
+ * the loop free of branches to let the compiler vectorize it.
+ */
+static void blit_row_set(sw_context *ctx, int pos, const vga_pixel *src, int count, int transparent) {
+    uint16_t *restrict index = ctx->index + pos;
+    uint8_t *restrict remap = ctx->remap + pos;
+    uint16_t *restrict tint = ctx->tint + pos;
+    uint16_t *restrict add = ctx->add + pos;
+    for(int i = 0; i < count; i++) {
+        bool opaque = src[i] != transparent;
+        index[i] = opaque ? src[i] : index[i];
+        remap[i] = opaque ? 0 : remap[i];
+        tint[i] = opaque ? 0 : tint[i];
+        add[i] = opaque ? 0 : add[i];
+    }
+}
+
+static void blit_row(sw_context *ctx, const draw_params *p, const surface *src, int y, int x0, int x1,
+                     const int *columns, int sy) {
+    for(int x = x0; x < x1; x++) {
+        // Don't render if we're decimating due to opacity
+        if(p->opacity < 255 && is_decimated(ctx, x, y, p->opacity)) {
+            continue;
+        }
+        int index = sample_index(ctx, p, src, columns[x - x0], sy);
+        if(index < 0) {
+            continue;
+        }
+        write_pixel(ctx, p, y * NATIVE_W + x, index);
+    }
+}
+
+static void draw_surface(void *userdata, const surface *src_surface, SDL_Rect *dst, int remap_offset, int remap_rounds,
+                         int palette_offset, int palette_limit, int opacity, unsigned int flip_mode,
+                         unsigned int options) {
+    sw_context *ctx = userdata;
+    const surface *src = src_surface;
+    if(src->data == NULL || src->w <= 0 || src->h <= 0 || dst->w <= 0 || dst->h <= 0) {
+        return;
+    }
+
+    const int x0 = max2(dst->x, 0);
+    const int x1 = min2(dst->x + dst->w, NATIVE_W);
+    const int y0 = max2(dst->y, 0);
+    const int y1 = min2(dst->y + dst->h, NATIVE_H);
+    if(x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    draw_params p;
+    p.mode = get_blend_mode(options, remap_rounds);
+    p.transparent = src->transparent;
+    p.remap_offset = remap_offset;
+    p.remap_rounds = remap_rounds;
+    p.palette_offset = palette_offset;
+    p.palette_limit = palette_limit;
+    p.opacity = opacity;
+    p.options = options;
+
+    // Sample the source at the destination pixel centers, like the nearest neighbour texture lookup does.
+    int columns[NATIVE_W];
+    for(int x = x0; x < x1; x++) {
+        int sx = ((x - dst->x) * 2 + 1) * src->w / (dst->w * 2);
+        columns[x - x0] = (flip_mode & FLIP_HORIZONTAL) ? src->w - 1 - sx : sx;
+    }
+
+    // Plain opaque draws can skip all the per-pixel effect handling. Palette offset 0 is a no-op regardless of limit.
+    const bool plain = p.mode == SW_MODE_SET && opacity >= 255 && palette_offset == 0 &&
+                       !(options & SPRITE_REMAP) && !(flip_mode & FLIP_HORIZONTAL) && dst->w == src->w;
+
+    for(int y = y0; y < y1; y++) {
+        int sy = ((y - dst->y) * 2 + 1) * src->h / (dst->h * 2);
+        if(flip_mode & FLIP_VERTICAL) {
+            sy = src->h - 1 - sy;
+        }
+        if(plain) {
+            blit_row_set(ctx, y * NATIVE_W + x0, src->data + sy * src->w + columns[0], x1 - x0, p.transparent);
+        } else {
+            blit_row(ctx, &p, src, y, x0, x1, columns, sy);
+        }
+    }
+}
+
+static void move_target(void *userdata, int x, int y) {
+    sw_context *ctx = userdata;
+    ctx->target_move_x = x;
+    ctx->target_move_y = y;
+}
+
+static void render_prepare(void *userdata, unsigned framebuffer_options) {
+    sw_context *ctx = userdata;
+    ctx->framebuffer_options = framebuffer_options;
+    flush_remaps(ctx);
+}
+
+/**
+ * Resolve a single framebuffer pixel to a palette index; see rgba.frag.
+ */
+static inline int resolve_index(const sw_context *ctx, int pos) {
+    int idx = ctx->index[pos];
+    int idx_add = ctx->add[pos];
+    int darktint = ctx->tint[pos];
+
+    if(ctx->framebuffer_options & FBUFOPT_CREDITS) {
+        // SPRITE_INDEX_ADD
+        return idx + idx_add;
+    }
+
+    int remap_row = ctx->remap[pos] % VGA_REMAP_COUNT;
+    int remap_rounds = ctx->remap[pos] / VGA_REMAP_COUNT;
+
+    // SPRITE_INDEX_ADD
+    idx += idx_add;
+
+    // SPRITE_DARK_TINT
+    if(darktint > 0 && remap_rounds != MAGIC_REMAP_ROUNDS) {
+        // DARK_TINT's remap got trampled by the pause menu,
+        // so the HAR's color with the pause menu remap.
+        idx = darktint;
+    } else if(darktint >= 0x60) {
+        // pyros flames draw opaque, no remaps.
+        idx = darktint;
+        remap_rounds = 0;
+    } else if(darktint > 0) {
+        // lookup color we're drawing ontop in fifth remap to get brightness
+        int behind = 1 + clamp(remap_lookup(ctx, DARK_TINT_REMAP, idx) - 0xA8, 0, 7) * 2;
+        idx = (darktint & 0xF0) + ((darktint & 0x0F) * 3 + behind * 2) / 5;
+    }
+
+    for(int i = 0; i < remap_rounds; i++) {
+        idx = remap_lookup(ctx, remap_row, idx);
+    }
+    return idx;
+}
+
+/**
+ * Convert paletted framebuffer to RGB, and apply screen shakes.
+ */
+static void resolve_framebuffer(sw_context *ctx) {
+    static const vga_color black = {0, 0, 0};
+    unsigned char *out = ctx->rgb;
+    for(int y = 0; y < NATIVE_H; y++) {
+        // Screen shakes move the viewport; positive y moves the image up, like in the OpenGL3 renderer.
+        int fy = y + ctx->target_move_y;
+        for(int x = 0; x < NATIVE_W; x++) {
+            int fx = x - ctx->target_move_x;
+            const vga_color *c = &black;
+            if(fx >= 0 && fx < NATIVE_W && fy >= 0 && fy < NATIVE_H) {
+                int idx = resolve_index(ctx, fy * NATIVE_W + fx);
+                if(idx < VGA_PALETTE_SIZE) {
+                    c = &ctx->palette.colors[idx];
+                }
+            }
+            *out++ = c->r;
+            *out++ = c->g;
+            *out++ = c->b;
+        }
+    }
+}
+
+static void render_finish(void *userdata) {
+    sw_context *ctx = userdata;
+    flush_palettes(ctx);
+    flush_remaps(ctx);
+    resolve_framebuffer(ctx);
+
+    if(ctx->screenshot_cb) {
+        SDL_Rect r = {0, 0, NATIVE_W, NATIVE_H};
+        ctx->screenshot_cb(&r, ctx->rgb, false);
+        ctx->screenshot_cb = NULL;
+    }
+}
+
+static void render_area_prepare(void *userdata, const SDL_Rect *area) {
+    sw_context *ctx = userdata;
+    ctx->area = *area;
+    flush_remaps(ctx);
+}
+
+static void render_area_finish(void *userdata, surface *dst) {
+    const sw_context *ctx = userdata;
+    const SDL_Rect *r = &ctx->area;
+    surface_create(dst, r->w, r->h);
+    dst->transparent = -1;
+
+    // The area is given with y growing upwards from the bottom of the screen, as with glReadPixels.
+    const int top = NATIVE_H - r->y - r->h;
+    for(int y = 0; y < r->h; y++) {
+        int fy = top + y;
+        if(fy < 0 || fy >= NATIVE_H) {
+            continue;
+        }
+        for(int x = 0; x < r->w; x++) {
+            int fx = r->x + x;
+            if(fx >= 0 && fx < NATIVE_W) {
+                dst->data[y * r->w + x] = (vga_pixel)ctx->index[fy * NATIVE_W + fx];
+            }
+        }
+    }
+}
+
+static void capture_screen(void *userdata, video_screenshot_signal screenshot_cb) {
+    sw_context *ctx = userdata;
+    ctx->screenshot_cb = screenshot_cb;
+}
+
+static void signal_scene_change(void *userdata) {
+}
+
+static void signal_draw_atlas(void *userdata, bool toggle) {
+}
+
+static void signal_surface_freed(void *userdata, const surface *sur) {
+}
+
+static void renderer_create(renderer *sw_renderer) {
+    sw_renderer->ctx = omf_calloc(1, sizeof(sw_context));
+}
+
+static void renderer_destroy(renderer *sw_renderer) {
+    omf_free(sw_renderer->ctx);
+}
+
+void software_renderer_set_callbacks(renderer *sw_renderer) {
+    sw_renderer->is_available = is_available;
+    sw_renderer->get_description = get_description;
+    sw_renderer->get_name = get_name;
+
+    sw_renderer->create = renderer_create;
+    sw_renderer->destroy = renderer_destroy;
+
+    sw_renderer->setup_context = setup_context;
+    sw_renderer->get_context_state = get_context_state;
+    sw_renderer->reset_context_with = reset_context_with;
+    sw_renderer->reset_context = reset_context;
+    sw_renderer->close_context = close_context;
+
+    sw_renderer->draw_surface = draw_surface;
+    sw_renderer->move_target = move_target;
+    sw_renderer->render_prepare = render_prepare;
+    sw_renderer->render_finish = render_finish;
+    sw_renderer->render_area_prepare = render_area_prepare;
+    sw_renderer->render_area_finish = render_area_finish;
+
+    sw_renderer->capture_screen = capture_screen;
+    sw_renderer->signal_scene_change = signal_scene_change;
+    sw_renderer->signal_draw_atlas = signal_draw_atlas;
+    sw_renderer->signal_surface_freed = signal_surface_freed;
+}
@@ -1,15 +1,21 @@
 #include "video/surface.h"
 #include "utils/allocator.h"
 #include "utils/miscmath.h"
+#include <SDL.h>
 #include <stdlib.h>
 
 // Each surface is tagged with a unique key. This is then used for texture atlas.
-// This keeps track of the last index used.
-static unsigned int guid = 0;
+// This keeps track of the last index used. Surfaces are also created by the asset preloader thread, so the
+// counter is atomic.
+static SDL_atomic_t guid;
+
+static unsigned int next_guid(void) {
+    return (unsigned int)SDL_AtomicAdd(&guid, 1);
+}
 
 void surface_create(surface *sur, int w, int h) {
     sur->data = omf_calloc(w * h, sizeof(vga_pixel));
-    sur->guid = guid++;
+    sur->guid = next_guid();
     sur->w = w;
     sur->h = h;
     sur->render_w = w;
@@ -68,7 +74,7 @@ void surface_create_from_flip_scale(surface *sur, const int w, const int h, cons
 
 void surface_set_pixel(surface *sur, int x, int y, vga_index color) {
     sur->data[x + y * sur->w] = color;
-    sur->guid = guid++;
+    sur->guid = next_guid();
 }
 
 void surface_set_transparency(surface *sur, int index) {
@@ -81,7 +87,7 @@ void surface_free(surface *sur) {
 
 void surface_clear(surface *sur) {
     memset(sur->data, 0, sur->w * sur->h * sizeof(vga_pixel));
-    sur->guid = guid++;
+    sur->guid = next_guid();
 }
 
 void surface_create_from(surface *dst, const surface *src) {
@@ -116,7 +122,7 @@ void surface_multiply_decal(surface *src, const surface *decal, int dst_x, int d
             src->data[src_offset] = color | value;
         }
     }
-    src->guid = guid++;
+    src->guid = next_guid();
 }
 
 // Copies a an area of old surface to an entirely new surface
@@ -137,7 +143,7 @@ void surface_sub(surface *dst, const surface *src, int dst_x, int dst_y, int src
             dst->data[dst_offset] = src->data[src_offset];
         }
     }
-    dst->guid = guid++;
+    dst->guid = next_guid();
 }
 
 void surface_flatten_to_mask(surface *sur, uint8_t value) {
@@ -148,7 +154,7 @@ void surface_flatten_to_mask(surface *sur, uint8_t value) {
         }
         sur->data[i] = value;
     }
-    sur->guid = guid++;
+    sur->guid = next_guid();
 }
 
 void surface_convert_har_to_grayscale(surface *sur, uint8_t brightness) {
@@ -158,7 +164,7 @@ void surface_convert_har_to_grayscale(surface *sur, uint8_t brightness) {
             sur->data[i] = 0xD0 + brightness * (idx % 0x10) / 0x0F;
         }
     }
-    sur->guid = guid++;
+    sur->guid = next_guid();
 }
 
 void surface_compress_index_blocks(surface *sur, int range_start, int range_end, int block_size, int amount) {
@@ -171,7 +177,7 @@ void surface_compress_index_blocks(surface *sur, int range_start, int range_end,
             sur->data[i] = idx - old_idx + new_idx;
         }
     }
-    sur->guid = guid++;
+    sur->guid = next_guid();
 }
 
 void surface_compress_remap(surface *sur, int range_start, int range_end, int remap_to, int amount) {
@@ -185,7 +191,7 @@ void surface_compress_remap(surface *sur, int range_start, int range_end, int re
             }
         }
     }
-    sur->guid = guid++;
+    sur->guid = next_guid();
 }
 
 static vga_index find_closest_gray(const vga_palette *pal, const vga_index range_start, const vga_index range_end,
@@ -11,6 +11,9 @@
 #ifdef ENABLE_NULL_RENDERER
 #include "video/renderers/null/null_renderer.h"
 #endif
+#ifdef ENABLE_SOFTWARE_RENDERER
+#include "video/renderers/software/software_renderer.h"
+#endif
 
 #define MAX_AVAILABLE_RENDERERS 8 ///< Maximum number of renderers that can be registered
 
@@ -20,15 +23,26 @@
  */
 typedef void (*renderer_init)(renderer *renderer);
 
+/**
+ * @brief Built-in renderer
+ */
+typedef struct builtin_renderer {
+    renderer_init set_callbacks; ///< Callback to set up renderer function pointers
+    bool headless;               ///< Shows nothing on screen. Only used when asked for by name.
+} builtin_renderer;
+
 /**
  * List of all built-in renderers. Most preferred renderers at the top.
  */
-static renderer_init all_renderers[] = {
+static const builtin_renderer all_renderers[] = {
 #ifdef ENABLE_OPENGL3_RENDERER
-    gl3_renderer_set_callbacks,
+    {gl3_renderer_set_callbacks,      false},
 #endif
 #ifdef ENABLE_NULL_RENDERER
-    null_renderer_set_callbacks,
+    {null_renderer_set_callbacks,     true },
+#endif
+#ifdef ENABLE_SOFTWARE_RENDERER
+    {software_renderer_set_callbacks, true },
 #endif
 };
 static int all_renderers_count = N_ELEMENTS(all_renderers); ///< Count of built-in renderers
@@ -40,6 +54,7 @@ static struct available_renderer {
     renderer_init set_callbacks; ///< Callback to set up renderer function pointers
     const char *name;            ///< Renderer name
     const char *description;     ///< Renderer description
+    bool headless;               ///< Shows nothing on screen
 } available_renderers[MAX_AVAILABLE_RENDERERS];
 static int renderer_count = 0; ///< Number of available renderers
 
@@ -54,14 +69,15 @@ void video_scan_renderers(void) {
     renderer tmp;
     renderer_count = 0;
     for(int i = 0; i < all_renderers_count; i++) {
-        all_renderers[i](&tmp);
+        all_renderers[i].set_callbacks(&tmp);
         if(renderer_count >= MAX_AVAILABLE_RENDERERS) {
             break;
         }
         if(tmp.is_available()) {
-            available_renderers[renderer_count].set_callbacks = all_renderers[i];
+            available_renderers[renderer_count].set_callbacks = all_renderers[i].set_callbacks;
             available_renderers[renderer_count].name = tmp.get_name();
             available_renderers[renderer_count].description = tmp.get_description();
+            available_renderers[renderer_count].headless = all_renderers[i].headless;
             log_debug("Renderer '%s' is available", available_renderers[renderer_count].name);
             renderer_count++;
         }
@@ -88,6 +104,18 @@ bool video_get_renderer_info(int index, const char **name, const char **descript
     return true;
 }
 
+/**
+ * @brief Check if a renderer shows nothing on screen
+ * @param index Renderer index
+ * @return true if the renderer is headless, or if index is out of range
+ */
+bool video_is_renderer_headless(int index) {
+    if(index < 0 || index >= renderer_count) {
+        return true;
+    }
+    return available_renderers[index].headless;
+}
+
 /**
  * @brief Get the number of currently available renderers
  * @return Number of available renderers
@@ -115,14 +143,17 @@ static bool hunt_renderer_by_name(const char *try_name) {
 /**
  * @brief Find the best available renderer
  *
- * Selects the first available renderer as the best option.
+ * Selects the first available renderer as the best option. Headless renderers are never picked here, as the
+ * player would be left without a window to look at.
  *
  * @return true if a renderer was found and set as current, false otherwise
  */
 static bool find_best_renderer(void) {
-    if(renderer_count > 0) {
-        available_renderers[0].set_callbacks(&current_renderer);
-        return true;
+    for(int i = 0; i < renderer_count; i++) {
+        if(!available_renderers[i].headless) {
+            available_renderers[i].set_callbacks(&current_renderer);
+            return true;
+        }
     }
     return false;
 }
@@ -208,6 +239,7 @@ void video_render_area_finish(surface *dst) {
 void video_close(void) {
     current_renderer.close_context(current_renderer.ctx);
     current_renderer.destroy(&current_renderer);
+    memset(&current_renderer, 0, sizeof(renderer));
 }
 
 void video_move_target(int x, int y) {
@@ -218,6 +250,13 @@ void video_get_state(int *w, int *h, bool *fs, bool *vsync, int *aspect, int *fb
     current_renderer.get_context_state(current_renderer.ctx, w, h, fs, vsync, aspect, fb_scale);
 }
 
+void video_signal_surface_freed(const surface *sur) {
+    // Surfaces may outlive the renderer, eg. when it is switched from the video menu.
+    if(current_renderer.signal_surface_freed != NULL) {
+        current_renderer.signal_surface_freed(current_renderer.ctx, sur);
+    }
+}
+
 void video_schedule_screenshot(video_screenshot_signal callback) {
     current_renderer.capture_screen(current_renderer.ctx, callback);
 }
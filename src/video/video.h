@@ -42,6 +42,15 @@ int video_get_renderer_count(void);
  */
 bool video_get_renderer_info(int index, const char **name, const char **description);
 
+/**
+ * @brief Check if a renderer is headless
+ * @details Headless renderers (NULL, Software) show nothing on screen. They are meant for tests and exports, are
+ *          never picked automatically, and should not be offered to the player.
+ * @param index Renderer index (0 to video_get_renderer_count()-1)
+ * @return true if the renderer is headless, or if index is out of range
+ */
+bool video_is_renderer_headless(int index);
+
 /**
  * @brief Initialize the video subsystem
  * @param try_name Preferred renderer name (NULL to use the best available)
@@ -209,6 +218,14 @@ void video_close(void);
  */
 void video_schedule_screenshot(video_screenshot_signal callback);
 
+/**
+ * @brief Tell the renderer that a surface is about to be freed, so that it can drop its copy of the pixels
+ * @details Only worth calling for surfaces that are replaced often. Others are dropped when the scene changes, or
+ *          when the renderer needs the room.
+ * @param sur Surface that will not be drawn again
+ */
+void video_signal_surface_freed(const surface *sur);
+
 /**
  * @brief Toggle atlas debug visualization
  * @param draw_atlas true to enable atlas drawing, false to disable
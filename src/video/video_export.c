@@ -0,0 +1,367 @@
+#include "video/video_export.h"
+#include "utils/allocator.h"
+#include "utils/log.h"
+#include "utils/png_writer.h"
+#include "video/video.h"
+
+#include <SDL.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+#define QUEUE_SIZE 16 // Max frames and audio blocks waiting for the encoder thread
+#define WAV_HEADER_SIZE 44
+
+typedef enum export_format
+{
+    EXPORT_Y4M,
+    EXPORT_PNG,
+} export_format;
+
+typedef enum export_item_type
+{
+    ITEM_FRAME,
+    ITEM_AUDIO,
+} export_item_type;
+
+typedef struct export_item {
+    export_item_type type;
+    int w;
+    int h;
+    unsigned char *data;
+    size_t size;
+} export_item;
+
+typedef struct video_export {
+    export_format format;
+    path filename;
+    FILE *video_fp;
+    FILE *audio_fp;
+    bool to_stdout;
+    int fps;
+    int sample_rate;
+    int channels;
+
+    // Only touched by the encoder thread while it is running.
+    int frame_w;
+    int frame_h;
+    uint64_t frames;
+    uint64_t audio_bytes;
+    unsigned char *planes;
+
+    SDL_Thread *thread;
+    SDL_mutex *lock;
+    SDL_cond *not_empty;
+    SDL_cond *not_full;
+    export_item queue[QUEUE_SIZE];
+    int head;
+    int count;
+    bool closing;
+} video_export;
+
+static video_export *exporter = NULL;
+
+static void write_u16_le(FILE *fp, uint16_t value) {
+    fputc(value & 0xFF, fp);
+    fputc((value >> 8) & 0xFF, fp);
+}
+
+static void write_u32_le(FILE *fp, uint32_t value) {
+    write_u16_le(fp, value & 0xFFFF);
+    write_u16_le(fp, value >> 16);
+}
+
+static void write_wav_header(FILE *fp, int sample_rate, int channels, uint32_t data_size) {
+    fwrite("RIFF", 1, 4, fp);
+    write_u32_le(fp, WAV_HEADER_SIZE - 8 + data_size);
+    fwrite("WAVEfmt ", 1, 8, fp);
+    write_u32_le(fp, 16);                         // fmt chunk size
+    write_u16_le(fp, 1);                          // PCM
+    write_u16_le(fp, channels);                   // channels
+    write_u32_le(fp, sample_rate);                // sample rate
+    write_u32_le(fp, sample_rate * channels * 2); // byte rate
+    write_u16_le(fp, channels * 2);               // block align
+    write_u16_le(fp, 16);                         // bits per sample
+    fwrite("data", 1, 4, fp);
+    write_u32_le(fp, data_size);
+}
+
+/**
+ * Convert an RGB frame to full resolution (4:4:4) BT.601 YCbCr planes, and write it as a Y4M frame.
+ */
+static void write_y4m_frame(video_export *ex, const export_item *item) {
+    if(ex->frames == 0) {
+        fprintf(ex->video_fp, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", item->w, item->h, ex->fps);
+    }
+    const int pixels = item->w * item->h;
+    unsigned char *y_plane = ex->planes;
+    unsigned char *u_plane = ex->planes + pixels;
+    unsigned char *v_plane = ex->planes + pixels * 2;
+    const unsigned char *rgb = item->data;
+    for(int i = 0; i < pixels; i++) {
+        const int r = rgb[i * 3 + 0];
+        const int g = rgb[i * 3 + 1];
+        const int b = rgb[i * 3 + 2];
+        // Offsets are added before shifting, so that the shifted values are never negative.
+        y_plane[i] = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+        u_plane[i] = (-38 * r - 74 * g + 112 * b + 128 * 256 + 128) >> 8;
+        v_plane[i] = (112 * r - 94 * g - 18 * b + 128 * 256 + 128) >> 8;
+    }
+    fputs("FRAME\n", ex->video_fp);
+    fwrite(ex->planes, 1, pixels * 3, ex->video_fp);
+}
+
+static void write_png_frame(const video_export *ex, const export_item *item) {
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), "_%06" PRIu64 ".png", ex->frames);
+    path filename = ex->filename;
+    path_set_ext(&filename, suffix);
+    if(!write_rgb_png(&filename, item->w, item->h, item->data, false, false)) {
+        log_error("Unable to write exported frame %s", path_c(&filename));
+    }
+}
+
+static void encode_item(video_export *ex, const export_item *item) {
+    if(item->type == ITEM_AUDIO) {
+        fwrite(item->data, 1, item->size, ex->audio_fp);
+        ex->audio_bytes += item->size;
+        return;
+    }
+
+    // All frames must be the same size; the first frame decides.
+    if(ex->frames == 0) {
+        ex->frame_w = item->w;
+        ex->frame_h = item->h;
+        ex->planes = omf_malloc(item->w * item->h * 3);
+    } else if(item->w != ex->frame_w || item->h != ex->frame_h) {
+        log_warn("Dropping exported frame with size %dx%d, expected %dx%d", item->w, item->h, ex->frame_w,
+                 ex->frame_h);
+        return;
+    }
+    if(ex->format == EXPORT_Y4M) {
+        write_y4m_frame(ex, item);
+    } else {
+        write_png_frame(ex, item);
+    }
+    ex->frames++;
+}
+
+static int encoder_thread(void *userdata) {
+    video_export *ex = userdata;
+    while(true) {
+        SDL_LockMutex(ex->lock);
+        while(ex->count == 0 && !ex->closing) {
+            SDL_CondWait(ex->not_empty, ex->lock);
+        }
+        if(ex->count == 0) {
+            SDL_UnlockMutex(ex->lock);
+            break;
+        }
+        export_item item = ex->queue[ex->head];
+        ex->head = (ex->head + 1) % QUEUE_SIZE;
+        ex->count--;
+        SDL_CondSignal(ex->not_full);
+        SDL_UnlockMutex(ex->lock);
+
+        encode_item(ex, &item);
+        omf_free(item.data);
+    }
+    return 0;
+}
+
+/**
+ * Hand an item over to the encoder thread. Blocks if the encoder has fallen too far behind.
+ */
+static void push_item(video_export *ex, const export_item *item) {
+    SDL_LockMutex(ex->lock);
+    while(ex->count == QUEUE_SIZE) {
+        SDL_CondWait(ex->not_full, ex->lock);
+    }
+    ex->queue[(ex->head + ex->count) % QUEUE_SIZE] = *item;
+    ex->count++;
+    SDL_CondSignal(ex->not_empty);
+    SDL_UnlockMutex(ex->lock);
+}
+
+static bool open_audio(video_export *ex) {
+    if(ex->to_stdout) {
+        log_warn("Audio is not exported when writing video to stdout");
+        ex->sample_rate = 0;
+        return true;
+    }
+    path filename = ex->filename;
+    path_set_ext(&filename, ".wav");
+    if((ex->audio_fp = path_fopen(&filename, "wb")) == NULL) {
+        log_error("Unable to open audio export file %s", path_c(&filename));
+        return false;
+    }
+    // Sizes are not known yet; the header is rewritten when closing.
+    write_wav_header(ex->audio_fp, ex->sample_rate, ex->channels, 0);
+    log_info("Exporting audio to %s", path_c(&filename));
+    return true;
+}
+
+bool video_export_open(const path *filename, int fps, int sample_rate, int channels) {
+    if(exporter != NULL) {
+        log_error("Video export is already running");
+        return false;
+    }
+
+    video_export *ex = omf_calloc(1, sizeof(video_export));
+    ex->filename = *filename;
+    ex->fps = fps;
+    ex->sample_rate = sample_rate;
+    ex->channels = channels;
+    ex->to_stdout = strcmp(path_c(filename), "-") == 0;
+
+    str ext;
+    path_ext(filename, &ext);
+    if(ex->to_stdout || str_equal_c(&ext, ".y4m")) {
+        ex->format = EXPORT_Y4M;
+    } else if(str_equal_c(&ext, ".png")) {
+        ex->format = EXPORT_PNG;
+    } else {
+        log_error("Unknown video export format '%s', use .y4m or .png", str_c(&ext));
+        str_free(&ext);
+        goto error_0;
+    }
+    str_free(&ext);
+
+    if(ex->to_stdout) {
+        ex->video_fp = stdout;
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    } else if(ex->format == EXPORT_Y4M && (ex->video_fp = path_fopen(filename, "wb")) == NULL) {
+        log_error("Unable to open video export file %s", path_c(filename));
+        goto error_0;
+    }
+    if(ex->sample_rate > 0 && !open_audio(ex)) {
+        goto error_1;
+    }
+
+    ex->lock = SDL_CreateMutex();
+    ex->not_empty = SDL_CreateCond();
+    ex->not_full = SDL_CreateCond();
+    ex->thread = SDL_CreateThread(encoder_thread, "video export", ex);
+    if(ex->thread == NULL) {
+        log_error("Unable to start video export thread: %s", SDL_GetError());
+        goto error_2;
+    }
+
+    log_info("Exporting video to %s at %d fps", path_c(filename), fps);
+    exporter = ex;
+    return true;
+
+error_2:
+    SDL_DestroyCond(ex->not_full);
+    SDL_DestroyCond(ex->not_empty);
+    SDL_DestroyMutex(ex->lock);
+    if(ex->audio_fp != NULL) {
+        fclose(ex->audio_fp);
+    }
+error_1:
+    if(ex->video_fp != NULL && !ex->to_stdout) {
+        fclose(ex->video_fp);
+    }
+error_0:
+    omf_free(ex);
+    return false;
+}
+
+bool video_export_is_open(void) {
+    return exporter != NULL;
+}
+
+int video_export_get_fps(void) {
+    return exporter != NULL ? exporter->fps : 0;
+}
+
+bool video_export_is_stdout(void) {
+    return exporter != NULL && exporter->to_stdout;
+}
+
+static void export_screenshot(const SDL_Rect *rect, unsigned char *data, bool flipped) {
+    if(exporter == NULL) {
+        return;
+    }
+    export_item item;
+    item.type = ITEM_FRAME;
+    item.w = rect->w;
+    item.h = rect->h;
+    item.size = rect->w * rect->h * 3;
+    item.data = omf_malloc(item.size);
+
+    // Screenshot data is only valid during the callback, so take a copy. Flip it upright while at it.
+    const size_t pitch = rect->w * 3;
+    for(int y = 0; y < rect->h; y++) {
+        int src_y = flipped ? rect->h - y - 1 : y;
+        memcpy(item.data + y * pitch, data + src_y * pitch, pitch);
+    }
+    push_item(exporter, &item);
+}
+
+void video_export_capture_frame(void) {
+    if(exporter != NULL) {
+        video_schedule_screenshot(export_screenshot);
+    }
+}
+
+void video_export_push_audio(const int16_t *samples, int frames) {
+    if(exporter == NULL || exporter->audio_fp == NULL || frames <= 0) {
+        return;
+    }
+    export_item item;
+    item.type = ITEM_AUDIO;
+    item.w = 0;
+    item.h = 0;
+    item.size = frames * exporter->channels * sizeof(int16_t);
+    item.data = omf_malloc(item.size);
+
+    // WAV data is little endian.
+    unsigned char *out = item.data;
+    for(int i = 0; i < frames * exporter->channels; i++) {
+        uint16_t sample = (uint16_t)samples[i];
+        *out++ = sample & 0xFF;
+        *out++ = sample >> 8;
+    }
+    push_item(exporter, &item);
+}
+
+void video_export_close(void) {
+    video_export *ex = exporter;
+    if(ex == NULL) {
+        return;
+    }
+    exporter = NULL;
+
+    // Let the encoder drain the queue, then stop it.
+    SDL_LockMutex(ex->lock);
+    ex->closing = true;
+    SDL_CondSignal(ex->not_empty);
+    SDL_UnlockMutex(ex->lock);
+    SDL_WaitThread(ex->thread, NULL);
+
+    if(ex->audio_fp != NULL) {
+        fseek(ex->audio_fp, 0, SEEK_SET);
+        write_wav_header(ex->audio_fp, ex->sample_rate, ex->channels, ex->audio_bytes);
+        fclose(ex->audio_fp);
+    }
+    if(ex->to_stdout) {
+        fflush(stdout);
+    } else if(ex->video_fp != NULL) {
+        fclose(ex->video_fp);
+    }
+    log_info("Exported %" PRIu64 " frames and %" PRIu64 " bytes of audio", ex->frames, ex->audio_bytes);
+
+    SDL_DestroyCond(ex->not_full);
+    SDL_DestroyCond(ex->not_empty);
+    SDL_DestroyMutex(ex->lock);
+    omf_free(ex->planes);
+    omf_free(ex);
+}
@@ -0,0 +1,66 @@
+/**
+ * @file video_export.h
+ * @brief Offline export of rendered frames and audio to files
+ * @details Frames are captured from the renderer via screenshots, and audio is pushed in by the caller. Encoding and
+ *          file writes happen on a separate thread, so that the simulation can keep running while earlier frames are
+ *          being written. Output format is selected by the file extension:
+ *          - ".y4m" writes a YUV4MPEG2 stream (or to stdout, if the filename is "-")
+ *          - ".png" writes one numbered PNG file per frame
+ *          Audio is written as 16 bit PCM to a WAV file next to the video file.
+ * @copyright MIT License
+ * @date 2026
+ * @author OpenOMF Project
+ */
+
+#ifndef VIDEO_EXPORT_H
+#define VIDEO_EXPORT_H
+
+#include "utils/path.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Start an export.
+ * @param filename Output file, or "-" for a Y4M stream to stdout
+ * @param fps Frame rate of the exported video
+ * @param sample_rate Audio sample rate, or 0 to not export audio
+ * @param channels Audio channel count (1 or 2)
+ * @return true on success, false if the output could not be opened
+ */
+bool video_export_open(const path *filename, int fps, int sample_rate, int channels);
+
+/**
+ * @brief Check if an export is running.
+ */
+bool video_export_is_open(void);
+
+/**
+ * @brief Frame rate of the running export.
+ */
+int video_export_get_fps(void);
+
+/**
+ * @brief Check if the running export writes to stdout.
+ */
+bool video_export_is_stdout(void);
+
+/**
+ * @brief Capture the next rendered frame into the export.
+ * @details Must be called before video_render_finish() of the frame to capture.
+ */
+void video_export_capture_frame(void);
+
+/**
+ * @brief Append interleaved 16 bit audio samples to the export.
+ * @param samples Sample data, in the format given to video_export_open
+ * @param frames Number of sample frames (samples per channel)
+ */
+void video_export_push_audio(const int16_t *samples, int frames);
+
+/**
+ * @brief Finish writing all queued data, and close the export.
+ */
+void video_export_close(void);
+
+#endif // VIDEO_EXPORT_H
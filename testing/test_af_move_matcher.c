@@ -0,0 +1,92 @@
+#include "common.h"
+#include "resources/af.h"
+#include "resources/af_move_matcher.h"
+#include <string.h>
+
+static const char *move_strings[] = {"K", "P", "K2", "K21", "P236", "K3", "P2", "K21", "!", ""};
+#define MOVE_COUNT (int)(sizeof(move_strings) / sizeof(move_strings[0]))
+
+static af_move moves[MOVE_COUNT];
+
+static void make_af(af *a) {
+    memset(a, 0, sizeof(af));
+    array_create(&a->moves);
+    for(int i = 0; i < MOVE_COUNT; i++) {
+        memset(&moves[i], 0, sizeof(af_move));
+        moves[i].id = i;
+        moves[i].category = i % 3;
+        str_from_c(&moves[i].move_string, move_strings[i]);
+        array_set(&a->moves, i, &moves[i]);
+    }
+    af_move_matcher_create(&a->matcher);
+    af_move_matcher_build(&a->matcher, a);
+}
+
+static void free_af(af *a) {
+    for(int i = 0; i < MOVE_COUNT; i++) {
+        str_free(&moves[i].move_string);
+    }
+    af_move_matcher_free(&a->matcher);
+    array_free(&a->moves);
+}
+
+// Check the matcher against the plain string comparison it replaces.
+static void check_match(const af *a, char prefix, const char *inputs) {
+    af_move_set set;
+    af_move_matcher_match(&a->matcher, prefix, inputs, &set);
+    for(int i = 0; i < MOVE_COUNT; i++) {
+        const str *s = &moves[i].move_string;
+        size_t len = str_size(s);
+        bool expected = len > 0 && str_at(s, 0) == prefix && (len == 1 || !strncmp(str_c(s) + 1, inputs, len - 1));
+        bool found = set.bits[i / 64] & ((uint64_t)1 << (i % 64));
+        CU_ASSERT_EQUAL(found, expected);
+    }
+}
+
+void test_af_move_matcher_match(void) {
+    af a;
+    make_af(&a);
+    check_match(&a, 'K', "");
+    check_match(&a, 'K', "2");
+    check_match(&a, 'K', "21");
+    check_match(&a, 'K', "2136");
+    check_match(&a, 'K', "3");
+    check_match(&a, 'P', "23");
+    check_match(&a, 'P', "236");
+    check_match(&a, 'P', "2365");
+    check_match(&a, 1, "21");
+    free_af(&a);
+}
+
+void test_af_move_matcher_order(void) {
+    af a;
+    make_af(&a);
+    af_move_set set;
+    af_move_matcher_match(&a.matcher, 'K', "21", &set);
+    CU_ASSERT_EQUAL(af_move_set_next(&set, 0), 0);
+    CU_ASSERT_EQUAL(af_move_set_next(&set, 1), 2);
+    CU_ASSERT_EQUAL(af_move_set_next(&set, 3), 3);
+    CU_ASSERT_EQUAL(af_move_set_next(&set, 4), 7);
+    CU_ASSERT_EQUAL(af_move_set_next(&set, 8), -1);
+    free_af(&a);
+}
+
+void test_af_move_matcher_category(void) {
+    af a;
+    make_af(&a);
+    af_move_set set;
+    af_move_matcher_category(&a.matcher, 1, &set);
+    int expected = 1;
+    for(int i = af_move_set_next(&set, 0); i != -1; i = af_move_set_next(&set, i + 1)) {
+        CU_ASSERT_EQUAL(i, expected);
+        expected += 3;
+    }
+    CU_ASSERT_EQUAL(expected, 10);
+    free_af(&a);
+}
+
+void af_move_matcher_test_suite(CU_pSuite suite) {
+    ADD_TEST("Test move matching", test_af_move_matcher_match);
+    ADD_TEST("Test move match order", test_af_move_matcher_order);
+    ADD_TEST("Test moves by category", test_af_move_matcher_category);
+}
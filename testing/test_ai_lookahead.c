@@ -0,0 +1,161 @@
+#include "common.h"
+#include "controller/ai_lookahead.h"
+#include "game/common_defines.h"
+#include "game/game_player.h"
+#include "game/game_state.h"
+#include "game/objects/har.h"
+#include "game/protos/object.h"
+#include "game/protos/scene.h"
+#include "utils/random.h"
+
+#include <SDL.h>
+#include <string.h>
+
+#define CLONE_DELAY_MS 40 // Time a scene clone takes, see slow_clone()
+#define BUDGET_US 20000   // Less than CLONE_DELAY_MS, so every clone is out of time before its first tick
+
+static SDL_atomic_t clones;
+static SDL_atomic_t clone_frees;
+
+// Cloning a real arena takes a while, this makes the first clone use up the whole budget.
+static void slow_clone(scene *src, scene *dst) {
+    SDL_AtomicIncRef(&clones);
+    SDL_Delay(CLONE_DELAY_MS);
+}
+
+// Clones may be freed on the calling thread, so use up some of its random numbers.
+static void counting_clone_free(scene *sc) {
+    SDL_AtomicIncRef(&clone_frees);
+    rand_int(100);
+}
+
+// A bare game state with an arena scene and two HARs, and nothing that needs resources. Never ticked.
+static void create_arena_state(game_state *gs, scene *sc, game_player players[2], object objs[2], har hars[2]) {
+    memset(gs, 0, sizeof(game_state));
+    vector_create(&gs->objects, sizeof(render_obj));
+    object_index_create(&gs->object_index);
+    sound_tracker_create(&gs->tracker);
+    random_seed(&gs->rand, 1234);
+
+    memset(sc, 0, sizeof(scene));
+    sc->id = SCENE_ARENA0;
+    sc->gs = gs;
+    ticktimer_init(&sc->tick_timer);
+    sc->clone = slow_clone;
+    sc->clone_free = counting_clone_free;
+    gs->sc = sc;
+
+    for(int i = 0; i < 2; i++) {
+        memset(&players[i], 0, sizeof(game_player));
+        players[i].score.total = text_create();
+        list_create(&players[i].score.texts);
+        gs->players[i] = &players[i];
+
+        // Objects are allocated zeroed in the game, and object_create() relies on that
+        memset(&objs[i], 0, sizeof(object));
+        object_create(&objs[i], gs, vec2i_create(100 + 100 * i, 190), vec2f_create(0, 0));
+        game_state_add_object(gs, &objs[i], RENDER_LAYER_MIDDLE, 0, 0);
+        memset(&hars[i], 0, sizeof(har));
+        hars[i].player_id = i;
+        hars[i].health_max = 100;
+        hars[i].health = 100;
+        object_set_userdata(&objs[i], &hars[i]);
+        players[i].har_obj_id = objs[i].id;
+    }
+}
+
+static void free_arena_state(game_state *gs, scene *sc, game_player players[2], object objs[2]) {
+    for(int i = 0; i < 2; i++) {
+        object_free(&objs[i]);
+        chr_score_free(&players[i].score);
+    }
+    ticktimer_close(&sc->tick_timer);
+    sound_tracker_free(&gs->tracker);
+    object_index_free(&gs->object_index);
+    vector_free(&gs->objects);
+}
+
+static void init_candidates(ai_lookahead_candidate *candidates, int count) {
+    for(int i = 0; i < count; i++) {
+        ai_lookahead_candidate_init(&candidates[i]);
+        ai_lookahead_add_event(&candidates[i], 0, ACT_PUNCH);
+        candidates[i].evaluated = true; // Must be cleared by the run
+    }
+}
+
+void test_ai_lookahead_disabled(void) {
+    game_state gs;
+    scene sc;
+    game_player players[2];
+    object objs[2];
+    har hars[2];
+    ai_lookahead_candidate candidates[4];
+    create_arena_state(&gs, &sc, players, objs, hars);
+    SDL_AtomicSet(&clones, 0);
+
+    // Without the pool nothing is evaluated
+    CU_ASSERT_FALSE(ai_lookahead_enabled());
+    init_candidates(candidates, 4);
+    CU_ASSERT_EQUAL(ai_lookahead_run(&gs, 0, candidates, 4, 10, 1000000), 0);
+
+    // Outside the arena neither
+    ai_lookahead_init();
+    CU_ASSERT_TRUE(ai_lookahead_enabled());
+    sc.id = SCENE_MENU;
+    init_candidates(candidates, 4);
+    CU_ASSERT_EQUAL(ai_lookahead_run(&gs, 0, candidates, 4, 10, 1000000), 0);
+    for(int i = 0; i < 4; i++) {
+        CU_ASSERT_FALSE(candidates[i].evaluated);
+    }
+    ai_lookahead_close();
+    CU_ASSERT_FALSE(ai_lookahead_enabled());
+    CU_ASSERT_EQUAL(SDL_AtomicGet(&clones), 0);
+
+    free_arena_state(&gs, &sc, players, objs);
+}
+
+void test_ai_lookahead_expired_budget(void) {
+    game_state gs;
+    scene sc;
+    game_player players[2];
+    object objs[2];
+    har hars[2];
+    ai_lookahead_candidate candidates[AI_LOOKAHEAD_MAX_CANDIDATES];
+    create_arena_state(&gs, &sc, players, objs, hars);
+    ai_lookahead_init();
+
+    // No budget at all, nothing is even cloned
+    SDL_AtomicSet(&clones, 0);
+    SDL_AtomicSet(&clone_frees, 0);
+    init_candidates(candidates, AI_LOOKAHEAD_MAX_CANDIDATES);
+    CU_ASSERT_EQUAL(ai_lookahead_run(&gs, 0, candidates, AI_LOOKAHEAD_MAX_CANDIDATES, 10, 0), 0);
+    CU_ASSERT_EQUAL(SDL_AtomicGet(&clones), 0);
+
+    // The first clone uses up the budget, so it runs out of time before its first tick. The AI controller needs at
+    // least two evaluated candidates to compare, anything less makes it fall back to its heuristics.
+    rand_seed(4321);
+    init_candidates(candidates, AI_LOOKAHEAD_MAX_CANDIDATES);
+    int evaluated = ai_lookahead_run(&gs, 0, candidates, AI_LOOKAHEAD_MAX_CANDIDATES, 10, BUDGET_US);
+    CU_ASSERT(evaluated < 2);
+    CU_ASSERT_EQUAL(evaluated, 0);
+    for(int i = 0; i < AI_LOOKAHEAD_MAX_CANDIDATES; i++) {
+        CU_ASSERT_FALSE(candidates[i].evaluated);
+    }
+
+    // Every clone has been freed by the time the run returns, and the game's random numbers are left alone
+    CU_ASSERT_EQUAL(SDL_AtomicGet(&clones), 1);
+    CU_ASSERT_EQUAL(SDL_AtomicGet(&clone_frees), SDL_AtomicGet(&clones));
+    CU_ASSERT_EQUAL(rand_get_seed(), 4321);
+
+    // The source state is untouched
+    CU_ASSERT_EQUAL(hars[0].health, 100);
+    CU_ASSERT_EQUAL(hars[1].health, 100);
+
+    ai_lookahead_close();
+    free_arena_state(&gs, &sc, players, objs);
+}
+
+void ai_lookahead_test_suite(CU_pSuite suite) {
+    ADD_TEST("Test AI lookahead without pool or arena", test_ai_lookahead_disabled);
+    ADD_TEST("Test AI lookahead with an expired budget", test_ai_lookahead_expired_budget);
+}
@@ -0,0 +1,61 @@
+#include "common.h"
+#include "resources/animation.h"
+#include "utils/allocator.h"
+
+static animation *create_single(vga_index color) {
+    surface *sur = omf_calloc(1, sizeof(surface));
+    surface_create(sur, 4, 4);
+    sur->data[0] = color;
+    sprite *sp = omf_calloc(1, sizeof(sprite));
+    sprite_create_custom(sp, vec2i_create(1, 2), sur);
+    sp->owned = true;
+    return create_animation_from_single(sp, vec2i_create(0, 0));
+}
+
+void test_animation_clone_shares_sprites(void) {
+    animation *src = create_single(5);
+    animation dst;
+    animation_clone(src, &dst);
+
+    sprite *a = animation_get_sprite(src, 0);
+    sprite *b = animation_get_sprite(&dst, 0);
+    CU_ASSERT_PTR_EQUAL(a, b);
+    CU_ASSERT_TRUE(sprite_is_shared(a));
+
+    // The source can go away first; the clone keeps the sprite alive.
+    animation_free(src);
+    omf_free(src);
+    CU_ASSERT_FALSE(sprite_is_shared(b));
+    CU_ASSERT_EQUAL(b->data->data[0], 5);
+    animation_free(&dst);
+}
+
+void test_animation_clone_copy_on_write(void) {
+    animation *src = create_single(5);
+    animation dst;
+    animation_clone(src, &dst);
+    sprite *a = animation_get_sprite(src, 0);
+    const unsigned int guid = a->data->guid;
+
+    sprite *b = animation_get_sprite_writable(&dst, 0);
+    CU_ASSERT_PTR_NOT_EQUAL(a, b);
+    CU_ASSERT_FALSE(sprite_is_shared(a));
+    CU_ASSERT_FALSE(sprite_is_shared(b));
+    b->pos.x = 10;
+    b->data->data[0] = 7;
+    CU_ASSERT_EQUAL(a->pos.x, 1);
+    CU_ASSERT_EQUAL(a->data->data[0], 5);
+    CU_ASSERT_EQUAL(a->data->guid, guid);
+
+    // A sprite that is not shared is modified in place.
+    CU_ASSERT_PTR_EQUAL(animation_get_sprite_writable(src, 0), a);
+
+    animation_free(src);
+    omf_free(src);
+    animation_free(&dst);
+}
+
+void animation_test_suite(CU_pSuite suite) {
+    ADD_TEST("Test animation clone shares sprites", test_animation_clone_shares_sprites);
+    ADD_TEST("Test animation clone copy on write", test_animation_clone_copy_on_write);
+}
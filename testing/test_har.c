@@ -0,0 +1,78 @@
+#include "common.h"
+#include "formats/move.h"
+#include "formats/pilot.h"
+#include "game/game_player.h"
+#include "game/game_state.h"
+#include "game/objects/har.h"
+#include "game/protos/object.h"
+#include "game/utils/har_screencap.h"
+
+#include <string.h>
+
+// A bare lookahead game state with two HARs. There is no scene and no renderer, like on a lookahead worker thread.
+static void create_lookahead_state(game_state *gs, game_player players[2], sd_pilot pilots[2], object objs[2],
+                                   har hars[2]) {
+    memset(gs, 0, sizeof(game_state));
+    vector_create(&gs->objects, sizeof(render_obj));
+    object_index_create(&gs->object_index);
+    sound_tracker_create(&gs->tracker);
+    random_seed(&gs->rand, 1234);
+    gs->speed_slowdown_time = -1;
+    gs->clone = true;
+    gs->lookahead = true;
+    for(int i = 0; i < 2; i++) {
+        memset(&pilots[i], 0, sizeof(sd_pilot));
+        memset(&players[i], 0, sizeof(game_player));
+        players[i].pilot = &pilots[i];
+        gs->players[i] = &players[i];
+
+        // Objects are allocated zeroed in the game, and object_create() relies on that
+        memset(&objs[i], 0, sizeof(object));
+        object_create(&objs[i], gs, vec2i_create(100 + 100 * i, 190), vec2f_create(0, 0));
+        game_state_add_object(gs, &objs[i], RENDER_LAYER_MIDDLE, 0, 0);
+        memset(&hars[i], 0, sizeof(har));
+        hars[i].player_id = i;
+        hars[i].health_max = 100;
+        hars[i].health = 100;
+        hars[i].state = STATE_STANDING;
+        object_set_userdata(&objs[i], &hars[i]);
+        players[i].har_obj_id = objs[i].id;
+    }
+}
+
+static void free_lookahead_state(game_state *gs, object objs[2]) {
+    for(int i = 0; i < 2; i++) {
+        object_free(&objs[i]);
+    }
+    sound_tracker_free(&gs->tracker);
+    object_index_free(&gs->object_index);
+    vector_free(&gs->objects);
+}
+
+void test_har_lethal_lookahead_damage(void) {
+    game_state gs;
+    game_player players[2];
+    sd_pilot pilots[2];
+    object objs[2];
+    har hars[2];
+    create_lookahead_state(&gs, players, pilots, objs, hars);
+
+    // A plain hit with no hit animation, so that nothing needs the HAR resources
+    af_move move;
+    memset(&move, 0, sizeof(af_move));
+    move.damage = 200;
+    str_create(&move.footer_string);
+
+    // The killing blow would normally be captured for the newsroom. That needs the renderer, which is not there.
+    hars[0].health = 1;
+    har_take_damage(&objs[0], &move);
+    CU_ASSERT_EQUAL(hars[0].health, 0);
+    CU_ASSERT_PTR_NULL(players[1].screencaps.shots[SCREENCAP_BLOW]);
+
+    str_free(&move.footer_string);
+    free_lookahead_state(&gs, objs);
+}
+
+void har_test_suite(CU_pSuite suite) {
+    ADD_TEST("Test lethal damage in a lookahead clone", test_har_lethal_lookahead_damage);
+}
@@ -28,6 +28,25 @@ void sprite_packer_test_suite(CU_pSuite suite);
 void sound_tracker_test_suite(CU_pSuite suite);
 int sound_tracker_suite_init(void);
 int sound_tracker_suite_free(void);
+void object_index_test_suite(CU_pSuite suite);
+void af_move_matcher_test_suite(CU_pSuite suite);
+void software_renderer_test_suite(CU_pSuite suite);
+int software_renderer_suite_init(void);
+int software_renderer_suite_free(void);
+void offline_audio_test_suite(CU_pSuite suite);
+int offline_audio_suite_init(void);
+int offline_audio_suite_free(void);
+void net_transcript_test_suite(CU_pSuite suite);
+void state_digest_test_suite(CU_pSuite suite);
+void sprite_cache_test_suite(CU_pSuite suite);
+int sprite_cache_suite_init(void);
+int sprite_cache_suite_free(void);
+void animation_test_suite(CU_pSuite suite);
+void har_test_suite(CU_pSuite suite);
+void ai_lookahead_test_suite(CU_pSuite suite);
+void preloader_test_suite(CU_pSuite suite);
+int preloader_suite_init(void);
+int preloader_suite_free(void);
 
 int main(int argc, char **argv) {
     CU_pSuite suite = NULL;
@@ -176,6 +195,73 @@ int main(int argc, char **argv) {
     }
     sound_tracker_test_suite(sound_tracker_suite);
 
+    CU_pSuite object_index_suite = CU_add_suite("Object Index", NULL, NULL);
+    if(object_index_suite == NULL) {
+        goto end;
+    }
+    object_index_test_suite(object_index_suite);
+
+    CU_pSuite af_move_matcher_suite = CU_add_suite("AF Move Matcher", NULL, NULL);
+    if(af_move_matcher_suite == NULL) {
+        goto end;
+    }
+    af_move_matcher_test_suite(af_move_matcher_suite);
+
+    CU_pSuite software_renderer_suite =
+        CU_add_suite("Software Renderer", software_renderer_suite_init, software_renderer_suite_free);
+    if(software_renderer_suite == NULL) {
+        goto end;
+    }
+    software_renderer_test_suite(software_renderer_suite);
+
+    CU_pSuite offline_audio_suite = CU_add_suite("Offline Audio", offline_audio_suite_init, offline_audio_suite_free);
+    if(offline_audio_suite == NULL) {
+        goto end;
+    }
+    offline_audio_test_suite(offline_audio_suite);
+
+    CU_pSuite net_transcript_suite = CU_add_suite("Net Transcript", NULL, NULL);
+    if(net_transcript_suite == NULL) {
+        goto end;
+    }
+    net_transcript_test_suite(net_transcript_suite);
+
+    CU_pSuite state_digest_suite = CU_add_suite("State Digest", NULL, NULL);
+    if(state_digest_suite == NULL) {
+        goto end;
+    }
+    state_digest_test_suite(state_digest_suite);
+
+    CU_pSuite sprite_cache_suite = CU_add_suite("Sprite Cache", sprite_cache_suite_init, sprite_cache_suite_free);
+    if(sprite_cache_suite == NULL) {
+        goto end;
+    }
+    sprite_cache_test_suite(sprite_cache_suite);
+
+    CU_pSuite animation_suite = CU_add_suite("Animation", NULL, NULL);
+    if(animation_suite == NULL) {
+        goto end;
+    }
+    animation_test_suite(animation_suite);
+
+    CU_pSuite har_suite = CU_add_suite("HAR", NULL, NULL);
+    if(har_suite == NULL) {
+        goto end;
+    }
+    har_test_suite(har_suite);
+
+    CU_pSuite ai_lookahead_suite = CU_add_suite("AI Lookahead", NULL, NULL);
+    if(ai_lookahead_suite == NULL) {
+        goto end;
+    }
+    ai_lookahead_test_suite(ai_lookahead_suite);
+
+    CU_pSuite preloader_suite = CU_add_suite("Preloader", preloader_suite_init, preloader_suite_free);
+    if(preloader_suite == NULL) {
+        goto end;
+    }
+    preloader_test_suite(preloader_suite);
+
     // Run tests
     CU_basic_set_mode(CU_BRM_VERBOSE);
     CU_basic_run_tests();
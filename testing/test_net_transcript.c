@@ -0,0 +1,129 @@
+#include "common.h"
+#include "controller/net_transcript.h"
+
+void test_net_transcript_insert_get(void) {
+    net_transcript t;
+    net_transcript_create(&t);
+
+    CU_ASSERT_PTR_NULL(net_transcript_get(&t, 10));
+    tick_events *ev = net_transcript_insert(&t, 10);
+    CU_ASSERT_EQUAL(ev->tick, 10);
+    CU_ASSERT_EQUAL(ev->events[0][0], 0);
+    CU_ASSERT_EQUAL(ev->events[1][0], 0);
+    ev->events[1][0] = 5;
+
+    // Inserting an existing tick returns the same entry
+    ev = net_transcript_insert(&t, 10);
+    CU_ASSERT_EQUAL(ev->events[1][0], 5);
+    CU_ASSERT_PTR_EQUAL(net_transcript_get(&t, 10), ev);
+    CU_ASSERT_PTR_NULL(net_transcript_get(&t, 11));
+    CU_ASSERT_PTR_NULL(net_transcript_get(&t, 9));
+
+    net_transcript_free(&t);
+}
+
+void test_net_transcript_out_of_order(void) {
+    net_transcript t;
+    net_transcript_create(&t);
+
+    net_transcript_insert(&t, 20);
+    net_transcript_insert(&t, 5);
+    net_transcript_insert(&t, 12);
+
+    tick_events *ev = net_transcript_next(&t, 0);
+    CU_ASSERT_EQUAL(ev->tick, 5);
+    ev = net_transcript_next(&t, ev->tick + 1);
+    CU_ASSERT_EQUAL(ev->tick, 12);
+    ev = net_transcript_next(&t, ev->tick + 1);
+    CU_ASSERT_EQUAL(ev->tick, 20);
+    CU_ASSERT_PTR_NULL(net_transcript_next(&t, ev->tick + 1));
+
+    ev = net_transcript_prev(&t, 20);
+    CU_ASSERT_EQUAL(ev->tick, 12);
+    ev = net_transcript_prev(&t, 1000);
+    CU_ASSERT_EQUAL(ev->tick, 20);
+    CU_ASSERT_PTR_NULL(net_transcript_prev(&t, 5));
+
+    net_transcript_free(&t);
+}
+
+void test_net_transcript_grow(void) {
+    net_transcript t;
+    net_transcript_create(&t);
+
+    // Spans more than the initial capacity in both directions
+    for(uint32_t tick = 2000; tick < 3000; tick += 3) {
+        net_transcript_insert(&t, tick)->events[0][0] = tick & 0xFF;
+    }
+    net_transcript_insert(&t, 1000)->events[0][0] = 1;
+    for(uint32_t tick = 2000; tick < 3000; tick++) {
+        tick_events *ev = net_transcript_get(&t, tick);
+        if(tick % 3 == 2000 % 3) {
+            CU_ASSERT_PTR_NOT_NULL_FATAL(ev);
+            CU_ASSERT_EQUAL(ev->events[0][0], tick & 0xFF);
+        } else {
+            CU_ASSERT_PTR_NULL(ev);
+        }
+    }
+    CU_ASSERT_EQUAL(net_transcript_get(&t, 1000)->events[0][0], 1);
+
+    net_transcript_free(&t);
+}
+
+void test_net_transcript_trim(void) {
+    net_transcript t;
+    net_transcript_create(&t);
+
+    net_transcript_insert(&t, 1);
+    net_transcript_insert(&t, 4);
+    net_transcript_insert(&t, 9);
+    net_transcript_trim(&t, 3);
+    CU_ASSERT_PTR_NULL(net_transcript_get(&t, 1));
+    CU_ASSERT_EQUAL(net_transcript_next(&t, 0)->tick, 4);
+    CU_ASSERT_EQUAL(t.first_tick, 4);
+
+    net_transcript_trim(&t, 100);
+    CU_ASSERT_PTR_NULL(net_transcript_next(&t, 0));
+    CU_ASSERT_EQUAL(t.first_tick, t.end_tick);
+
+    // Trimmed slots are reused when the window moves on
+    for(uint32_t tick = 100; tick < 100000; tick += 7) {
+        net_transcript_insert(&t, tick);
+        net_transcript_trim(&t, tick);
+    }
+    CU_ASSERT_EQUAL(t.capacity, 256);
+
+    net_transcript_free(&t);
+}
+
+void test_net_transcript_max_window(void) {
+    net_transcript t;
+    net_transcript_create(&t);
+
+    net_transcript_insert(&t, 100000)->events[0][0] = 1;
+
+    // Ticks that would stretch the window too far are refused, and leave the transcript as it was
+    CU_ASSERT_PTR_NULL(net_transcript_insert(&t, 100000 + NET_TRANSCRIPT_MAX_WINDOW));
+    CU_ASSERT_PTR_NULL(net_transcript_insert(&t, 100000 - NET_TRANSCRIPT_MAX_WINDOW));
+    CU_ASSERT_PTR_NULL(net_transcript_insert(&t, UINT32_MAX));
+    CU_ASSERT_PTR_NULL(net_transcript_insert(&t, 0));
+    CU_ASSERT_EQUAL(t.capacity, 256);
+    CU_ASSERT_EQUAL(t.first_tick, 100000);
+    CU_ASSERT_EQUAL(t.end_tick, 100001);
+    CU_ASSERT_EQUAL(net_transcript_get(&t, 100000)->events[0][0], 1);
+
+    // The largest window still fits
+    CU_ASSERT_PTR_NOT_NULL(net_transcript_insert(&t, 100000 + NET_TRANSCRIPT_MAX_WINDOW - 1));
+    CU_ASSERT_EQUAL(t.capacity, NET_TRANSCRIPT_MAX_WINDOW);
+    CU_ASSERT_EQUAL(net_transcript_get(&t, 100000)->events[0][0], 1);
+
+    net_transcript_free(&t);
+}
+
+void net_transcript_test_suite(CU_pSuite suite) {
+    ADD_TEST("Test net transcript insert and get", test_net_transcript_insert_get);
+    ADD_TEST("Test net transcript out of order inserts", test_net_transcript_out_of_order);
+    ADD_TEST("Test net transcript growth", test_net_transcript_grow);
+    ADD_TEST("Test net transcript trimming", test_net_transcript_trim);
+    ADD_TEST("Test net transcript window limit", test_net_transcript_max_window);
+}
@@ -0,0 +1,88 @@
+#include "common.h"
+#include "game/protos/object.h"
+#include "game/utils/object_index.h"
+#include <string.h>
+
+#define TEST_OBJECTS 200
+
+static object objects[TEST_OBJECTS];
+
+static void make_objects(void) {
+    memset(objects, 0, sizeof(objects));
+    for(int i = 0; i < TEST_OBJECTS; i++) {
+        objects[i].id = i + 1;
+    }
+}
+
+void test_object_index_empty(void) {
+    object_index idx;
+    object_index_create(&idx);
+    CU_ASSERT_PTR_NULL(object_index_get(&idx, 1));
+    object_index_remove(&idx, 1);
+    CU_ASSERT_EQUAL(idx.count, 0);
+    object_index_free(&idx);
+}
+
+void test_object_index_add_get(void) {
+    make_objects();
+    object_index idx;
+    object_index_create(&idx);
+    for(int i = 0; i < TEST_OBJECTS; i++) {
+        object_index_add(&idx, &objects[i]);
+    }
+    CU_ASSERT_EQUAL(idx.count, TEST_OBJECTS);
+    for(int i = 0; i < TEST_OBJECTS; i++) {
+        CU_ASSERT_PTR_EQUAL(object_index_get(&idx, i + 1), &objects[i]);
+    }
+    CU_ASSERT_PTR_NULL(object_index_get(&idx, 0));
+    CU_ASSERT_PTR_NULL(object_index_get(&idx, TEST_OBJECTS + 1));
+    object_index_free(&idx);
+}
+
+void test_object_index_remove(void) {
+    make_objects();
+    object_index idx;
+    object_index_create(&idx);
+    for(int i = 0; i < TEST_OBJECTS; i++) {
+        object_index_add(&idx, &objects[i]);
+    }
+
+    // Remove every third object, and make sure the rest can still be found.
+    for(int i = 0; i < TEST_OBJECTS; i += 3) {
+        object_index_remove(&idx, objects[i].id);
+    }
+    for(int i = 0; i < TEST_OBJECTS; i++) {
+        if(i % 3 == 0) {
+            CU_ASSERT_PTR_NULL(object_index_get(&idx, objects[i].id));
+        } else {
+            CU_ASSERT_PTR_EQUAL(object_index_get(&idx, objects[i].id), &objects[i]);
+        }
+    }
+    CU_ASSERT_EQUAL(idx.count, TEST_OBJECTS - (TEST_OBJECTS + 2) / 3);
+    object_index_free(&idx);
+}
+
+void test_object_index_clear(void) {
+    make_objects();
+    object_index idx;
+    object_index_create(&idx);
+    for(int i = 0; i < TEST_OBJECTS; i++) {
+        object_index_add(&idx, &objects[i]);
+    }
+    unsigned capacity = idx.capacity;
+    object_index_clear(&idx);
+    CU_ASSERT_EQUAL(idx.count, 0);
+    CU_ASSERT_EQUAL(idx.capacity, capacity);
+    CU_ASSERT_PTR_NULL(object_index_get(&idx, 1));
+
+    object_index_add(&idx, &objects[5]);
+    CU_ASSERT_PTR_EQUAL(object_index_get(&idx, objects[5].id), &objects[5]);
+    object_index_free(&idx);
+}
+
+void object_index_test_suite(CU_pSuite suite) {
+    ADD_TEST("Test object index empty", test_object_index_empty);
+    ADD_TEST("Test object index add and get", test_object_index_add_get);
+    ADD_TEST("Test object index remove", test_object_index_remove);
+    ADD_TEST("Test object index clear", test_object_index_clear);
+}
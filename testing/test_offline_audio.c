@@ -0,0 +1,114 @@
+#include "audio/backends/offline/offline_backend.h"
+#include "common.h"
+#include <string.h>
+
+#define SAMPLE_RATE 48000
+#define SOUND_LEN 480
+
+static audio_backend backend;
+static char sound_data[SOUND_LEN];
+static int16_t out[SOUND_LEN * 2 * 2];
+
+static sound_source make_sound(int freq) {
+    sound_source src;
+    memset(&src, 0, sizeof(src));
+    src.buf = sound_data;
+    src.len = SOUND_LEN;
+    src.freq = freq;
+    src.sound_id = 1;
+    return src;
+}
+
+int offline_audio_suite_init(void) {
+    // Unsigned 8 bit, 0xC0 is a constant 16384 when converted to signed 16 bit.
+    memset(sound_data, 0xC0, sizeof(sound_data));
+    offline_audio_backend_set_callbacks(&backend);
+    backend.create(&backend);
+    if(!backend.setup_context(backend.ctx, SAMPLE_RATE, false, 0, 1.0f, 1.0f)) {
+        backend.destroy(&backend);
+        return 1;
+    }
+    return 0;
+}
+
+int offline_audio_suite_free(void) {
+    backend.close_context(backend.ctx);
+    backend.destroy(&backend);
+    return 0;
+}
+
+void test_offline_audio_mix(void) {
+    sound_source src = make_sound(SAMPLE_RATE);
+    CU_ASSERT_TRUE(backend.play_pcm_sound(backend.ctx, 0, &src, 64, 0, 0));
+    CU_ASSERT_TRUE(backend.is_channel_playing(backend.ctx, 0));
+
+    // Half volume on both sides, and silence once the sound has ended.
+    backend.render(backend.ctx, out, SOUND_LEN + 10);
+    CU_ASSERT_EQUAL(out[0], 8192);
+    CU_ASSERT_EQUAL(out[1], 8192);
+    CU_ASSERT_EQUAL(out[(SOUND_LEN - 1) * 2], 8192);
+    CU_ASSERT_EQUAL(out[SOUND_LEN * 2], 0);
+    CU_ASSERT_FALSE(backend.is_channel_playing(backend.ctx, 0));
+}
+
+void test_offline_audio_panning(void) {
+    sound_source src = make_sound(SAMPLE_RATE);
+    CU_ASSERT_TRUE(backend.play_pcm_sound(backend.ctx, 1, &src, 127, 100, 0));
+    backend.render(backend.ctx, out, 1);
+    CU_ASSERT_EQUAL(out[0], 0);
+    CU_ASSERT_EQUAL(out[1], 16256);
+
+    backend.set_channel_panning(backend.ctx, 1, -50);
+    backend.render(backend.ctx, out, 1);
+    CU_ASSERT_EQUAL(out[0], 16256);
+    CU_ASSERT_EQUAL(out[1], 16256 * 127 / 255);
+    backend.stop_channel(backend.ctx, 1);
+    CU_ASSERT_FALSE(backend.is_channel_playing(backend.ctx, 1));
+}
+
+void test_offline_audio_resample(void) {
+    // Half the output rate plays for twice as many frames.
+    sound_source src = make_sound(SAMPLE_RATE / 2);
+    CU_ASSERT_TRUE(backend.play_pcm_sound(backend.ctx, 0, &src, 64, 0, 0));
+    backend.render(backend.ctx, out, SOUND_LEN * 2);
+    CU_ASSERT_EQUAL(out[(SOUND_LEN * 2 - 1) * 2], 8192);
+    CU_ASSERT_FALSE(backend.is_channel_playing(backend.ctx, 0));
+}
+
+void test_offline_audio_fade(void) {
+    sound_source src = make_sound(SAMPLE_RATE);
+    CU_ASSERT_TRUE(backend.play_pcm_sound(backend.ctx, 2, &src, 64, 0, 0));
+    backend.fade_out_channel(backend.ctx, 2, 5); // 240 frames
+    backend.render(backend.ctx, out, 300);
+    CU_ASSERT_EQUAL(out[0], 8192);
+    CU_ASSERT_EQUAL(out[120 * 2], 4096);
+    CU_ASSERT_EQUAL(out[240 * 2], 0);
+    CU_ASSERT_FALSE(backend.is_channel_playing(backend.ctx, 2));
+
+    CU_ASSERT_TRUE(backend.play_pcm_sound(backend.ctx, 2, &src, 64, 0, 5));
+    backend.render(backend.ctx, out, 300);
+    CU_ASSERT_EQUAL(out[0], 0);
+    CU_ASSERT_EQUAL(out[120 * 2], 4096);
+    CU_ASSERT_EQUAL(out[240 * 2], 8192);
+    backend.stop_channel(backend.ctx, 2);
+}
+
+void test_offline_audio_clipping(void) {
+    sound_source src = make_sound(SAMPLE_RATE);
+    for(int i = 0; i < SOUND_CHANNEL_COUNT; i++) {
+        CU_ASSERT_TRUE(backend.play_pcm_sound(backend.ctx, i, &src, 127, 0, 0));
+    }
+    backend.render(backend.ctx, out, 1);
+    CU_ASSERT_EQUAL(out[0], INT16_MAX);
+    for(int i = 0; i < SOUND_CHANNEL_COUNT; i++) {
+        backend.stop_channel(backend.ctx, i);
+    }
+}
+
+void offline_audio_test_suite(CU_pSuite suite) {
+    ADD_TEST("Test offline audio mixing", test_offline_audio_mix);
+    ADD_TEST("Test offline audio panning", test_offline_audio_panning);
+    ADD_TEST("Test offline audio resampling", test_offline_audio_resample);
+    ADD_TEST("Test offline audio fades", test_offline_audio_fade);
+    ADD_TEST("Test offline audio clipping", test_offline_audio_clipping);
+}
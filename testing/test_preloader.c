@@ -0,0 +1,110 @@
+#include "common.h"
+#include "resources/preloader.h"
+#include "utils/allocator.h"
+
+#include <SDL.h>
+#include <string.h>
+
+#define WAIT_MS 5000 // Long enough for any load to start; a timeout means the preloader is stuck
+
+static SDL_sem *started; // Posted by the loader when it starts loading a file
+static SDL_sem *gate;    // If set, the loader waits for this before finishing
+static SDL_atomic_t loads;
+
+static void *test_load(const path *filename, int resource_id) {
+    SDL_AtomicIncRef(&loads);
+    SDL_SemPost(started);
+    if(gate != NULL) {
+        SDL_SemWait(gate);
+    }
+    if(filename != NULL) {
+        return strcmp(path_c(filename), "MISSING.BK") == 0 ? NULL : omf_calloc(1, sizeof(bk));
+    }
+    return omf_calloc(1, sizeof(af));
+}
+
+static int open_gate(void *userdata) {
+    SDL_Delay(50);
+    SDL_SemPost(gate);
+    return 0;
+}
+
+int preloader_suite_init(void) {
+    started = SDL_CreateSemaphore(0);
+    return started == NULL;
+}
+
+int preloader_suite_free(void) {
+    SDL_DestroySemaphore(started);
+    return 0;
+}
+
+void test_preloader_request_take(void) {
+    path arena, missing;
+    path_from_c(&arena, "ARENA0.BK");
+    path_from_c(&missing, "MISSING.BK");
+    SDL_AtomicSet(&loads, 0);
+    preloader_init_with(test_load);
+
+    // Nothing has been requested yet
+    CU_ASSERT_PTR_NULL(preloader_take_bk(&arena));
+
+    // Requesting the same file twice loads it once. Once the load has started, taking waits for it.
+    preloader_request_bk(&arena);
+    preloader_request_bk(&arena);
+    CU_ASSERT_EQUAL_FATAL(SDL_SemWaitTimeout(started, WAIT_MS), 0);
+    bk *b = preloader_take_bk(&arena);
+    CU_ASSERT_PTR_NOT_NULL(b);
+    omf_free(b);
+    CU_ASSERT_PTR_NULL(preloader_take_bk(&arena));
+
+    // Failed loads are left to the caller
+    preloader_request_bk(&missing);
+    CU_ASSERT_EQUAL_FATAL(SDL_SemWaitTimeout(started, WAIT_MS), 0);
+    CU_ASSERT_PTR_NULL(preloader_take_bk(&missing));
+
+    // AF files are told apart by resource
+    preloader_request_af(5);
+    CU_ASSERT_EQUAL_FATAL(SDL_SemWaitTimeout(started, WAIT_MS), 0);
+    CU_ASSERT_PTR_NULL(preloader_take_af(6));
+    af *a = preloader_take_af(5);
+    CU_ASSERT_PTR_NOT_NULL(a);
+    omf_free(a);
+
+    preloader_close();
+    CU_ASSERT_EQUAL(SDL_AtomicGet(&loads), 3);
+}
+
+void test_preloader_take_pending_running(void) {
+    path arena;
+    path_from_c(&arena, "ARENA1.BK");
+    SDL_AtomicSet(&loads, 0);
+    gate = SDL_CreateSemaphore(0);
+    preloader_init_with(test_load);
+
+    // The first file is held in the loader, so the second one stays in the queue
+    preloader_request_bk(&arena);
+    CU_ASSERT_EQUAL_FATAL(SDL_SemWaitTimeout(started, WAIT_MS), 0);
+    preloader_request_af(3);
+
+    // A queued file is dropped, and never loaded
+    CU_ASSERT_PTR_NULL(preloader_take_af(3));
+
+    // A file that is being loaded is waited for
+    SDL_Thread *opener = SDL_CreateThread(open_gate, "open gate", NULL);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(opener);
+    bk *b = preloader_take_bk(&arena);
+    CU_ASSERT_PTR_NOT_NULL(b);
+    omf_free(b);
+    SDL_WaitThread(opener, NULL);
+
+    preloader_close();
+    CU_ASSERT_EQUAL(SDL_AtomicGet(&loads), 1);
+    SDL_DestroySemaphore(gate);
+    gate = NULL;
+}
+
+void preloader_test_suite(CU_pSuite suite) {
+    ADD_TEST("Test preloader request and take", test_preloader_request_take);
+    ADD_TEST("Test preloader take while pending or running", test_preloader_take_pending_running);
+}
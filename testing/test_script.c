@@ -287,6 +287,85 @@ void test_script_all(void) {
     }
 }
 
+void test_script_compile(void) {
+    script plain, compiled;
+    script_create(&plain);
+    script_create(&compiled);
+    // Frame A has a repeated tag, frame C has no tags at all
+    const char *src = "s05bpd1bps1bpn64m3m7A100-s1sf3x-5B10-C34-zzbmy=-2D1";
+    CU_ASSERT_FATAL(script_decode(&plain, src, NULL) == SD_SUCCESS);
+    CU_ASSERT_FATAL(script_decode(&compiled, src, NULL) == SD_SUCCESS);
+    script_compile(&compiled);
+
+    // Every tag id gives the same answer with and without the index
+    for(int f = 0; f < script_get_frame_count(&plain); f++) {
+        const script_frame *a = script_get_frame(&plain, f);
+        const script_frame *b = script_get_frame(&compiled, f);
+        CU_ASSERT_PTR_NOT_NULL(b->tag_table);
+        for(int id = 0; id < 256; id++) {
+            CU_ASSERT_EQUAL(script_is_tag_set_by_id(a, id), script_is_tag_set_by_id(b, id));
+            CU_ASSERT_EQUAL(script_get_tag_value_by_id(a, id), script_get_tag_value_by_id(b, id));
+        }
+    }
+    CU_ASSERT(script_get_tag_value_by_id(script_get_frame(&compiled, 0), TAG_M) == 7);
+    CU_ASSERT(script_get_tag_value_by_id(script_get_frame(&compiled, 1), TAG_X_MINUS) == 5);
+    CU_ASSERT(script_is_tag_set_by_id(script_get_frame(&compiled, 3), TAG_ZZ));
+    CU_ASSERT(!script_is_tag_set_by_id(script_get_frame(&compiled, 2), TAG_S));
+
+    // Changing tags drops the index, and lookups see the change
+    CU_ASSERT(script_set_tag(&compiled, 0, "m", 9) == SD_SUCCESS);
+    CU_ASSERT_PTR_NULL(script_get_frame(&compiled, 0)->tag_table);
+    CU_ASSERT(script_get_tag_value_by_id(script_get_frame(&compiled, 0), TAG_M) == 9);
+    CU_ASSERT(script_delete_tag(&compiled, 1, "sf") == SD_SUCCESS);
+    CU_ASSERT(!script_is_tag_set_by_id(script_get_frame(&compiled, 1), TAG_SF));
+
+    script_free(&plain);
+    script_free(&compiled);
+}
+
+void test_script_compile_frame_lookup(void) {
+    for(int i = 0; i < TEST_STRING_COUNT; i++) {
+        script plain, compiled;
+        script_create(&plain);
+        script_create(&compiled);
+        CU_ASSERT_FATAL(script_decode(&plain, test_strings[i], NULL) == SD_SUCCESS);
+        CU_ASSERT_FATAL(script_decode(&compiled, test_strings[i], NULL) == SD_SUCCESS);
+        script_compile(&compiled);
+        CU_ASSERT_PTR_NOT_NULL_FATAL(compiled.tick_start);
+
+        // Binary search must find the same frames as the linear scan, including past the end
+        const int total = script_get_total_ticks(&plain);
+        CU_ASSERT_EQUAL(script_get_total_ticks(&compiled), total);
+        int mismatches = 0;
+        for(int tick = -1; tick <= total + 1; tick++) {
+            mismatches += script_get_frame_index_at(&compiled, tick) != script_get_frame_index_at(&plain, tick);
+            mismatches += script_get_frame_index(&compiled, script_get_frame_at(&compiled, tick)) !=
+                          script_get_frame_index(&plain, script_get_frame_at(&plain, tick));
+            mismatches += script_get_next_frame_with_sprite(&compiled, 0, tick) !=
+                          script_get_next_frame_with_sprite(&plain, 0, tick);
+            mismatches += script_get_next_frame_with_tag_id(&compiled, TAG_S, tick) !=
+                          script_get_next_frame_with_tag_id(&plain, TAG_S, tick);
+        }
+        for(int frame = -1; frame <= script_get_frame_count(&plain) + 1; frame++) {
+            mismatches += script_get_tick_pos_at_frame(&compiled, frame) != script_get_tick_pos_at_frame(&plain, frame);
+        }
+        CU_ASSERT_EQUAL(mismatches, 0);
+
+        script_free(&plain);
+        script_free(&compiled);
+    }
+
+    // Changing frame lengths drops the start ticks
+    script s;
+    script_open_ok(&s);
+    script_compile(&s);
+    CU_ASSERT(script_get_frame_index_at(&s, 100) == 1);
+    CU_ASSERT(script_set_tick_len_at_frame(&s, 0, 50) == SD_SUCCESS);
+    CU_ASSERT_PTR_NULL(s.tick_start);
+    CU_ASSERT(script_get_frame_index_at(&s, 50) == 1);
+    script_free(&s);
+}
+
 void test_next_frame_with_sprite(void) {
     script s;
     script_open_ok(&s);
@@ -469,6 +548,8 @@ void script_test_suite(CU_pSuite suite) {
     ADD_TEST("test of script_is_first_frame_at", test_is_first_frame_at);
     ADD_TEST("test of script_is_tag_set_by_name", test_script_is_tag_set_by_name);
     ADD_TEST("test of script_get_tag_value_by_name", test_script_get_tag_value_by_name);
+    ADD_TEST("test of script_compile", test_script_compile);
+    ADD_TEST("test of script_compile frame lookups", test_script_compile_frame_lookup);
     ADD_TEST("test of script_get_next_frame_with_sprite", test_next_frame_with_sprite);
     ADD_TEST("test of script_get_next_frame_with_tag", test_next_frame_with_tag);
     ADD_TEST("test of script_set_tag", test_set_tag);
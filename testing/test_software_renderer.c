@@ -0,0 +1,166 @@
+#include "common.h"
+#include "video/enums.h"
+#include "video/renderers/software/software_renderer.h"
+#include "video/vga_state.h"
+#include <string.h>
+
+#define NATIVE_W 320
+#define NATIVE_H 200
+
+static renderer sw;
+static unsigned char screen[NATIVE_W * NATIVE_H * 3];
+static surface background;
+static surface sprite;
+
+static const vga_color colors[] = {
+    {0,   0,   0  },
+    {255, 0,   0  },
+    {0,   255, 0  },
+    {0,   0,   255},
+};
+
+static void on_capture(const SDL_Rect *rect, unsigned char *data, bool flipped) {
+    CU_ASSERT_EQUAL(rect->w, NATIVE_W);
+    CU_ASSERT_EQUAL(rect->h, NATIVE_H);
+    CU_ASSERT_FALSE(flipped);
+    memcpy(screen, data, sizeof(screen));
+}
+
+static const unsigned char *pixel_at(int x, int y) {
+    return screen + (y * NATIVE_W + x) * 3;
+}
+
+static void assert_color(int x, int y, int color) {
+    const unsigned char *p = pixel_at(x, y);
+    CU_ASSERT_EQUAL(p[0], colors[color].r);
+    CU_ASSERT_EQUAL(p[1], colors[color].g);
+    CU_ASSERT_EQUAL(p[2], colors[color].b);
+}
+
+static void draw(const surface *sur, int x, int y, int remap_offset, int remap_rounds, unsigned flip_mode,
+                 unsigned options) {
+    SDL_Rect dst = {x, y, sur->w, sur->h};
+    sw.draw_surface(sw.ctx, sur, &dst, remap_offset, remap_rounds, 0, 255, 255, flip_mode, options);
+}
+
+static void render_frame(const surface *sur, unsigned flip_mode, unsigned options) {
+    sw.render_prepare(sw.ctx, 0);
+    draw(&background, 0, 0, 0, 0, 0, 0);
+    draw(sur, 10, 20, 2, 0, flip_mode, options);
+    sw.capture_screen(sw.ctx, on_capture);
+    sw.render_finish(sw.ctx);
+}
+
+int software_renderer_suite_init(void) {
+    vga_state_init();
+    for(int i = 0; i < 4; i++) {
+        vga_state_set_base_palette_index(i, &colors[i]);
+    }
+    vga_state_render();
+
+    // Remap table 2 turns red into green.
+    vga_remap_tables remaps;
+    vga_remaps_init(&remaps);
+    remaps.tables[2].data[1] = 2;
+    vga_state_set_remaps_from(&remaps);
+
+    surface_create(&background, NATIVE_W, NATIVE_H);
+    for(int i = 0; i < NATIVE_W * NATIVE_H; i++) {
+        background.data[i] = 3;
+    }
+    background.transparent = -1;
+
+    surface_create(&sprite, 2, 2);
+    sprite.data[0] = 1;
+    sprite.data[1] = 2;
+    sprite.data[2] = 0;
+    sprite.data[3] = 1;
+    sprite.transparent = 0;
+
+    software_renderer_set_callbacks(&sw);
+    sw.create(&sw);
+    if(!sw.setup_context(sw.ctx, NATIVE_W, NATIVE_H, false, false, 0, 0, 1, 0)) {
+        sw.destroy(&sw);
+        return 1;
+    }
+    return 0;
+}
+
+int software_renderer_suite_free(void) {
+    sw.close_context(sw.ctx);
+    sw.destroy(&sw);
+    surface_free(&sprite);
+    surface_free(&background);
+    vga_state_close();
+    return 0;
+}
+
+void test_software_renderer_draw(void) {
+    render_frame(&sprite, FLIP_NONE, 0);
+    assert_color(10, 20, 1);
+    assert_color(11, 20, 2);
+    assert_color(10, 21, 3); // Transparent pixel shows background
+    assert_color(11, 21, 1);
+    assert_color(12, 20, 3);
+}
+
+void test_software_renderer_flip(void) {
+    render_frame(&sprite, FLIP_HORIZONTAL, 0);
+    assert_color(10, 20, 2);
+    assert_color(11, 20, 1);
+    assert_color(10, 21, 1);
+    assert_color(11, 21, 3);
+
+    render_frame(&sprite, FLIP_VERTICAL, 0);
+    assert_color(10, 20, 3);
+    assert_color(11, 20, 1);
+    assert_color(10, 21, 1);
+    assert_color(11, 21, 2);
+}
+
+void test_software_renderer_remap(void) {
+    render_frame(&sprite, FLIP_NONE, SPRITE_REMAP);
+    assert_color(10, 20, 2);
+    assert_color(11, 20, 2);
+    assert_color(10, 21, 3);
+    assert_color(11, 21, 2);
+}
+
+void test_software_renderer_scale(void) {
+    sw.render_prepare(sw.ctx, 0);
+    draw(&background, 0, 0, 0, 0, 0, 0);
+    SDL_Rect dst = {10, 20, 4, 4};
+    sw.draw_surface(sw.ctx, &sprite, &dst, 0, 0, 0, 255, 255, FLIP_NONE, 0);
+    sw.capture_screen(sw.ctx, on_capture);
+    sw.render_finish(sw.ctx);
+    assert_color(10, 20, 1);
+    assert_color(11, 21, 1);
+    assert_color(12, 20, 2);
+    assert_color(13, 21, 2);
+    assert_color(10, 22, 3);
+    assert_color(13, 23, 1);
+}
+
+void test_software_renderer_area(void) {
+    SDL_Rect area = {10, NATIVE_H - 22, 2, 2};
+    surface cap;
+    sw.render_area_prepare(sw.ctx, &area);
+    draw(&background, 0, 0, 0, 0, 0, 0);
+    draw(&sprite, 10, 20, 0, 0, 0, 0);
+    sw.render_area_finish(sw.ctx, &cap);
+    CU_ASSERT_EQUAL(cap.w, 2);
+    CU_ASSERT_EQUAL(cap.h, 2);
+    CU_ASSERT_EQUAL(cap.data[0], 1);
+    CU_ASSERT_EQUAL(cap.data[1], 2);
+    CU_ASSERT_EQUAL(cap.data[2], 3);
+    CU_ASSERT_EQUAL(cap.data[3], 1);
+    surface_free(&cap);
+}
+
+void software_renderer_test_suite(CU_pSuite suite) {
+    ADD_TEST("Test software renderer draw", test_software_renderer_draw);
+    ADD_TEST("Test software renderer flip", test_software_renderer_flip);
+    ADD_TEST("Test software renderer remap", test_software_renderer_remap);
+    ADD_TEST("Test software renderer scaling", test_software_renderer_scale);
+    ADD_TEST("Test software renderer area capture", test_software_renderer_area);
+}
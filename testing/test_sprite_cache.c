@@ -0,0 +1,82 @@
+#include "common.h"
+#include "resources/sprite_cache.h"
+
+int sprite_cache_suite_init(void) {
+    sprite_cache_init();
+    return 0;
+}
+
+int sprite_cache_suite_free(void) {
+    sprite_cache_close();
+    return 0;
+}
+
+static surface *insert_surface(const char *key, int w, int h, vga_index color) {
+    surface tmp;
+    surface_create(&tmp, w, h);
+    for(int i = 0; i < w * h; i++) {
+        tmp.data[i] = color;
+    }
+    return sprite_cache_insert(key, &tmp);
+}
+
+void test_sprite_cache_miss(void) {
+    CU_ASSERT_TRUE(sprite_cache_enabled());
+    CU_ASSERT_PTR_NULL(sprite_cache_acquire("test/miss"));
+}
+
+void test_sprite_cache_shared(void) {
+    surface *a = insert_surface("test/shared", 8, 4, 7);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(a);
+    CU_ASSERT_EQUAL(a->w, 8);
+    CU_ASSERT_EQUAL(a->h, 4);
+    const unsigned int guid = a->guid;
+
+    surface *b = sprite_cache_acquire("test/shared");
+    CU_ASSERT_PTR_EQUAL(b, a);
+    CU_ASSERT_EQUAL(b->guid, guid);
+    sprite_cache_release(b);
+    sprite_cache_release(a);
+
+    // Unreferenced surfaces stay cached, and keep their guid.
+    surface *c = sprite_cache_acquire("test/shared");
+    CU_ASSERT_PTR_EQUAL(c, a);
+    CU_ASSERT_EQUAL(c->guid, guid);
+    CU_ASSERT_EQUAL(c->data[0], 7);
+    sprite_cache_release(c);
+}
+
+void test_sprite_cache_insert_existing(void) {
+    surface *a = insert_surface("test/existing", 2, 2, 1);
+    surface tmp;
+    surface_create(&tmp, 2, 2);
+    surface *b = sprite_cache_insert("test/existing", &tmp);
+    CU_ASSERT_PTR_EQUAL(b, a);
+    CU_ASSERT_PTR_NULL(tmp.data);
+    CU_ASSERT_EQUAL(b->data[0], 1);
+    sprite_cache_release(b);
+    sprite_cache_release(a);
+}
+
+void test_sprite_cache_evict(void) {
+    // Large enough that two of them do not fit in the unused budget.
+    surface *a = insert_surface("test/big_a", 2048, 2048 * 3 / sizeof(vga_pixel), 1);
+    surface *b = insert_surface("test/big_b", 2048, 2048 * 3 / sizeof(vga_pixel), 2);
+    sprite_cache_release(a);
+    CU_ASSERT_PTR_EQUAL(sprite_cache_acquire("test/big_a"), a);
+    sprite_cache_release(a);
+    sprite_cache_release(b);
+
+    // The least recently released one goes first.
+    CU_ASSERT_PTR_NULL(sprite_cache_acquire("test/big_a"));
+    surface *c = sprite_cache_acquire("test/big_b");
+    CU_ASSERT_PTR_EQUAL(c, b);
+    sprite_cache_release(c);
+}
+
+void sprite_cache_test_suite(CU_pSuite suite) {
+    ADD_TEST("Test sprite cache miss", test_sprite_cache_miss);
+    ADD_TEST("Test sprite cache shared surfaces", test_sprite_cache_shared);
+    ADD_TEST("Test sprite cache insert existing key", test_sprite_cache_insert_existing);
+    ADD_TEST("Test sprite cache eviction", test_sprite_cache_evict);
+}
@@ -97,6 +97,27 @@ void test_sprite_packer_reset(void) {
     sprite_packer_free(&packer);
 }
 
+void test_sprite_packer_release(void) {
+    sprite_packer *packer = sprite_packer_create(64, 64);
+    sprite_region first, second, region;
+
+    // Fill entire area with two halves
+    CU_ASSERT_TRUE(sprite_packer_alloc(packer, 64, 32, &first));
+    CU_ASSERT_TRUE(sprite_packer_alloc(packer, 64, 32, &second));
+    CU_ASSERT_FALSE(sprite_packer_alloc(packer, 1, 1, &region));
+
+    sprite_packer_release(packer, &first); // Act
+
+    // The released half can be used again, but nothing bigger fits
+    CU_ASSERT_FALSE(sprite_packer_alloc(packer, 64, 33, &region));
+    CU_ASSERT_TRUE(sprite_packer_alloc(packer, 64, 32, &region));
+    CU_ASSERT(region.x == first.x);
+    CU_ASSERT(region.y == first.y);
+    CU_ASSERT_FALSE(sprite_packer_alloc(packer, 1, 1, &region));
+
+    sprite_packer_free(&packer);
+}
+
 void sprite_packer_test_suite(CU_pSuite suite) {
     ADD_TEST("Test sprite_packer create", test_sprite_packer_create);
     ADD_TEST("Test sprite_packer alloc single", test_sprite_packer_alloc_single);
@@ -104,4 +125,5 @@ void sprite_packer_test_suite(CU_pSuite suite) {
     ADD_TEST("Test sprite_packer alloc exact fit", test_sprite_packer_alloc_exact_fit);
     ADD_TEST("Test sprite_packer alloc too large", test_sprite_packer_alloc_too_large);
     ADD_TEST("Test sprite_packer reset", test_sprite_packer_reset);
+    ADD_TEST("Test sprite_packer release", test_sprite_packer_release);
 }
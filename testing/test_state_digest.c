@@ -0,0 +1,136 @@
+#include "common.h"
+#include "game/game_player.h"
+#include "game/game_state.h"
+#include "game/protos/object.h"
+#include "game/utils/state_digest.h"
+
+#include <string.h>
+
+void test_state_digest_hash_words(void) {
+    uint32_t words[37];
+    for(int i = 0; i < 37; i++) {
+        words[i] = i * 2654435761u;
+    }
+
+    // Same input, same hash
+    uint64_t full = state_digest_hash_words(words, 37);
+    CU_ASSERT_EQUAL(full, state_digest_hash_words(words, 37));
+
+    // The length counts, even for zero words
+    uint32_t zeros[9] = {0};
+    CU_ASSERT_NOT_EQUAL(state_digest_hash_words(zeros, 8), state_digest_hash_words(zeros, 9));
+    CU_ASSERT_NOT_EQUAL(state_digest_hash_words(zeros, 0), state_digest_hash_words(zeros, 1));
+
+    // Flipping any single bit changes the hash, both in the striped part and in the tail
+    for(int i = 0; i < 37; i++) {
+        words[i] ^= 1u << (i % 32);
+        CU_ASSERT_NOT_EQUAL(state_digest_hash_words(words, 37), full);
+        words[i] ^= 1u << (i % 32);
+    }
+
+    // Swapping two words changes the hash
+    uint32_t tmp = words[3];
+    words[3] = words[4];
+    words[4] = tmp;
+    CU_ASSERT_NOT_EQUAL(state_digest_hash_words(words, 37), full);
+}
+
+void test_state_digest_fold(void) {
+    CU_ASSERT_EQUAL(state_digest_fold(0x0000000100000002ULL), 3);
+    CU_ASSERT_EQUAL(state_digest_fold(0xFFFFFFFF00000000ULL), 0xFFFFFFFF);
+}
+
+void test_state_digest_diff(void) {
+    str a, b, diff;
+    str_from_c(&a, "game.version=1\n"
+                   "game.seed=1234\n"
+                   "object[0].pos.x=10.5\n"
+                   "object[1].id=7\n");
+    str_from_c(&b, "game.version=1\n"
+                   "game.seed=1234\n"
+                   "object[0].pos.x=10.25\n"
+                   "object[2].id=8\n");
+    str_create(&diff);
+
+    CU_ASSERT_EQUAL(state_digest_diff(&a, &a, &diff), 0);
+    CU_ASSERT_EQUAL(str_size(&diff), 0);
+
+    CU_ASSERT_EQUAL(state_digest_diff(&a, &b, &diff), 3);
+    CU_ASSERT_STRING_EQUAL(str_c(&diff), "object[0].pos.x: 10.5 != 10.25\n"
+                                         "object[1].id: 7 != (missing)\n"
+                                         "object[2].id: (missing) != 8\n");
+
+    str_free(&a);
+    str_free(&b);
+    str_free(&diff);
+}
+
+// A bare game state with three objects that refer to each other. There is no scene, so nothing needs resources.
+static void create_linked_state(game_state *gs, game_player players[2], object objs[3]) {
+    memset(gs, 0, sizeof(game_state));
+    vector_create(&gs->objects, sizeof(render_obj));
+    object_index_create(&gs->object_index);
+    sound_tracker_create(&gs->tracker);
+    random_seed(&gs->rand, 1234);
+    for(int i = 0; i < 2; i++) {
+        memset(&players[i], 0, sizeof(game_player));
+        gs->players[i] = &players[i];
+    }
+    for(int i = 0; i < 3; i++) {
+        // Objects are allocated zeroed in the game, and object_create() relies on that
+        memset(&objs[i], 0, sizeof(object));
+        object_create(&objs[i], gs, vec2i_create(10 * i, 20), vec2f_create(0, 0));
+        game_state_add_object(gs, &objs[i], RENDER_LAYER_MIDDLE, 0, 0);
+    }
+    objs[1].attached_to_id = objs[0].id;
+    objs[2].animation_state.enemy_obj_id = objs[1].id;
+    players[0].har_obj_id = objs[0].id;
+}
+
+static void free_linked_state(game_state *gs, object objs[3]) {
+    for(int i = 0; i < 3; i++) {
+        object_free(&objs[i]);
+    }
+    sound_tracker_free(&gs->tracker);
+    object_index_free(&gs->object_index);
+    vector_free(&gs->objects);
+}
+
+void test_state_digest_object_ids(void) {
+    state_digest d;
+    state_digest_create(&d);
+    game_state gs_a, gs_b;
+    game_player players_a[2], players_b[2];
+    object objs_a[3], objs_b[3];
+
+    create_linked_state(&gs_a, players_a, objs_a);
+    uint64_t hash_a = state_digest_hash(&d, &gs_a);
+
+    // Use up some object ids, like a peer that has spawned more objects, or a rewind that spawns them again
+    object tmp = {0};
+    for(int i = 0; i < 5; i++) {
+        object_create(&tmp, &gs_a, vec2i_create(0, 0), vec2f_create(0, 0));
+        object_free(&tmp);
+    }
+    create_linked_state(&gs_b, players_b, objs_b);
+    CU_ASSERT_NOT_EQUAL(objs_a[0].id, objs_b[0].id);
+    CU_ASSERT_EQUAL(state_digest_hash(&d, &gs_b), hash_a);
+
+    // Which object is referred to still matters
+    objs_b[1].attached_to_id = objs_b[2].id;
+    CU_ASSERT_NOT_EQUAL(state_digest_hash(&d, &gs_b), hash_a);
+    objs_b[1].attached_to_id = objs_b[0].id;
+    players_b[0].har_obj_id = objs_b[1].id;
+    CU_ASSERT_NOT_EQUAL(state_digest_hash(&d, &gs_b), hash_a);
+
+    free_linked_state(&gs_a, objs_a);
+    free_linked_state(&gs_b, objs_b);
+    state_digest_free(&d);
+}
+
+void state_digest_test_suite(CU_pSuite suite) {
+    ADD_TEST("Test state digest hashing", test_state_digest_hash_words);
+    ADD_TEST("Test state digest folding", test_state_digest_fold);
+    ADD_TEST("Test state digest diff", test_state_digest_diff);
+    ADD_TEST("Test state digest ignores object ids", test_state_digest_object_ids);
+}
@@ -1,5 +1,6 @@
 #include "common.h"
 #include "game/gui/text/text.h"
+#include "game/gui/text/text_markup.h"
 #include "resources/fonts.h"
 #include "utils/str.h"
 #include "video/surface.h"
@@ -281,6 +282,85 @@ void test_font_family_switching(void) {
     str_free(&s);
 }
 
+void test_markup_ops(void) {
+    text_markup markup;
+    str s;
+
+    str_from_c(&s, "{CENTER ON}{COLOR 200}Hello{WIDTH 500}{UNKNOWN} world{VMOVE 20}");
+    text_markup_create(&markup, &s);
+    CU_ASSERT_EQUAL_FATAL(vector_size(&markup.ops), 6);
+
+    const text_markup_op *op = vector_get(&markup.ops, 0);
+    CU_ASSERT_EQUAL(op->type, MARKUP_OP_ALIGN);
+    CU_ASSERT_EQUAL(op->value, TEXT_ALIGN_CENTER);
+    op = vector_get(&markup.ops, 1);
+    CU_ASSERT_EQUAL(op->type, MARKUP_OP_COLOR);
+    CU_ASSERT_EQUAL(op->value, 200);
+    op = vector_get(&markup.ops, 2);
+    CU_ASSERT_EQUAL(op->type, MARKUP_OP_TEXT);
+    CU_ASSERT_EQUAL(op->value, 22);
+    CU_ASSERT_EQUAL(op->len, 5);
+    CU_ASSERT_FALSE(text_markup_is_last_run(&markup, op));
+    op = vector_get(&markup.ops, 3);
+    CU_ASSERT_EQUAL(op->type, MARKUP_OP_WIDTH);
+    CU_ASSERT_EQUAL(op->value, 320); // Clamped
+    op = vector_get(&markup.ops, 4);
+    CU_ASSERT_EQUAL(op->type, MARKUP_OP_TEXT);
+    CU_ASSERT_EQUAL(op->len, 6);
+    op = vector_get(&markup.ops, 5);
+    CU_ASSERT_EQUAL(op->type, MARKUP_OP_VMOVE);
+    CU_ASSERT_EQUAL(op->value, 20);
+
+    text_markup_free(&markup);
+    str_free(&s);
+}
+
+void test_markup_unterminated(void) {
+    text_markup markup;
+    str s;
+
+    str_from_c(&s, "{SHADOWS ON}Text{SIZE 8 more text");
+    text_markup_create(&markup, &s);
+    CU_ASSERT_EQUAL_FATAL(vector_size(&markup.ops), 2);
+
+    const text_markup_op *op = vector_get(&markup.ops, 0);
+    CU_ASSERT_EQUAL(op->type, MARKUP_OP_SHADOW);
+    CU_ASSERT_EQUAL(op->value, GLYPH_SHADOW_RIGHT | GLYPH_SHADOW_BOTTOM);
+    op = vector_get(&markup.ops, 1);
+    CU_ASSERT_EQUAL(op->type, MARKUP_OP_TEXT);
+    CU_ASSERT_EQUAL(op->len, 4);
+    CU_ASSERT_FALSE(text_markup_is_last_run(&markup, op));
+
+    text_markup_free(&markup);
+    str_free(&s);
+}
+
+void test_markup_document_replay(void) {
+    text_markup markup;
+    str s, s2;
+
+    // The same compiled markup can be used for several documents.
+    str_from_c(&s, "{SIZE 6}small{SIZE 8}big");
+    text_markup_create(&markup, &s);
+    str_free(&s);
+
+    for(int i = 0; i < 2; i++) {
+        text_document *doc = text_document_create();
+        text_generate_markup_document(doc, &markup, FONT_BIG, 320, 200, TEXT_BRIGHT_GREEN, TEXT_SHADOW_GREEN,
+                                      TEXT_ALIGN_TOP, TEXT_ALIGN_LEFT, (text_margin){0}, 1, 0, 0, 0);
+        CU_ASSERT_EQUAL_FATAL(text_document_get_text_count(doc), 2);
+
+        text *t = text_document_get_text(doc, 1);
+        text_get_str(t, &s2);
+        CU_ASSERT(str_equal_c(&s2, "big"));
+        CU_ASSERT_EQUAL(text_get_font(t), FONT_BIG);
+        str_free(&s2);
+        text_document_free(&doc);
+    }
+
+    text_markup_free(&markup);
+}
+
 int text_markup_suite_init(void) {
     font f1, f2, f3, f4;
     create_fake_font(&f1, 8);
@@ -317,4 +397,7 @@ void text_markup_test_suite(CU_pSuite suite) {
     ADD_TEST("Broken Markup", test_broken_markup);
     ADD_TEST("Color Formats", test_color_formats);
     ADD_TEST("Font Switching", test_font_family_switching);
+    ADD_TEST("Markup Ops", test_markup_ops);
+    ADD_TEST("Markup Unterminated", test_markup_unterminated);
+    ADD_TEST("Markup Document Replay", test_markup_document_replay);
 }